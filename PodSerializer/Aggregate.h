@@ -0,0 +1,489 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Reflection.h"
+#include "TypeList.h"
+#include "Tuple.h"
+#include "Transpose.h"
+#include "SoaVector.h"
+
+#include <cstdint>
+#include <cstring>
+
+
+/************************************************************************************
+ * Aggregation of fields
+ *
+ * The key-concept is following:
+ *  - Field is chosen by its index in GetTypeList. Values are aggregated
+ *    either over a column of SoaVector, or directly over an array of
+ *    objects (e.g. deserialized batch).
+ *  - Enumerations are aggregated as their underlying types, the same as
+ *    GetTypeIds treats them. Other fields must be arithmetic.
+ *  - Kernels are common for all sources: values are got by loader, that
+ *    knows where they are - in contiguous column, at compile-time offset
+ *    inside of POD structures, or in not-POD objects via their views.
+ *  - Kernels process values in several independent lanes, so there are
+ *    no dependencies between adjacent iterations and compiler maps lanes
+ *    onto SIMD registers for each arithmetic type. Lanes are combined in
+ *    the end.
+ *
+ ************************************************************************************/
+
+
+namespace columnar {
+namespace details {
+
+    //
+    // Number of independent lanes in kernels
+    //
+    static constexpr size_t _AggregateLanes = 8;
+
+    /************************************************************************************/
+
+    //
+    // Type of field with specified index
+    //
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of structure */
+    > using _Field_t = typename decltype( type_list::get<_Idx>( reflection::GetTypeList<_Type>() ) )::type;
+
+    //
+    // Type, that field is aggregated as: enumerations
+    // are replaced with their underlying types
+    //
+
+    template<typename _Field, bool = std::is_enum<_Field>::value>
+    struct _Arithmetic
+    {
+        using type = _Field;
+    };
+
+    template<typename _Field>
+    struct _Arithmetic<_Field, true /* std::is_enum<_Field> */>
+    {
+        using type = typename std::underlying_type<_Field>::type;
+    };
+
+    template<typename _Field>
+    using _Arithmetic_t = typename _Arithmetic<_Field>::type;
+
+    //
+    // Type of sum: integers are summed in 64-bit
+    // integers of the same signedness, floating-
+    // point numbers are summed at least in double
+    //
+    template<typename _Value>
+    using _Sum_t =
+        typename std::conditional<std::is_floating_point<_Value>::value,
+            typename std::conditional<std::is_same<_Value, long double>::value, long double, double>::type,
+        typename std::conditional<std::is_signed<_Value>::value,
+            int64_t, uint64_t
+        >::type>::type;
+
+    //
+    // Type of mean
+    //
+    template<typename _Value>
+    using _Mean_t = typename std::conditional<std::is_same<_Value, long double>::value, long double, double>::type;
+
+    template<typename _Field>
+    void _CheckAggregatedField() noexcept
+    {
+        static_assert( std::is_arithmetic<_Arithmetic_t<_Field>>::value,
+            "Only arithmetic and enumeration fields can be aggregated" );
+    }
+
+    /************************************************************************************/
+
+    //
+    // Loaders: return value of field of i-th object
+    //
+
+    //
+    // Values are contiguous (column of SoaVector)
+    //
+    template<
+        typename _Field /* Type of field */
+    > struct _ColumnLoader
+    {
+        using value_t = _Arithmetic_t<_Field>;
+
+        value_t operator()( size_t index ) const noexcept
+        {
+            return static_cast<value_t>( data[index] );
+        }
+
+        const _Field* data;
+    };
+
+    //
+    // Values are at compile-time offset inside
+    // of POD structures (the same as Transpose.h
+    // gathers them)
+    //
+    template<
+        typename _Type   /* Type of structure */,
+        typename _Field  /* Type of field */,
+        size_t   _Offset /* Offset of field */
+    > struct _StridedLoader
+    {
+        using value_t = _Arithmetic_t<_Field>;
+
+        value_t operator()( size_t index ) const noexcept
+        {
+            value_t value;
+            std::memcpy( &value, data + index * sizeof( _Type ) + _Offset, sizeof( value_t ) );
+
+            return value;
+        }
+
+        const unsigned char* data;
+    };
+
+    //
+    // Values are got from views of not-POD objects
+    //
+    template<
+        typename _Type /* Type of structure */,
+        size_t   _Idx  /* Index of field */
+    > struct _ViewLoader
+    {
+        using value_t = _Arithmetic_t<_Field_t<_Idx, _Type>>;
+
+        value_t operator()( size_t index ) const noexcept
+        {
+            return static_cast<value_t>( types::get<_Idx>( reflection::ToTuplePreciseView( data[index] ) ) );
+        }
+
+        const _Type* data;
+    };
+
+    //
+    // Chooses loader for array of objects
+    //
+
+    template<size_t _Idx, typename _Type>
+    auto _MakeLoader( const _Type* objs, std::true_type /* is_supported_type<_Type> */ ) noexcept
+    {
+        using fields_t = decltype( reflection::GetTypeList<_Type>() );
+        constexpr auto offsets = _GetFieldOffsets<_Type>( fields_t{} );
+
+        return _StridedLoader<_Type, _Field_t<_Idx, _Type>, offsets.data[_Idx]>{ reinterpret_cast<const unsigned char*>( objs ) };
+    }
+
+    template<size_t _Idx, typename _Type>
+    auto _MakeLoader( const _Type* objs, std::false_type /* is_supported_type<_Type> */ ) noexcept
+    {
+        return _ViewLoader<_Type, _Idx>{ objs };
+    }
+
+    /************************************************************************************/
+
+    //
+    // Kernels
+    //
+
+    template<
+        typename _Loader /* Type of loader */
+    > auto _SumKernel( _Loader load, size_t count ) noexcept
+    {
+        using sum_t = _Sum_t<typename _Loader::value_t>;
+
+        sum_t lanes[_AggregateLanes] = { };
+        size_t i = 0;
+
+        for (; i + _AggregateLanes <= count; i += _AggregateLanes)
+        {
+            for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+                lanes[lane] += static_cast<sum_t>( load( i + lane ) );
+            }
+        }
+
+        sum_t result = 0;
+
+        for (; i < count; ++i) {
+            result += static_cast<sum_t>( load( i ) );
+        }
+
+        for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+            result += lanes[lane];
+        }
+
+        return result;
+    }
+
+    template<
+        typename _Loader /* Type of loader */
+    > size_t _CountKernel( _Loader load, size_t count, typename _Loader::value_t value ) noexcept
+    {
+        size_t lanes[_AggregateLanes] = { };
+        size_t i = 0;
+
+        for (; i + _AggregateLanes <= count; i += _AggregateLanes)
+        {
+            for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+                lanes[lane] += load( i + lane ) == value ? 1 : 0;
+            }
+        }
+
+        size_t result = 0;
+
+        for (; i < count; ++i) {
+            result += load( i ) == value ? 1 : 0;
+        }
+
+        for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+            result += lanes[lane];
+        }
+
+        return result;
+    }
+
+    //
+    // Selects minimum or maximum: value replaces current one,
+    // if it is strictly better. Range must not be empty.
+    //
+    template<
+        typename _Loader  /* Type of loader */,
+        typename _Better  /* Comparator */
+    > auto _SelectKernel( _Loader load, size_t count, _Better better ) noexcept
+    {
+        using value_t = typename _Loader::value_t;
+
+        value_t lanes[_AggregateLanes];
+        for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+            lanes[lane] = load( 0 );
+        }
+
+        size_t i = 0;
+
+        for (; i + _AggregateLanes <= count; i += _AggregateLanes)
+        {
+            for (size_t lane = 0; lane < _AggregateLanes; ++lane)
+            {
+                value_t value = load( i + lane );
+                lanes[lane] = better( value, lanes[lane] ) ? value : lanes[lane];
+            }
+        }
+
+        value_t result = lanes[0];
+
+        for (; i < count; ++i)
+        {
+            value_t value = load( i );
+            result = better( value, result ) ? value : result;
+        }
+
+        for (size_t lane = 0; lane < _AggregateLanes; ++lane) {
+            result = better( lanes[lane], result ) ? lanes[lane] : result;
+        }
+
+        return result;
+    }
+
+    struct _Less
+    {
+        template<typename _Value>
+        bool operator()( _Value left, _Value right ) const noexcept
+        {
+            return left < right;
+        }
+    };
+
+    struct _Greater
+    {
+        template<typename _Value>
+        bool operator()( _Value left, _Value right ) const noexcept
+        {
+            return right < left;
+        }
+    };
+
+    inline void _CheckNotEmpty( size_t count )
+    {
+        if (!count) {
+            throw std::invalid_argument( "Range of values is empty" );
+        }
+    }
+
+    /************************************************************************************/
+
+    //
+    // Aggregations over any loader
+    //
+
+    template<typename _Field, typename _Loader>
+    auto _Sum( _Loader load, size_t count ) noexcept
+    {
+        _CheckAggregatedField<_Field>();
+
+        return _SumKernel( load, count );
+    }
+
+    template<typename _Field, typename _Loader>
+    size_t _Count( _Loader load, size_t count, const _Field& value ) noexcept
+    {
+        _CheckAggregatedField<_Field>();
+
+        return _CountKernel( load, count, static_cast<_Arithmetic_t<_Field>>( value ) );
+    }
+
+    template<typename _Field, typename _Loader, typename _Better>
+    _Field _Select( _Loader load, size_t count, _Better better )
+    {
+        _CheckAggregatedField<_Field>();
+        _CheckNotEmpty( count );
+
+        return static_cast<_Field>( _SelectKernel( load, count, better ) );
+    }
+
+    template<typename _Field, typename _Loader>
+    auto _Mean( _Loader load, size_t count )
+    {
+        using mean_t = _Mean_t<_Arithmetic_t<_Field>>;
+
+        _CheckAggregatedField<_Field>();
+        _CheckNotEmpty( count );
+
+        return static_cast<mean_t>( _SumKernel( load, count ) ) / static_cast<mean_t>( count );
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Sum of values of field with index _Idx. Integers are summed
+    // in 64-bit integers, floating-point numbers - in double (or
+    // long double). Sum of empty range is zero.
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > auto Sum( const _Type* objs, size_t count ) noexcept
+    {
+        return details::_Sum<details::_Field_t<_Idx, _Type>>(
+            details::_MakeLoader<_Idx>( objs, is_supported_type<_Type>{} ), count
+        );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > auto Sum( const SoaVector<_Type>& soa ) noexcept
+    {
+        using field_t = details::_Field_t<_Idx, _Type>;
+
+        auto column = soa.template Column<_Idx>();
+        return details::_Sum<field_t>( details::_ColumnLoader<field_t>{ column.Data() }, column.Size() );
+    }
+
+    //
+    // Number of values of field with index _Idx,
+    // that are equal to 'value'
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > size_t Count( const _Type* objs, size_t count, const details::_Field_t<_Idx, _Type>& value ) noexcept
+    {
+        return details::_Count<details::_Field_t<_Idx, _Type>>(
+            details::_MakeLoader<_Idx>( objs, is_supported_type<_Type>{} ), count, value
+        );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > size_t Count( const SoaVector<_Type>& soa, const details::_Field_t<_Idx, _Type>& value ) noexcept
+    {
+        using field_t = details::_Field_t<_Idx, _Type>;
+
+        auto column = soa.template Column<_Idx>();
+        return details::_Count<field_t>( details::_ColumnLoader<field_t>{ column.Data() }, column.Size(), value );
+    }
+
+    //
+    // Minimal and maximal values of field with index _Idx.
+    // Values are compared as std::min_element and
+    // std::max_element do. Throws std::invalid_argument
+    // if range is empty.
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > details::_Field_t<_Idx, _Type> Min( const _Type* objs, size_t count )
+    {
+        return details::_Select<details::_Field_t<_Idx, _Type>>(
+            details::_MakeLoader<_Idx>( objs, is_supported_type<_Type>{} ), count, details::_Less{}
+        );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > details::_Field_t<_Idx, _Type> Min( const SoaVector<_Type>& soa )
+    {
+        using field_t = details::_Field_t<_Idx, _Type>;
+
+        auto column = soa.template Column<_Idx>();
+        return details::_Select<field_t>( details::_ColumnLoader<field_t>{ column.Data() }, column.Size(), details::_Less{} );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > details::_Field_t<_Idx, _Type> Max( const _Type* objs, size_t count )
+    {
+        return details::_Select<details::_Field_t<_Idx, _Type>>(
+            details::_MakeLoader<_Idx>( objs, is_supported_type<_Type>{} ), count, details::_Greater{}
+        );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > details::_Field_t<_Idx, _Type> Max( const SoaVector<_Type>& soa )
+    {
+        using field_t = details::_Field_t<_Idx, _Type>;
+
+        auto column = soa.template Column<_Idx>();
+        return details::_Select<field_t>( details::_ColumnLoader<field_t>{ column.Data() }, column.Size(), details::_Greater{} );
+    }
+
+    //
+    // Arithmetic mean of values of field with index _Idx.
+    // Throws std::invalid_argument if range is empty.
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > auto Mean( const _Type* objs, size_t count )
+    {
+        return details::_Mean<details::_Field_t<_Idx, _Type>>(
+            details::_MakeLoader<_Idx>( objs, is_supported_type<_Type>{} ), count
+        );
+    }
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > auto Mean( const SoaVector<_Type>& soa )
+    {
+        using field_t = details::_Field_t<_Idx, _Type>;
+
+        auto column = soa.template Column<_Idx>();
+        return details::_Mean<field_t>( details::_ColumnLoader<field_t>{ column.Data() }, column.Size() );
+    }
+
+} // columnar
\ No newline at end of file
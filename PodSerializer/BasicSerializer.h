@@ -52,6 +52,41 @@ namespace serialization {
         {
             buffer.Load( obj, std::forward<_ArgsTypes>( args )... );
         }
+
+        //
+        // Returns deserialized object by value. Fields are loaded
+        // directly into returned object (it is a subject to NRVO),
+        // so no intermediate copies are made.
+        // 
+        template<
+            typename... _ArgsTypes /* Optional parameters' types */
+        > constexpr _Type Deserialize( buffer_t& buffer, _ArgsTypes&&... args )
+        {
+            _Type obj;
+            buffer.Load( obj, std::forward<_ArgsTypes>( args )... );
+            return obj;
+        }
+
+        //
+        // Range serialization is available only for buffers,
+        // that can hold several objects (e.g. BinaryBatchBuffer).
+        // 
+
+        template<
+            typename    _InputIt   /* Input iterator type */,
+            typename... _ArgsTypes /* Optional parameters' types */
+        > constexpr void SerializeRange( _InputIt first, _InputIt last, buffer_t& buffer, _ArgsTypes&&... args )
+        {
+            buffer.SaveRange( first, last, std::forward<_ArgsTypes>( args )... );
+        }
+
+        template<
+            typename    _Destination /* Output iterator or container type */,
+            typename... _ArgsTypes   /* Optional parameters' types */
+        > constexpr decltype(auto) DeserializeRange( _Destination&& destination, buffer_t& buffer, _ArgsTypes&&... args )
+        {
+            return buffer.LoadRange( std::forward<_Destination>( destination ), std::forward<_ArgsTypes>( args )... );
+        }
     };
 
     /************************************************************************************/
@@ -63,6 +98,18 @@ namespace serialization {
     template<typename _Type>
     using BinarySerializer = BasicSerializer<_Type, BinaryBuffer>;
 
+    template<typename _Type>
+    using InlineBinarySerializer = BasicSerializer<_Type, InlineBinaryBuffer>;
+
+    template<typename _Type>
+    using ExternalBinarySerializer = BasicSerializer<_Type, ExternalBinaryBuffer>;
+
+    template<typename _Type>
+    using ArenaBinarySerializer = BasicSerializer<_Type, ArenaBinaryBuffer>;
+
+    template<typename _Type>
+    using BinaryBatchSerializer = BasicSerializer<_Type, BinaryBatchBuffer>;
+
     /************************************************************************************/
 
     //
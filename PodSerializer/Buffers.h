@@ -6,84 +6,212 @@
 #include "StreamOperators.h"
 #include "IOManipulators.h"
 #include "Reflection.h"
+#include "IsPaddingFree.h"
+#include "Layout.h"
+#include "Storage.h"
 #include "Tuple.h"
+#include "TextReader.h"
+#include "TextWriter.h"
 
 
 namespace serialization {
+namespace details {
 
     /************************************************************************************/
 
     //
-    // Buffer for binary serialization
+    // Binary format: all fields (including fields of nested structures)
+    // are written one after another without padding. Offsets of fields
+    // in structure and in buffer are taken from Layout.
     // 
 
     template<
-        typename _Type /* Type to be stored */
-    > class BinaryBuffer
+        typename  _Type /* Type to be saved */,
+        size_t... _Idxs /* Indices of internal types (with expanded nested structures) */
+    > void _SaveFields_Impl( const _Type& obj, unsigned char* buffer, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        using layout_t = reflection::Layout<_Type>;
+        using types::get;
+
+        auto src = reinterpret_cast<const unsigned char*>( &obj );
+
+        //
+        // Offsets and sizes are compile-time constants here,
+        // so each memcpy is turned into a single move.
+        // Array is used only to expand parameter pack.
+        // 
+        using _Expander = int[];
+        (void)_Expander{ 0, (
+            memcpy( 
+                buffer + get<_Idxs>( layout_t::packedOffsets ), 
+                src + get<_Idxs>( layout_t::offsets ), 
+                get<_Idxs>( layout_t::sizes ) 
+            ), 0 )... 
+        };
+    }
+
+    template<
+        typename  _Type /* Type to be loaded */,
+        size_t... _Idxs /* Indices of internal types (with expanded nested structures) */
+    > void _LoadFields_Impl( _Type& obj, const unsigned char* buffer, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        using layout_t = reflection::Layout<_Type>;
+        using types::get;
+
+        auto dst = reinterpret_cast<unsigned char*>( &obj );
+
+        using _Expander = int[];
+        (void)_Expander{ 0, (
+            memcpy( 
+                dst + get<_Idxs>( layout_t::offsets ), 
+                buffer + get<_Idxs>( layout_t::packedOffsets ), 
+                get<_Idxs>( layout_t::sizes ) 
+            ), 0 )... 
+        };
+    }
+
+    //
+    // Structure has no padding, so its layout in memory
+    // is exactly the same as layout in buffer. Whole
+    // object is copied at once.
+    // 
+
+    template<typename _Type>
+    void _SaveBinary_Impl( const _Type& obj, unsigned char* buffer, std::true_type /* is_padding_free<_Type> */ ) noexcept
+    {
+        memcpy( buffer, &obj, sizeof( _Type ) );
+    }
+
+    template<typename _Type>
+    void _SaveBinary_Impl( const _Type& obj, unsigned char* buffer, std::false_type /* is_padding_free<_Type> */ ) noexcept
+    {
+        _SaveFields_Impl( 
+            obj, buffer, std::make_index_sequence<reflection::Layout<_Type>::count>{} 
+        );
+    }
+
+    template<typename _Type>
+    void _LoadBinary_Impl( _Type& obj, const unsigned char* buffer, std::true_type /* is_padding_free<_Type> */ ) noexcept
+    {
+        memcpy( &obj, buffer, sizeof( _Type ) );
+    }
+
+    template<typename _Type>
+    void _LoadBinary_Impl( _Type& obj, const unsigned char* buffer, std::false_type /* is_padding_free<_Type> */ ) noexcept
+    {
+        _LoadFields_Impl( 
+            obj, buffer, std::make_index_sequence<reflection::Layout<_Type>::count>{} 
+        );
+    }
+
+    /************************************************************************************/
+
+    //
+    // Writes object into buffer. Buffer must contain at
+    // least Layout<_Type>::packedSize bytes.
+    // 
+    template<typename _Type>
+    void SaveBinary( const _Type& obj, unsigned char* buffer ) noexcept
+    {
+        _SaveBinary_Impl( obj, buffer, reflection::is_padding_free<_Type>{} );
+    }
+
+    //
+    // Reads object from buffer. Buffer must contain at
+    // least Layout<_Type>::packedSize bytes.
+    // 
+    template<typename _Type>
+    void LoadBinary( _Type& obj, const unsigned char* buffer ) noexcept
+    {
+        _LoadBinary_Impl( obj, buffer, reflection::is_padding_free<_Type>{} );
+    }
+
+} // details
+
+    /************************************************************************************/
+
+    //
+    // Buffer for binary serialization.
+    // Storage policy defines where serialized bytes live
+    // (see Storage.h).
+    // 
+
+    template<
+        typename _Type /* Type to be stored */,
+        typename _Storage = DynamicStorage<> /* Storage of serialized bytes */
+    > class BasicBinaryBuffer
     {
         REFLECTION_CHECK_TYPE( _Type );
 
-        using buffer_t = std::vector<unsigned char>;
+        using storage_t = _Storage;
         using value_t = _Type;
 
     public:
-        BinaryBuffer()
+        explicit BasicBinaryBuffer( storage_t storage = storage_t{} )
             : m_isFull( false )
-            , m_buffer( buffer_t( sizeof( value_t ), 0 ) )
-        { }
+            , m_storage( std::move( storage ) )
+        { 
+            m_storage.Allocate( reflection::Layout<value_t>::packedSize );
+        }
 
-        BinaryBuffer( const BinaryBuffer<_Type>& ) = default;
-        BinaryBuffer& operator=( const BinaryBuffer<_Type>& ) = default;
+        //
+        // Constructs full buffer from serialized bytes (e.g. read
+        // from file or socket). Bytes are copied into buffer.
+        // 
+        BasicBinaryBuffer( const unsigned char* data, size_t size, storage_t storage = storage_t{} )
+            : BasicBinaryBuffer( std::move( storage ) )
+        {
+            if (size != reflection::Layout<value_t>::packedSize) {
+                throw std::invalid_argument( "Invalid size of serialized data" );
+            }
 
-        BinaryBuffer( BinaryBuffer<_Type>&& ) = default;
-        BinaryBuffer& operator= ( BinaryBuffer<_Type>&& ) = default;
+            memcpy( m_storage.Data(), data, size );
+            m_isFull = true;
+        }
+
+        BasicBinaryBuffer( const BasicBinaryBuffer<_Type, _Storage>& ) = default;
+        BasicBinaryBuffer& operator=( const BasicBinaryBuffer<_Type, _Storage>& ) = default;
+
+        BasicBinaryBuffer( BasicBinaryBuffer<_Type, _Storage>&& ) = default;
+        BasicBinaryBuffer& operator= ( BasicBinaryBuffer<_Type, _Storage>&& ) = default;
 
         bool IsEmpty() const noexcept
         {
             return !m_isFull;
         }
 
-        void Clear()
+        //
+        // Serialized bytes. They can be written to file
+        // or socket directly without any copying.
+        // 
+        const unsigned char* Data() const noexcept
         {
-            m_isFull = false;
-            m_buffer.assign( sizeof( value_t ), 0 );
+            return m_storage.Data();
         }
 
-        void Save( const value_t& obj )
+        size_t Size() const noexcept
         {
-            using reflection::ToTuple;
-
-            if (m_isFull) {
-                Clear();
-            }
-
-            //
-            // Offset is necessary for memorizing location
-            // in buffer to write in.
-            // 
-            size_t offset = 0;
-
-            //
-            // Now we convert our structure into a tuple
-            // and then walk through all fields with serializing.
-            // 
-            auto tpl = ToTuple( obj );
+            return m_storage.Size();
+        }
 
-            auto SaveToBuffer = [&offset, buffer = m_buffer.data()]( auto&& element )
-            {
-                memcpy( buffer + offset, &element, sizeof( element ) );
-                offset += sizeof( element );
-            };
+        //
+        // Save overwrites all bytes, so there is
+        // no need to touch storage here.
+        // 
+        void Clear() noexcept
+        {
+            m_isFull = false;
+        }
 
-            types::for_each( tpl, SaveToBuffer );
+        void Save( const value_t& obj )
+        {
+            details::SaveBinary( obj, m_storage.Data() );
 
             m_isFull = true;
         }
 
         void Load( value_t& obj )
         {
-            using reflection::GetFieldsCount;
-
             //
             // Check if buffer contains a value.
             // 
@@ -91,57 +219,237 @@ namespace serialization {
                 throw std::logic_error( "Buffer is empty" );
             }
 
-            _Load_Impl( 
-                obj, std::make_index_sequence<GetFieldsCount<value_t>()>{} 
-            );
+            details::LoadBinary( obj, m_storage.Data() );
         }
 
     private:
+
+        //
+        // Flag of emptiness 
+        // 
+        bool m_isFull;
+
+        //
+        // Internal storage
+        // 
+        storage_t m_storage;
+    };
+
+    //
+    // Some aliases for buffers
+    // 
+
+    template<typename _Type>
+    using BinaryBuffer = BasicBinaryBuffer<_Type, DynamicStorage<>>;
+
+    template<typename _Type>
+    using InlineBinaryBuffer = BasicBinaryBuffer<_Type, InlineStorage<reflection::Layout<_Type>::packedSize>>;
+
+    template<typename _Type>
+    using ExternalBinaryBuffer = BasicBinaryBuffer<_Type, ExternalStorage>;
+
+    template<typename _Type>
+    using ArenaBinaryBuffer = BasicBinaryBuffer<_Type, ArenaStorage>;
+
+    /************************************************************************************/
+
+    //
+    // Buffer for binary serialization of many objects.
+    // All objects are stored one after another in one
+    // contiguous block of memory in the same format as
+    // in BinaryBuffer.
+    // 
+
+    template<
+        typename _Type /* Type to be stored */
+    > class BinaryBatchBuffer
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        using buffer_t = std::vector<unsigned char>;
+        using value_t = _Type;
+
+    public:
+        BinaryBatchBuffer()
+            : m_count( 0 )
+            , m_buffer()
+        { }
+
+        BinaryBatchBuffer( const BinaryBatchBuffer<_Type>& ) = default;
+        BinaryBatchBuffer& operator=( const BinaryBatchBuffer<_Type>& ) = default;
+
+        BinaryBatchBuffer( BinaryBatchBuffer<_Type>&& ) = default;
+        BinaryBatchBuffer& operator= ( BinaryBatchBuffer<_Type>&& ) = default;
+
+        //
+        // Size of one serialized object in bytes
+        // 
+        static constexpr size_t RecordSize() noexcept
+        {
+            return reflection::Layout<value_t>::packedSize;
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return m_count == 0;
+        }
+
+        //
+        // Number of stored objects
+        // 
+        size_t Count() const noexcept
+        {
+            return m_count;
+        }
+
+        //
+        // Serialized bytes of all stored objects
+        // 
+        const unsigned char* Data() const noexcept
+        {
+            return m_buffer.data();
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_count * RecordSize();
+        }
+
+        //
+        // Memory is not released here, so buffer can be reused
+        // without new allocations.
+        // 
+        void Clear() noexcept
+        {
+            m_count = 0;
+        }
+
+        void Reserve( size_t count )
+        {
+            m_buffer.reserve( count * RecordSize() );
+        }
+
+        //
+        // Appends object to the end of buffer
+        // 
+        void Save( const value_t& obj )
+        {
+            details::SaveBinary( obj, _Grow( 1 ) );
+        }
+
+        //
+        // Appends all objects from range [first, last)
+        // to the end of buffer
+        // 
         template<
-            size_t... _Idxs /* Indices */
-        > void _Load_Impl( value_t& obj, std::index_sequence<_Idxs...> /* indices */ )
+            typename _InputIt /* Input iterator type */
+        > void SaveRange( _InputIt first, _InputIt last )
         {
-            using reflection::details::SizeT;
-            using reflection::details::_GetTypeById;
-            using reflection::GetTypeIds;
-            using reflection::FromTuple;
-            using types::Tuple;
-            using types::get;
+            using category_t = typename std::iterator_traits<_InputIt>::iterator_category;
 
-            //
-            // Here we need to know types, stored in storage
-            // 
-            constexpr auto ids = GetTypeIds<value_t>();
-            using tuple_t = Tuple< decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )... >;
+            _SaveRange_Impl( first, last, category_t{} );
+        }
 
-            //
-            // Now put stored values into tuple
-            // 
-            tuple_t buffer_view;
-            size_t offset = 0;
+        //
+        // Loads object with specified index
+        // 
+        void Load( value_t& obj, size_t index = 0 ) const
+        {
+            if (index >= m_count) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            details::LoadBinary( obj, m_buffer.data() + index * RecordSize() );
+        }
+
+        //
+        // Loads all objects directly into a vector.
+        // Previous content of vector is replaced.
+        // 
+        template<
+            typename _Allocator /* Allocator of vector */
+        > void LoadRange( std::vector<value_t, _Allocator>& objs ) const
+        {
+            objs.resize( m_count );
 
-            auto PutToTuple = [&offset, buffer = m_buffer.data()]( auto& /* non-const lvalue!!! */ element )
+            auto src = m_buffer.data();
+            for (auto& obj : objs) 
             {
-                using element_t = typename std::decay<decltype( element )>::type;
+                details::LoadBinary( obj, src );
+                src += RecordSize();
+            }
+        }
 
-                element = *reinterpret_cast<element_t*>( buffer + offset );
-                offset += sizeof( element );
-            };
+        //
+        // Loads all objects into an output iterator
+        // 
+        template<
+            typename _OutputIt /* Output iterator type */
+        > _OutputIt LoadRange( _OutputIt out ) const
+        {
+            auto src = m_buffer.data();
+            for (size_t i = 0; i < m_count; ++i, ++out) 
+            {
+                value_t obj;
+                details::LoadBinary( obj, src );
+                *out = std::move( obj );
 
-            types::for_each( buffer_view, PutToTuple );
+                src += RecordSize();
+            }
 
-            //
-            // And finally convert tuple into an object.
-            // 
-            obj = FromTuple<value_t>( buffer_view );
+            return out;
         }
 
     private:
 
         //
-        // Flag of emptiness 
+        // Forward iterators: number of objects is known, so
+        // memory is allocated once before saving.
         // 
-        bool m_isFull;
+        template<typename _ForwardIt>
+        void _SaveRange_Impl( _ForwardIt first, _ForwardIt last, std::forward_iterator_tag )
+        {
+            auto count = static_cast<size_t>( std::distance( first, last ) );
+            auto dst = _Grow( count );
+
+            for (; first != last; ++first) 
+            {
+                details::SaveBinary( *first, dst );
+                dst += RecordSize();
+            }
+        }
+
+        //
+        // Input iterators: objects are appended one by one
+        // 
+        template<typename _InputIt>
+        void _SaveRange_Impl( _InputIt first, _InputIt last, std::input_iterator_tag )
+        {
+            for (; first != last; ++first) {
+                Save( *first );
+            }
+        }
+
+        //
+        // Makes room for 'count' objects and returns
+        // pointer to the first of them.
+        // 
+        unsigned char* _Grow( size_t count )
+        {
+            size_t offset = m_count * RecordSize();
+
+            m_buffer.resize( offset + count * RecordSize() );
+            m_count += count;
+
+            return m_buffer.data() + offset;
+        }
+
+    private:
+
+        //
+        // Number of stored objects
+        // 
+        size_t m_count;
 
         //
         // Internal buffer
@@ -151,10 +459,122 @@ namespace serialization {
 
     /************************************************************************************/
 
+    //
+    // Non-owning read-only view of serialized bytes.
+    // It can be used to deserialize objects directly from
+    // memory provided by caller (received packet, mapped
+    // file, etc.) without copying it into internal buffer.
+    // Memory must outlive the view.
+    // View can refer to one object (as BinaryBuffer does)
+    // or to several ones (as BinaryBatchBuffer does).
+    // 
+
+    template<
+        typename _Type /* Type to be stored */
+    > class BinaryBufferView
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        using value_t = _Type;
+
+    public:
+        BinaryBufferView() noexcept
+            : m_data( nullptr )
+            , m_size( 0 )
+        { }
+
+        BinaryBufferView( const unsigned char* data, size_t size )
+            : m_data( data )
+            , m_size( size )
+        {
+            if (m_size % RecordSize() != 0) {
+                throw std::invalid_argument( "Invalid size of serialized data" );
+            }
+        }
+
+        template<typename _Storage>
+        BinaryBufferView( const BasicBinaryBuffer<_Type, _Storage>& buffer ) noexcept
+            : m_data( buffer.Data() )
+            , m_size( buffer.IsEmpty() ? 0 : buffer.Size() )
+        { }
+
+        BinaryBufferView( const BinaryBatchBuffer<_Type>& buffer ) noexcept
+            : m_data( buffer.Data() )
+            , m_size( buffer.Size() )
+        { }
+
+        BinaryBufferView( const BinaryBufferView<_Type>& ) = default;
+        BinaryBufferView& operator=( const BinaryBufferView<_Type>& ) = default;
+
+        //
+        // Size of one serialized object in bytes
+        // 
+        static constexpr size_t RecordSize() noexcept
+        {
+            return reflection::Layout<value_t>::packedSize;
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        //
+        // Number of objects in view
+        // 
+        size_t Count() const noexcept
+        {
+            return m_size / RecordSize();
+        }
+
+        const unsigned char* Data() const noexcept
+        {
+            return m_data;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        //
+        // Loads object with specified index
+        // 
+        void Load( value_t& obj, size_t index = 0 ) const
+        {
+            if (IsEmpty()) {
+                throw std::logic_error( "Buffer is empty" );
+            }
+
+            if (index >= Count()) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            details::LoadBinary( obj, m_data + index * RecordSize() );
+        }
+
+    private:
+
+        //
+        // Pointer to external memory
+        // 
+        const unsigned char* m_data;
+
+        //
+        // Size of external memory in bytes
+        // 
+        size_t m_size;
+    };
+
+    /************************************************************************************/
+
     //
     // Basic buffer for string stream serialization.
     // It can be specialized and aliased with 
     // concrete I/O stream class template.
+    // Text is written with io_text::BasicTextWriter and
+    // read with io_text::BasicTextReader, that produce and
+    // parse the same text as io_operators do.
     // 
 
     template<
@@ -166,17 +586,16 @@ namespace serialization {
     {
         REFLECTION_CHECK_TYPE_EXTENDED( _Type );
 
-        using buffer_t = std::basic_stringstream<_Char, _Traits, _Allocator>;
+        using writer_t = io_text::BasicTextWriter<_Char, _Traits, _Allocator>;
+        using reader_t = io_text::BasicTextReader<_Char, _Traits>;
         using value_t = _Type;
 
     public:
         explicit BasicStringStreamBuffer( _Char separator = 0x0 )
             : m_isFull( false )
             , m_sep( separator )
-            , m_buffer( buffer_t{} )
-        {
-            m_buffer << io_manipulators::io_internal::set_separator( m_sep );
-        }
+            , m_writer( separator )
+        { }
 
         BasicStringStreamBuffer( const BasicStringStreamBuffer<_Type, _Char, _Traits, _Allocator>& ) = delete;
         BasicStringStreamBuffer& operator=( const BasicStringStreamBuffer<_Type, _Char, _Traits, _Allocator>& ) = delete;
@@ -192,25 +611,37 @@ namespace serialization {
         void Clear() noexcept
         {
             m_isFull = false;
+            m_writer.Clear();
         }
 
-        void Save( const value_t& obj )
+        //
+        // Text of saved object
+        // 
+
+        const _Char* Data() const noexcept
         {
-            using namespace io_operators;
+            return m_writer.Data();
+        }
 
-            if (m_isFull) {
-                Clear();
-            }
+        size_t Size() const noexcept
+        {
+            return m_writer.Size();
+        }
+
+        void Save( const value_t& obj )
+        {
+            //
+            // Previous object is replaced with new one
+            // 
+            Clear();
 
-            m_buffer << obj;
+            m_writer.Write( obj );
 
             m_isFull = true;
         }
 
         void Load( value_t& obj )
         {
-            using namespace io_operators;
-
             //
             // Check if buffer contains a value.
             // 
@@ -218,11 +649,8 @@ namespace serialization {
                 throw std::logic_error( "Buffer is empty" );
             }
 
-            buffer_t buffer_copy = buffer_t( m_buffer.str() );
-
-            buffer_copy >> io_manipulators::io_internal::set_separator( m_sep );
-
-            buffer_copy >> obj;
+            reader_t reader( m_writer.Data(), m_writer.Size(), m_sep );
+            reader.Read( obj );
         }
 
     private:
@@ -238,9 +666,9 @@ namespace serialization {
         _Char m_sep;
 
         //
-        // Internal buffer
+        // Writer, that contains text of saved object
         // 
-        buffer_t m_buffer;
+        writer_t m_writer;
     };
 
     //
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+#include "Buffers.h"
+#include "TypeList.h"
+
+#include <cstdint>
+#include <vector>
+
+
+/************************************************************************************
+ * Messages of several types
+ *
+ * The key-concept is following:
+ *  - Set of message types is given as type_list::TypeList. Tag of each
+ *    type is its index in list. Encoded message is its tag (1 byte, or 2
+ *    bytes for more than 256 types) followed by record in the same format
+ *    as BinaryBuffer stores it.
+ *  - For each operation (decoding, visiting, encoding) a table of function
+ *    pointers with one entry per type is built at compile-time. Message is
+ *    dispatched by its tag with a single indexed indirect call, so cost of
+ *    dispatch doesn't depend on number of types. There are neither chains
+ *    of comparisons nor virtual functions.
+ *  - Message<TypeList<...>> holds object of any of types (like std::variant
+ *    does). Types are POD, so message is trivially copyable.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+namespace details {
+
+    //
+    // Index of _Type in _Types (sizeof...( _Types ) if there is no such type)
+    //
+    template<typename _Type, typename... _Types>
+    constexpr size_t _IndexOf() noexcept
+    {
+        constexpr bool matches[] = { false, std::is_same<_Type, _Types>::value... };
+
+        for (size_t i = 0; i < sizeof...( _Types ); ++i)
+        {
+            if (matches[i + 1]) {
+                return i;
+            }
+        }
+
+        return sizeof...( _Types );
+    }
+
+    //
+    // Number of occurrences of _Type in _Types
+    //
+    template<typename _Type, typename... _Types>
+    constexpr size_t _CountOf() noexcept
+    {
+        constexpr bool matches[] = { false, std::is_same<_Type, _Types>::value... };
+
+        size_t count = 0;
+        for (bool match : matches) {
+            count += match ? 1 : 0;
+        }
+
+        return count;
+    }
+
+    template<size_t _Size>
+    constexpr size_t _MaxOf( const size_t( &values )[_Size] ) noexcept
+    {
+        size_t result = 0;
+        for (size_t value : values) {
+            result = value > result ? value : result;
+        }
+
+        return result;
+    }
+
+    //
+    // Type of tags
+    //
+    template<size_t _Count>
+    using _Tag_t = typename std::conditional<( _Count <= 256 ), uint8_t, uint16_t>::type;
+
+    /************************************************************************************/
+
+    //
+    // Entries of tables. Each entry is an instance of
+    // function template for one type from list.
+    //
+
+    template<typename _Type, typename _Handler>
+    void _DecodeAndHandle( const unsigned char* record, _Handler& handler )
+    {
+        _Type obj;
+        LoadBinary( obj, record );
+
+        handler( static_cast<const _Type&>( obj ) );
+    }
+
+    template<typename _Type>
+    void _DecodeInto( const unsigned char* record, void* storage )
+    {
+        LoadBinary( *static_cast<_Type*>( storage ), record );
+    }
+
+    template<typename _Type>
+    void _EncodeFrom( const void* storage, unsigned char* record )
+    {
+        SaveBinary( *static_cast<const _Type*>( storage ), record );
+    }
+
+    template<typename _Type, typename _Handler>
+    void _Handle( const void* storage, _Handler& handler )
+    {
+        handler( *static_cast<const _Type*>( storage ) );
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    template<
+        typename _TypeList /* type_list::TypeList of message types */
+    > class Message; /* Not implemented */
+
+    template<
+        typename _TypeList /* type_list::TypeList of message types */
+    > class MessageCodec; /* Not implemented */
+
+    //
+    // Object of any of message types
+    //
+
+    template<
+        typename... _Types /* Message types */
+    > class Message<type_list::TypeList<_Types...>>
+    {
+        static_assert( sizeof...( _Types ) > 0, "Message must have at least one type" );
+
+        static_assert(
+            traits::conjunction<is_supported_type<_Types>...>::value,
+            "Message types must match the requirements for reflection (see Support.h)"
+        );
+
+        static constexpr size_t _Sizes[] = { sizeof( _Types )... };
+        static constexpr size_t _Alignments[] = { alignof( _Types )... };
+
+        using storage_t = typename std::aligned_storage<
+            details::_MaxOf( _Sizes ), details::_MaxOf( _Alignments )
+        >::type;
+
+        template<typename> friend class MessageCodec;
+
+    public:
+
+        //
+        // Default message holds value-initialized
+        // object of the first type
+        //
+        Message() noexcept
+            : m_index( 0 )
+            , m_storage()
+        {
+            using first_t = decltype( type_list::get<0>( type_list::TypeList<_Types...>{} ) );
+            new ( &m_storage ) typename first_t::type{};
+        }
+
+        template<typename _Type>
+        Message( const _Type& obj ) noexcept
+            : m_index( IndexOf<_Type>() )
+            , m_storage()
+        {
+            new ( &m_storage ) _Type( obj );
+        }
+
+        //
+        // Index of type in list (the same as tag)
+        //
+        template<typename _Type>
+        static constexpr size_t IndexOf() noexcept
+        {
+            static_assert( details::_CountOf<_Type, _Types...>() == 1, "Type must occur in list exactly once" );
+
+            return details::_IndexOf<_Type, _Types...>();
+        }
+
+        //
+        // Index of type of stored object
+        //
+        size_t Index() const noexcept
+        {
+            return m_index;
+        }
+
+        template<typename _Type>
+        bool Is() const noexcept
+        {
+            return m_index == IndexOf<_Type>();
+        }
+
+        //
+        // Stored object. Throws std::logic_error,
+        // if message holds object of other type.
+        //
+
+        template<typename _Type>
+        const _Type& Get() const
+        {
+            if (!Is<_Type>()) {
+                throw std::logic_error( "Message contains object of other type" );
+            }
+
+            return *reinterpret_cast<const _Type*>( &m_storage );
+        }
+
+        template<typename _Type>
+        _Type& Get()
+        {
+            if (!Is<_Type>()) {
+                throw std::logic_error( "Message contains object of other type" );
+            }
+
+            return *reinterpret_cast<_Type*>( &m_storage );
+        }
+
+        template<typename _Type>
+        void Set( const _Type& obj ) noexcept
+        {
+            m_index = IndexOf<_Type>();
+            new ( &m_storage ) _Type( obj );
+        }
+
+        //
+        // Calls handler with stored object
+        //
+        template<typename _Handler>
+        void Visit( _Handler&& handler ) const
+        {
+            using entry_t = void( * )( const void*, _Handler& );
+
+            static constexpr entry_t table[] = { &details::_Handle<_Types, _Handler>... };
+
+            table[m_index]( &m_storage, handler );
+        }
+
+    private:
+
+        //
+        // Index of type of stored object
+        //
+        size_t m_index;
+
+        //
+        // Stored object
+        //
+        storage_t m_storage;
+    };
+
+    template<typename... _Types>
+    constexpr size_t Message<type_list::TypeList<_Types...>>::_Sizes[];
+
+    template<typename... _Types>
+    constexpr size_t Message<type_list::TypeList<_Types...>>::_Alignments[];
+
+    /************************************************************************************/
+
+    //
+    // Encoding, decoding and dispatching of messages
+    //
+
+    template<
+        typename... _Types /* Message types */
+    > class MessageCodec<type_list::TypeList<_Types...>>
+    {
+        using message_t = Message<type_list::TypeList<_Types...>>;
+        using tag_t = details::_Tag_t<sizeof...( _Types )>;
+
+        static constexpr size_t _RecordSizes[] = { reflection::Layout<_Types>::packedSize... };
+
+    public:
+
+        //
+        // Size of tag in bytes
+        //
+        static constexpr size_t TagSize() noexcept
+        {
+            return sizeof( tag_t );
+        }
+
+        //
+        // Size of encoded message of type _Type
+        //
+        template<typename _Type>
+        static constexpr size_t EncodedSize() noexcept
+        {
+            return TagSize() + reflection::Layout<_Type>::packedSize;
+        }
+
+        //
+        // Appends encoded object to buffer
+        //
+        template<typename _Type, typename _Allocator>
+        static void Encode( const _Type& obj, std::vector<unsigned char, _Allocator>& buffer )
+        {
+            constexpr size_t index = message_t::template IndexOf<_Type>();
+
+            auto dst = _Grow( buffer, EncodedSize<_Type>() );
+
+            _WriteTag( index, dst );
+            details::SaveBinary( obj, dst + TagSize() );
+        }
+
+        //
+        // Appends encoded message to buffer
+        //
+        template<typename _Allocator>
+        static void Encode( const message_t& message, std::vector<unsigned char, _Allocator>& buffer )
+        {
+            using entry_t = void( * )( const void*, unsigned char* );
+
+            static constexpr entry_t table[] = { &details::_EncodeFrom<_Types>... };
+
+            auto dst = _Grow( buffer, TagSize() + _RecordSizes[message.m_index] );
+
+            _WriteTag( message.m_index, dst );
+            table[message.m_index]( &message.m_storage, dst + TagSize() );
+        }
+
+        //
+        // Decodes message from the beginning of [data, data + size).
+        // Returns number of consumed bytes.
+        //
+        static size_t Decode( const unsigned char* data, size_t size, message_t& message )
+        {
+            using entry_t = void( * )( const unsigned char*, void* );
+
+            static constexpr entry_t table[] = { &details::_DecodeInto<_Types>... };
+
+            size_t index = _CheckMessage( data, size );
+
+            table[index]( data + TagSize(), &message.m_storage );
+            message.m_index = index;
+
+            return TagSize() + _RecordSizes[index];
+        }
+
+        //
+        // Decodes message from the beginning of [data, data + size)
+        // and calls handler with decoded object. Handler must accept
+        // each of types. Returns number of consumed bytes.
+        //
+        template<typename _Handler>
+        static size_t Dispatch( const unsigned char* data, size_t size, _Handler&& handler )
+        {
+            using entry_t = void( * )( const unsigned char*, _Handler& );
+
+            static constexpr entry_t table[] = { &details::_DecodeAndHandle<_Types, _Handler>... };
+
+            size_t index = _CheckMessage( data, size );
+            table[index]( data + TagSize(), handler );
+
+            return TagSize() + _RecordSizes[index];
+        }
+
+        //
+        // Dispatches all messages from buffer one by one.
+        // Returns number of messages.
+        //
+        template<typename _Handler>
+        static size_t DispatchAll( const unsigned char* data, size_t size, _Handler&& handler )
+        {
+            size_t count = 0;
+
+            for (size_t offset = 0; offset < size; ++count) {
+                offset += Dispatch( data + offset, size - offset, handler );
+            }
+
+            return count;
+        }
+
+    private:
+        template<typename _Allocator>
+        static unsigned char* _Grow( std::vector<unsigned char, _Allocator>& buffer, size_t size )
+        {
+            size_t offset = buffer.size();
+            buffer.resize( offset + size );
+
+            return buffer.data() + offset;
+        }
+
+        static void _WriteTag( size_t index, unsigned char* dst ) noexcept
+        {
+            for (size_t byte = 0; byte < TagSize(); ++byte) {
+                dst[byte] = static_cast<unsigned char>( index >> ( byte * 8 ) );
+            }
+        }
+
+        //
+        // Returns index of type of message. Throws
+        // std::runtime_error, if message is invalid.
+        //
+        static size_t _CheckMessage( const unsigned char* data, size_t size )
+        {
+            if (size < TagSize()) {
+                throw std::runtime_error( "Message is truncated" );
+            }
+
+            size_t index = 0;
+            for (size_t byte = 0; byte < TagSize(); ++byte) {
+                index |= static_cast<size_t>( data[byte] ) << ( byte * 8 );
+            }
+
+            if (index >= sizeof...( _Types )) {
+                throw std::runtime_error( "Unknown type of message" );
+            }
+
+            if (size - TagSize() < _RecordSizes[index]) {
+                throw std::runtime_error( "Message is truncated" );
+            }
+
+            return index;
+        }
+    };
+
+    template<typename... _Types>
+    constexpr size_t MessageCodec<type_list::TypeList<_Types...>>::_RecordSizes[];
+
+} // serialization
\ No newline at end of file
@@ -0,0 +1,700 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Reflection.h"
+#include "Layout.h"
+#include "Buffers.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <io.h>
+#else
+#   include <cerrno>
+#   include <unistd.h>
+#endif // defined(_WIN32)
+
+
+/************************************************************************************
+ * Framed streams
+ *
+ * The key-concept is following:
+ *  - Stream is a sequence of frames. Each frame contains size of record
+ *    (varint, 1 byte for records up to 127 bytes), 4-byte fingerprint of
+ *    type of record and the record itself in the same format as
+ *    BinaryBuffer stores it. So overhead is 5 bytes per frame for small
+ *    records.
+ *  - Fingerprint is a hash (FNV-1a) of ids returned by GetTypeIds, it is
+ *    calculated at compile-time. Records of types with the same layout
+ *    (the same types of fields in the same order, nested structures are
+ *    expanded) have the same fingerprint and are compatible in binary
+ *    format. So checking type of frame is a single integer comparison.
+ *  - Frames of unknown types are skipped by their size without looking
+ *    into them.
+ *  - Frames are written into sinks and read from sources. Sink provides
+ *    Write( data, size ) and Flush(), source provides Fetch( size ), that
+ *    returns pointer to next 'size' bytes (nullptr at the end of stream),
+ *    and Skip( size ). Memory and file descriptors (files, pipes, sockets)
+ *    are supported out of the box.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+namespace details {
+
+    //
+    // Size of varint with 32-bit value at most
+    //
+    static constexpr size_t _MaxVarintSize = 5;
+
+    //
+    // Size of fingerprint in frame
+    //
+    static constexpr size_t _FingerprintSize = sizeof( uint32_t );
+
+    //
+    // Default size of blocks of descriptor sinks and sources
+    //
+    static constexpr size_t _DefaultStreamBlockSize = 1 << 16;
+
+    /************************************************************************************/
+
+    //
+    // FNV-1a over lower 4 bytes of each id, so fingerprints
+    // are the same for 32-bit and 64-bit targets
+    //
+    template<typename _Type>
+    constexpr uint32_t _GetFingerprint_Impl() noexcept
+    {
+        constexpr auto ids = reflection::GetTypeIds<_Type>();
+
+        uint32_t hash = 2166136261u;
+
+        for (size_t i = 0; i < ids.Size(); ++i)
+        {
+            for (size_t byte = 0; byte < 4; ++byte)
+            {
+                hash ^= static_cast<uint32_t>( ( ids.data[i] >> ( byte * 8 ) ) & 0xFF );
+                hash *= 16777619u;
+            }
+        }
+
+        return hash;
+    }
+
+    //
+    // Little-endian varint. Returns number of written bytes.
+    //
+    inline size_t _WriteVarint( uint32_t value, unsigned char* dst ) noexcept
+    {
+        size_t size = 0;
+
+        while (value >= 0x80)
+        {
+            dst[size++] = static_cast<unsigned char>( value | 0x80 );
+            value >>= 7;
+        }
+
+        dst[size++] = static_cast<unsigned char>( value );
+
+        return size;
+    }
+
+    inline void _WriteFingerprint( uint32_t fingerprint, unsigned char* dst ) noexcept
+    {
+        for (size_t byte = 0; byte < _FingerprintSize; ++byte) {
+            dst[byte] = static_cast<unsigned char>( fingerprint >> ( byte * 8 ) );
+        }
+    }
+
+    inline uint32_t _ReadFingerprint( const unsigned char* src ) noexcept
+    {
+        uint32_t fingerprint = 0;
+
+        for (size_t byte = 0; byte < _FingerprintSize; ++byte) {
+            fingerprint |= static_cast<uint32_t>( src[byte] ) << ( byte * 8 );
+        }
+
+        return fingerprint;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Raw I/O on descriptors. Returns number of bytes
+    // or -1 on error. Interrupted calls are restarted.
+    //
+
+    inline long long _WriteDescriptor( int fd, const unsigned char* data, size_t size ) noexcept
+    {
+#if defined(_WIN32)
+        unsigned chunk = size > 0x40000000 ? 0x40000000 : static_cast<unsigned>( size );
+        return _write( fd, data, chunk );
+#else
+        ssize_t result;
+        do {
+            result = write( fd, data, size );
+        } while (result < 0 && errno == EINTR);
+
+        return result;
+#endif // defined(_WIN32)
+    }
+
+    inline long long _ReadDescriptor( int fd, unsigned char* data, size_t size ) noexcept
+    {
+#if defined(_WIN32)
+        unsigned chunk = size > 0x40000000 ? 0x40000000 : static_cast<unsigned>( size );
+        return _read( fd, data, chunk );
+#else
+        ssize_t result;
+        do {
+            result = read( fd, data, size );
+        } while (result < 0 && errno == EINTR);
+
+        return result;
+#endif // defined(_WIN32)
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Compile-time fingerprint of type
+    //
+    template<
+        typename _Type /* Type of records */
+    > constexpr uint32_t TypeFingerprint() noexcept
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        return details::_GetFingerprint_Impl<_Type>();
+    }
+
+    /************************************************************************************/
+
+    //
+    // Sink, that collects bytes in memory
+    //
+
+    class MemorySink
+    {
+    public:
+        MemorySink()
+            : m_buffer()
+        { }
+
+        void Write( const unsigned char* data, size_t size )
+        {
+            m_buffer.insert( m_buffer.end(), data, data + size );
+        }
+
+        void Flush() noexcept
+        { }
+
+        const unsigned char* Data() const noexcept
+        {
+            return m_buffer.data();
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_buffer.size();
+        }
+
+        //
+        // Memory is not released here
+        //
+        void Clear() noexcept
+        {
+            m_buffer.clear();
+        }
+
+    private:
+
+        //
+        // Written bytes
+        //
+        std::vector<unsigned char> m_buffer;
+    };
+
+    //
+    // Source over memory provided by caller.
+    // Memory must outlive the source.
+    //
+
+    class MemorySource
+    {
+    public:
+        MemorySource( const unsigned char* data, size_t size ) noexcept
+            : m_current( data )
+            , m_end( data + size )
+        { }
+
+        const unsigned char* Fetch( size_t size ) noexcept
+        {
+            if (static_cast<size_t>( m_end - m_current ) < size) {
+                return nullptr;
+            }
+
+            auto data = m_current;
+            m_current += size;
+
+            return data;
+        }
+
+        bool Skip( size_t size ) noexcept
+        {
+            return Fetch( size ) != nullptr;
+        }
+
+    private:
+
+        //
+        // Next byte
+        //
+        const unsigned char* m_current;
+
+        //
+        // End of memory
+        //
+        const unsigned char* m_end;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Sink over file descriptor (file, pipe, socket).
+    // Bytes are written by blocks. Descriptor is not
+    // closed by sink.
+    //
+
+    class DescriptorSink
+    {
+    public:
+        explicit DescriptorSink( int fd, size_t blockSize = details::_DefaultStreamBlockSize )
+            : m_fd( fd )
+            , m_blockSize( blockSize )
+            , m_buffer()
+        {
+            m_buffer.reserve( m_blockSize );
+        }
+
+        DescriptorSink( const DescriptorSink& ) = delete;
+        DescriptorSink& operator=( const DescriptorSink& ) = delete;
+
+        DescriptorSink( DescriptorSink&& ) = default;
+
+        ~DescriptorSink()
+        {
+            //
+            // Errors can not be reported from destructor,
+            // call Flush explicitly to get them.
+            //
+            try {
+                Flush();
+            }
+            catch (...) { }
+        }
+
+        void Write( const unsigned char* data, size_t size )
+        {
+            m_buffer.insert( m_buffer.end(), data, data + size );
+
+            if (m_buffer.size() >= m_blockSize) {
+                Flush();
+            }
+        }
+
+        void Flush()
+        {
+            auto data = m_buffer.data();
+            auto size = m_buffer.size();
+
+            while (size)
+            {
+                auto written = details::_WriteDescriptor( m_fd, data, size );
+
+                if (written < 0)
+                {
+                    m_buffer.clear();
+                    throw std::runtime_error( "Unable to write stream" );
+                }
+
+                data += written;
+                size -= static_cast<size_t>( written );
+            }
+
+            m_buffer.clear();
+        }
+
+    private:
+
+        //
+        // Output descriptor
+        //
+        int m_fd;
+
+        //
+        // Size of block in bytes
+        //
+        size_t m_blockSize;
+
+        //
+        // Current block
+        //
+        std::vector<unsigned char> m_buffer;
+    };
+
+    //
+    // Source over file descriptor. Bytes are read by
+    // blocks, records are decoded right from block.
+    // Descriptor is not closed by source.
+    //
+
+    class DescriptorSource
+    {
+    public:
+        explicit DescriptorSource( int fd, size_t blockSize = details::_DefaultStreamBlockSize )
+            : m_fd( fd )
+            , m_isEof( false )
+            , m_current( 0 )
+            , m_size( 0 )
+            , m_buffer( blockSize ? blockSize : 1 )
+        { }
+
+        DescriptorSource( const DescriptorSource& ) = delete;
+        DescriptorSource& operator=( const DescriptorSource& ) = delete;
+
+        DescriptorSource( DescriptorSource&& ) = default;
+
+        const unsigned char* Fetch( size_t size )
+        {
+            if (m_size - m_current < size && !_Fill( size )) {
+                return nullptr;
+            }
+
+            auto data = m_buffer.data() + m_current;
+            m_current += size;
+
+            return data;
+        }
+
+        bool Skip( size_t size )
+        {
+            //
+            // Skipped bytes are dropped block by block,
+            // so large frames don't grow the buffer
+            //
+            while (m_size - m_current < size)
+            {
+                size -= m_size - m_current;
+                m_current = m_size;
+
+                if (!_Fill( 1 )) {
+                    return false;
+                }
+            }
+
+            m_current += size;
+
+            return true;
+        }
+
+    private:
+
+        //
+        // Reads descriptor until at least 'size' bytes are
+        // available. Returns false at the end of stream.
+        //
+        bool _Fill( size_t size )
+        {
+            size_t tail = m_size - m_current;
+
+            if (m_current)
+            {
+                std::memmove( m_buffer.data(), m_buffer.data() + m_current, tail );
+
+                m_current = 0;
+                m_size = tail;
+            }
+
+            if (m_buffer.size() < size) {
+                m_buffer.resize( size );
+            }
+
+            while (m_size < size && !m_isEof)
+            {
+                auto read = details::_ReadDescriptor( m_fd, m_buffer.data() + m_size, m_buffer.size() - m_size );
+
+                if (read < 0) {
+                    throw std::runtime_error( "Unable to read stream" );
+                }
+
+                m_isEof = read == 0;
+                m_size += static_cast<size_t>( read );
+            }
+
+            return m_size >= size;
+        }
+
+    private:
+
+        //
+        // Input descriptor
+        //
+        int m_fd;
+
+        //
+        // Is the end of stream reached?
+        //
+        bool m_isEof;
+
+        //
+        // Position of next byte in block
+        //
+        size_t m_current;
+
+        //
+        // Number of bytes in block
+        //
+        size_t m_size;
+
+        //
+        // Current block
+        //
+        std::vector<unsigned char> m_buffer;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Writer of frames into sink
+    //
+
+    template<
+        typename _Sink /* Type of sink */
+    > class FrameWriter
+    {
+    public:
+        explicit FrameWriter( _Sink sink = _Sink{} )
+            : m_sink( std::move( sink ) )
+            , m_frame()
+        { }
+
+        //
+        // Writes frame with object. Frame is assembled in
+        // buffer of writer (not on stack, records may be
+        // large) and is passed to sink by one call.
+        //
+        template<typename _Type>
+        void Write( const _Type& obj )
+        {
+            REFLECTION_CHECK_TYPE( _Type );
+
+            constexpr size_t size = reflection::Layout<_Type>::packedSize;
+            constexpr uint32_t fingerprint = TypeFingerprint<_Type>();
+
+            if (m_frame.size() < details::_MaxVarintSize + details::_FingerprintSize + size) {
+                m_frame.resize( details::_MaxVarintSize + details::_FingerprintSize + size );
+            }
+
+            auto frame = m_frame.data();
+
+            auto header = details::_WriteVarint( static_cast<uint32_t>( size ), frame );
+            details::_WriteFingerprint( fingerprint, frame + header );
+
+            header += details::_FingerprintSize;
+            details::SaveBinary( obj, frame + header );
+
+            m_sink.Write( frame, header + size );
+        }
+
+        void Flush()
+        {
+            m_sink.Flush();
+        }
+
+        _Sink& Sink() noexcept
+        {
+            return m_sink;
+        }
+
+    private:
+
+        //
+        // Output sink
+        //
+        _Sink m_sink;
+
+        //
+        // Buffer of frame, it is reused by all frames
+        //
+        std::vector<unsigned char> m_frame;
+    };
+
+    //
+    // Reader of frames from source. Next reads header of
+    // frame, then its record is either read or skipped.
+    //
+
+    template<
+        typename _Source /* Type of source */
+    > class FrameReader
+    {
+    public:
+        explicit FrameReader( _Source source )
+            : m_source( std::move( source ) )
+            , m_hasFrame( false )
+            , m_size( 0 )
+            , m_fingerprint( 0 )
+        { }
+
+        //
+        // Moves to the next frame. Record of current frame
+        // is skipped, if it is not read. Returns false at
+        // the end of stream.
+        //
+        bool Next()
+        {
+            if (m_hasFrame) {
+                Skip();
+            }
+
+            auto byte = m_source.Fetch( 1 );
+            if (!byte) {
+                return false;
+            }
+
+            //
+            // Size of record (varint)
+            //
+            uint32_t size = *byte & 0x7F;
+
+            for (size_t shift = 7; *byte & 0x80; shift += 7)
+            {
+                byte = m_source.Fetch( 1 );
+
+                if (!byte || shift >= 7 * details::_MaxVarintSize) {
+                    throw std::runtime_error( "Invalid frame" );
+                }
+
+                size |= static_cast<uint32_t>( *byte & 0x7F ) << shift;
+            }
+
+            auto fingerprint = m_source.Fetch( details::_FingerprintSize );
+            if (!fingerprint) {
+                throw std::runtime_error( "Invalid frame" );
+            }
+
+            m_hasFrame = true;
+            m_size = size;
+            m_fingerprint = details::_ReadFingerprint( fingerprint );
+
+            return true;
+        }
+
+        //
+        // Does current frame contain object of type _Type?
+        //
+        template<typename _Type>
+        bool Is() const noexcept
+        {
+            constexpr uint32_t fingerprint = TypeFingerprint<_Type>();
+
+            return m_hasFrame && m_fingerprint == fingerprint;
+        }
+
+        //
+        // Fingerprint and size of record of current frame
+        //
+
+        uint32_t Fingerprint() const noexcept
+        {
+            return m_fingerprint;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        //
+        // Reads record of current frame
+        //
+        template<typename _Type>
+        void Read( _Type& obj )
+        {
+            if (!m_hasFrame) {
+                throw std::logic_error( "There is no frame" );
+            }
+
+            if (!Is<_Type>()) {
+                throw std::logic_error( "Frame contains object of other type" );
+            }
+
+            if (m_size != reflection::Layout<_Type>::packedSize) {
+                throw std::runtime_error( "Invalid frame" );
+            }
+
+            auto record = m_source.Fetch( m_size );
+            if (!record) {
+                throw std::runtime_error( "Frame is truncated" );
+            }
+
+            details::LoadBinary( obj, record );
+            m_hasFrame = false;
+        }
+
+        //
+        // Skips record of current frame
+        //
+        void Skip()
+        {
+            if (!m_hasFrame) {
+                throw std::logic_error( "There is no frame" );
+            }
+
+            m_hasFrame = false;
+
+            if (!m_source.Skip( m_size )) {
+                throw std::runtime_error( "Frame is truncated" );
+            }
+        }
+
+        _Source& Source() noexcept
+        {
+            return m_source;
+        }
+
+    private:
+
+        //
+        // Input source
+        //
+        _Source m_source;
+
+        //
+        // Is header of frame read, but its record is not?
+        //
+        bool m_hasFrame;
+
+        //
+        // Size of record of current frame
+        //
+        size_t m_size;
+
+        //
+        // Fingerprint of current frame
+        //
+        uint32_t m_fingerprint;
+    };
+
+} // serialization
\ No newline at end of file
@@ -24,6 +24,7 @@ namespace details {
     //
     // Stucture used to wrap reference to variable of one type
     // and then assign to variable of any type (types must be convertible to each other).
+    // If _Stored is an rvalue reference, the value is moved from.
     // 
     template<typename _Stored>
     struct TypeCaster
@@ -31,7 +32,7 @@ namespace details {
         // 
         // Reference to external value
         // 
-        _Stored& value;
+        _Stored&& value;
 
         template<typename _Type>
         constexpr operator _Type() const noexcept
@@ -41,7 +42,7 @@ namespace details {
             // But _Stored can be uderlying type of enumeration of type _Type. That is 
             // the reason, why it is necessary to use 'static_cast' here.
             // 
-            return static_cast<_Type>( value );
+            return static_cast<_Type>( std::forward<_Stored>( value ) );
         }
     };
 
@@ -61,7 +62,7 @@ namespace details {
 
         static_assert( 
             sizeof...( _Idxs ) == sizeof...( _Types ), 
-            "Types and indices amounts mismatch in " __FUNCTION__ 
+            "Types and indices amounts mismatch in _FromTuple_Impl"
         );
 
         //
@@ -72,6 +73,29 @@ namespace details {
         };
     }
 
+    //
+    // rvalue reference
+    // Each element is moved into corresponding field.
+    // 
+    template<typename _Type, typename... _Types, size_t... _Idxs>
+    constexpr _Type _FromTuple_Impl( types::Tuple<_Types...>&& tpl, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        using types::get;
+
+        static_assert( 
+            sizeof...( _Idxs ) == sizeof...( _Types ), 
+            "Types and indices amounts mismatch in _FromTuple_Impl"
+        );
+
+        //
+        // Tuple is forwarded several times, but each
+        // time different element is taken and moved.
+        // 
+        return _Type{ 
+            TypeCaster<decltype( get<_Idxs>( std::move( tpl ) ) )>{ get<_Idxs>( std::move( tpl ) ) }... 
+        };
+    }
+
 } // details
 
                              /* ^^^  Library internals  ^^^ */
@@ -95,4 +119,21 @@ namespace details {
         );
     }
 
+    //
+    // rvalue reference
+    // Elements of tuple are moved into object, so
+    // tuple of strings (for instance) is not copied.
+    // 
+    template<typename _Type, typename... _Types>
+    constexpr _Type FromTuple( types::Tuple<_Types...>&& tpl ) noexcept
+    {
+        using _CleanType = typename std::remove_cv<_Type>::type;
+
+        REFLECTION_CHECK_TYPE_EXTENDED( _CleanType );
+
+        return details::_FromTuple_Impl<_Type>( 
+            std::move( tpl ), std::make_index_sequence<sizeof...( _Types )>{} 
+        );
+    }
+
 } // reflection
\ No newline at end of file
@@ -12,13 +12,14 @@
  * The key-concept is following:
  *  - _Type{ val1, val2, ..., valn } will be compiled successfully only in case, 
  *    when n is less or equal than amount of fields in structure _Type.
- *  - We can use SFINAE idiom to detect the moment of equality of n and amount of 
- *    fields. We just need to start from one big amount of fields and to keep 
- *    substitute corresponding amount of values into a aggregate initialization 
- *    until we succeed.
+ *  - We can use SFINAE idiom to detect if initialization with n values succeeds.
+ *    Amount of fields is the biggest n, for which it succeeds.
  *  - Maximum amount of fields in structure is sizeof( _Type ), because it 
  *    corresponds to structure with only fields of type char (or another byte-sized 
  *    type). Here we don't expect bit fields.
+ *  - Initialization succeeds for all n up to amount of fields and fails for all n
+ *    above it, so we use binary search over [0, sizeof( _Type )]. It requires
+ *    O(log(sizeof( _Type ))) instantiations instead of O(sizeof( _Type )).
  *    
  ************************************************************************************/
 
@@ -43,49 +44,72 @@ namespace details {
     /************************************************************************************/
 
     //
-    // Function template that returns amount of _Type's fields.
-    // This template is more specialized => it must win overload
-    // resolution to the next one below.
+    // Checks if _Type can be initialized with sizeof...( _Idxs ) values.
+    // Initialization can fail only in case when amount of fields is less 
+    // than items in aggregate initialization list. Failure is not threated
+    // as error due to SFINAE.
     // 
     template<
-        typename  _Type /* Type to count fields in */,
-        size_t    _Idx  /* First index */,
-        size_t... _Idxs /* Rest indices of internal types inside _Type */
-    > constexpr auto _GetFieldsCount_Impl( std::index_sequence<_Idx, _Idxs...> /* indices */ ) noexcept
-        -> decltype
-        ( 
-            /* Attempt to aggregate initialization with specified amount of params.
-             * Failure is not threated as error due to SFINAE. Initialization can fail
-             * only in case when amount of fields is less than items in aggregate
-             * initialization list. Otherwise initialization succeeds. */
-            _Type{ _UniversalInit<_Idx>{}, _UniversalInit<_Idxs>{}... }, 
-
-            /* But as return type we use size_t (comma operator used here) */
-            size_t{}
-        )
+        typename _Type      /* Type to initialize */,
+        typename _IdxsType  /* Indices of values in initialization list */,
+        typename /* _Void */ = void
+    > struct _IsInitializable : std::false_type { };
+
+    template<
+        typename  _Type /* Type to initialize */,
+        size_t... _Idxs /* Indices of values in initialization list */
+    > struct _IsInitializable<
+        _Type, 
+        std::index_sequence<_Idxs...>,
+        traits::void_t<decltype( _Type{ _UniversalInit<_Idxs>{}... } )>
+    > : std::true_type { };
+
+    //
+    // Binary search of fields count in [_Low, _High].
+    // _Type can always be initialized with _Low values.
+    // 
+    template<
+        typename _Type /* Type to count fields in */,
+        size_t   _Low  /* Lower bound of fields count */,
+        size_t   _High /* Upper bound of fields count */
+    > struct _FieldsCountSearch
     {
         //
-        // In case of successful instantiation of function 
-        // template we receive type's fields count.
+        // Middle is rounded up, so range becomes
+        // smaller at each step in both branches.
         // 
-        return sizeof...( _Idxs ) + 1;
-    }
+        static constexpr size_t middle = _Low + (_High - _Low + 1) / 2;
+
+        //
+        // std::conditional instantiates only one of branches
+        // 
+        static constexpr size_t value = std::conditional<
+            _IsInitializable<_Type, std::make_index_sequence<middle>>::value,
+            _FieldsCountSearch<_Type, middle, _High>,
+            _FieldsCountSearch<_Type, _Low, middle - 1>
+        >::type::value;
+    };
 
     //
-    // Function template that reduces amount of parameters by one.
+    // Specialization to break recursive instantiation
+    // when range contains the only value.
     // 
     template<
-        typename  _Type /* Type to count fields in */,
-        size_t... _Idxs /* Indices of internal types */
-    > constexpr size_t _GetFieldsCount_Impl( std::index_sequence<_Idxs...> /* indices */ ) noexcept
+        typename _Type /* Type to count fields in */,
+        size_t   _Count /* Fields count */
+    > struct _FieldsCountSearch<_Type, _Count, _Count>
     {
-        //
-        // First template was instantiated unsuccessfully,
-        // Reducing parameters amount by one and trying again.
-        // 
-        return _GetFieldsCount_Impl<_Type>( 
-            std::make_index_sequence<sizeof...( _Idxs ) - 1>{} 
-        );
+        static constexpr size_t value = _Count;
+    };
+
+    //
+    // Returns amount of _Type's fields.
+    // 
+    template<
+        typename _Type /* Type to count fields in */
+    > constexpr size_t _GetFieldsCount_Impl() noexcept
+    {
+        return _FieldsCountSearch<_Type, 0, sizeof( _Type )>::value;
     }
 
 } // details
@@ -102,9 +126,7 @@ namespace details {
 
         REFLECTION_CHECK_TYPE_EXTENDED( _CleanType );
 
-        return details::_GetFieldsCount_Impl<_Type>( 
-            std::make_index_sequence<sizeof( _Type )>{} 
-        );
+        return details::_GetFieldsCount_Impl<_Type>();
     }
 
     template<
@@ -117,9 +139,7 @@ namespace details {
 
         REFLECTION_CHECK_TYPE_EXTENDED( _CleanType );
 
-        return details::_GetFieldsCount_Impl<_Type>( 
-            std::make_index_sequence<sizeof( _Type )>{} 
-        );
+        return details::_GetFieldsCount_Impl<_Type>();
     }
 
 } // reflection
\ No newline at end of file
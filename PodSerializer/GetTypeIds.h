@@ -66,6 +66,16 @@ namespace details {
     REFLECTION_REGISTER_TYPE( const volatile void*, 22 );
     REFLECTION_REGISTER_TYPE( nullptr_t           , 23 );
 
+    //
+    // Defined below, it is necessary to declare it
+    // here, because it is used by '_GetIdsByType'
+    // 
+    template<
+        typename  _Type /* Type to convert into raw types ids array */,
+        size_t... _Idxs /* Indices of internal types */
+    > constexpr auto _GetIdsRaw_Impl( std::index_sequence<_Idxs...> ) noexcept
+        -> types::SizeTArray<sizeof( _Type )>;
+
     //
     // This function used to support nested structures. It returns an
     // array of identifiers recursively. Then this array and external
@@ -85,9 +95,22 @@ namespace details {
 
     /************************************************************************************/
 
+    //
+    // Rounds offset up to the nearest multiple of alignment.
+    // 
+    constexpr size_t _AlignOffset( size_t offset, size_t alignment ) noexcept
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /************************************************************************************/
+
     //
     // This structure used to write array of offsets
     // of fields in structure.
+    // Each offset is the end of previous field rounded up
+    // to alignment of current field, i.e. it is exactly
+    // the offset of field inside of structure.
     // 
     template<
         size_t _Idx  /* Index of type inside of structure */,
@@ -101,7 +124,9 @@ namespace details {
             typename _Type /* Type to be initialized */
         > constexpr operator _Type() const noexcept
         {
-            const_cast<size_t*>( pOffsets )[_Idx] = _Idx != 0 ? pOffsets[_Idx - 1] + pSizes[_Idx - 1] : 0;
+            const_cast<size_t*>( pOffsets )[_Idx] = _AlignOffset( 
+                _Idx != 0 ? pOffsets[_Idx - 1] + pSizes[_Idx - 1] : 0, alignof( _Type ) 
+            );
             const_cast<size_t*>( pSizes )[_Idx] = sizeof( _Type );
             return _Type{};
         }
@@ -157,7 +182,7 @@ namespace details {
             // This function template is responsible for enumeration types
             // 
             Assign( 
-                _GetIdByType( IdenticalType<std::underlying_type<_Type>::type>{} ) 
+                _GetIdByType( IdenticalType<typename std::underlying_type<_Type>::type>{} ) 
             );
         }
 
@@ -207,35 +232,42 @@ namespace details {
         typename  _Type /* Type to convert into raw types ids array */,
         size_t... _Idxs /* Indices of internal types */
     > constexpr auto _GetIdsRaw_Impl( std::index_sequence<_Idxs...> ) noexcept
+        -> types::SizeTArray<sizeof( _Type )>
     {
         using types::SizeTArray;
 
         //
-        // Each id will be written at index equal to sum of sizes
-        // of all previous types in struct. Actual indices will
-        // be stored in 'offsets'
+        // Each id will be written at index equal to offset of
+        // corresponding field in struct. Offsets of nested
+        // structures' fields are relative to the beginning
+        // of nested structure, so merged arrays give actual
+        // offsets too. Offsets of top-level fields will be 
+        // stored in 'offsets'.
+        // Arrays are not constexpr: they are modified during
+        // constant evaluation, that is allowed since C++14
+        // for objects, whose lifetime began within it.
         // 
-        constexpr SizeTArray<sizeof( _Type )> idsRaw{ { 0 } };
-        constexpr SizeTArray<sizeof...( _Idxs )> offsets{ { 0 } };
-        constexpr SizeTArray<sizeof...( _Idxs )> sizes /* dummy */ { { 0 } }; 
+        SizeTArray<sizeof( _Type )> idsRaw{ { 0 } };
+        SizeTArray<sizeof...( _Idxs )> offsets{ { 0 } };
+        SizeTArray<sizeof...( _Idxs )> sizes /* dummy */ { { 0 } }; 
 
         //
         // Write offsets of each id into array by creating temporary object.
         // 
-        constexpr _Type temporary1{
-            _OffsetsUniversalInit<_Idxs, sizeof...( _Idxs )>{ 
-                const_cast<size_t*>( offsets.data ), 
-                const_cast<size_t*>( sizes.data ) 
-            }...
+        const _Type temporary1{
+            _OffsetsUniversalInit<_Idxs, sizeof...( _Idxs )>{ offsets.data, sizes.data }...
         };
 
         //
         // Here we write ids into array by creating temporary object.
         // 
-        constexpr _Type temporary2{ 
-            _IndexedUniversalInit<_Idxs>{ const_cast<size_t*>( idsRaw.data + offsets.data[_Idxs] ) }... 
+        const _Type temporary2{ 
+            _IndexedUniversalInit<_Idxs>{ idsRaw.data + offsets.data[_Idxs] }... 
         };
 
+        static_cast<void>( temporary1 );
+        static_cast<void>( temporary2 );
+
         return idsRaw;
     }
 
@@ -258,11 +290,11 @@ namespace details {
         // Here we need to remove all zeros from 'idsRaw' array.
         // Use helper class ArrayTransformer.
         // 
-        constexpr SizeTArray<idsRaw.CountNonZeros()> idsWithoutZeros{ { 0 } };
+        SizeTArray<idsRaw.CountNonZeros()> idsWithoutZeros{ { 0 } };
 
-        constexpr ArrayToNonZeros<sizeof( _Type )> transform{ 
+        const ArrayToNonZeros<sizeof( _Type )> transform{ 
             const_cast<size_t*>( idsRaw.data ), 
-            const_cast<size_t*>( idsWithoutZeros.data ) 
+            idsWithoutZeros.data 
         };
         transform.Run();
 
@@ -37,6 +37,16 @@ namespace details {
     // This strcuture describes a key part of compile-time mapping.
     // 
 
+    //
+    // GCC warns, that friend declaration is not a template, but
+    // it is exactly what is necessary here: each key declares
+    // its own non-template function, that is defined later.
+    // 
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wnon-template-friend"
+#endif // defined(__GNUC__) && !defined(__clang__)
+
     template<
         typename _Type /* External struct type */,
         size_t   _Idx  /* Index of field in this structure */
@@ -55,6 +65,10 @@ namespace details {
         ) noexcept;
     };
 
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif // defined(__GNUC__) && !defined(__clang__)
+
     /************************************************************************************/
 
     //
@@ -6,34 +6,25 @@ namespace io_manipulators {
 namespace io_internal {
 
     //
-    // Separator inserter. For internal use.
-    //
-    
-    static int const separator_fmt_id = std::ios_base::xalloc();
+    // Separator detector. For internal use.
+    // 
 
-    template<typename _Char>
-    struct _SeparatorTag
-    {
-        explicit _SeparatorTag( _Char ch )
-            : m_sep( ch ) { }
+    static int const is_separator_set_fmt_id = std::ios_base::xalloc();
 
-        _Char m_sep;
+    enum separator_settings
+    {
+        separator_enabled = 1
     };
 
-    template<typename _Char>
-    _SeparatorTag<_Char> set_separator( _Char _Sep )
-    { return _SeparatorTag<_Char>{ _Sep }; }
-
     template<
         typename _Char /* Type of chars used in stream */,
         typename _Traits
             = std::char_traits<_Char>
     > constexpr std::basic_ostream<_Char, _Traits>& operator<<(
-        std::basic_ostream<_Char, _Traits>& stream, const _SeparatorTag<_Char>& sep
+        std::basic_ostream<_Char, _Traits>& stream, separator_settings flag
     )
     {
-        stream.iword( separator_fmt_id ) = sep.m_sep;
-        stream.iword( is_separator_set_fmt_id ) = io_manipulators::io_internal::separator_enabled;
+        stream.iword( is_separator_set_fmt_id ) = flag;
         return stream;
     }
 
@@ -42,36 +33,44 @@ namespace io_internal {
         typename _Traits
             = std::char_traits<_Char>
     > constexpr std::basic_istream<_Char, _Traits>& operator>>(
-        std::basic_istream<_Char, _Traits>& stream, const _SeparatorTag<_Char>& sep
+        std::basic_istream<_Char, _Traits>& stream, separator_settings flag
     )
     {
-        stream.iword( separator_fmt_id ) = sep.m_sep;
-        stream.iword( is_separator_set_fmt_id ) = io_manipulators::io_internal::separator_enabled;
+        stream.iword( is_separator_set_fmt_id ) = flag;
         return stream;
     }
 
     /************************************************************************************/
 
     //
-    // Separator detector. For internal use.
-    // 
-
-    static int const is_separator_set_fmt_id = std::ios_base::xalloc();
+    // Separator inserter. For internal use.
+    //
+    
+    static int const separator_fmt_id = std::ios_base::xalloc();
 
-    enum separator_settings
+    template<typename _Char>
+    struct _SeparatorTag
     {
-        separator_enabled = 1
+        explicit _SeparatorTag( _Char ch )
+            : m_sep( ch ) { }
+
+        _Char m_sep;
     };
 
+    template<typename _Char>
+    _SeparatorTag<_Char> set_separator( _Char _Sep )
+    { return _SeparatorTag<_Char>{ _Sep }; }
+
     template<
         typename _Char /* Type of chars used in stream */,
         typename _Traits
             = std::char_traits<_Char>
     > constexpr std::basic_ostream<_Char, _Traits>& operator<<(
-        std::basic_ostream<_Char, _Traits>& stream, separator_settings flag
+        std::basic_ostream<_Char, _Traits>& stream, const _SeparatorTag<_Char>& sep
     )
     {
-        stream.iword( is_separator_set_fmt_id ) = flag;
+        stream.iword( separator_fmt_id ) = sep.m_sep;
+        stream.iword( is_separator_set_fmt_id ) = io_manipulators::io_internal::separator_enabled;
         return stream;
     }
 
@@ -80,10 +79,11 @@ namespace io_internal {
         typename _Traits
             = std::char_traits<_Char>
     > constexpr std::basic_istream<_Char, _Traits>& operator>>(
-        std::basic_istream<_Char, _Traits>& stream, separator_settings flag
+        std::basic_istream<_Char, _Traits>& stream, const _SeparatorTag<_Char>& sep
     )
     {
-        stream.iword( is_separator_set_fmt_id ) = flag;
+        stream.iword( separator_fmt_id ) = sep.m_sep;
+        stream.iword( is_separator_set_fmt_id ) = io_manipulators::io_internal::separator_enabled;
         return stream;
     }
 
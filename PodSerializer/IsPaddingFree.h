@@ -0,0 +1,81 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+
+
+/************************************************************************************
+ * IsPaddingFree function
+ *
+ * The key-concept is following:
+ *  - Layout describes all fundamental fields in structure (including fields
+ *    of nested structures). Sum of their sizes is a size of structure without
+ *    any padding.
+ *  - If this sum is equal to sizeof( _Type ), there is no padding at all and
+ *    object can be copied byte-by-byte with a single memcpy.
+ *
+ ************************************************************************************/
+
+
+namespace reflection {
+
+    //
+    // Returns sum of sizes of all fields in structure,
+    // i.e. size of structure without any padding.
+    //
+
+    template<
+        typename _Type /* Type to calculate packed size of */
+    > constexpr size_t GetPackedSize() noexcept
+    {
+        using _CleanType = typename std::remove_cv<_Type>::type;
+
+        REFLECTION_CHECK_TYPE( _CleanType );
+
+        return Layout<_CleanType>::packedSize;
+    }
+
+    template<
+        typename _Type /* Type to calculate packed size of */
+    > constexpr size_t GetPackedSize(
+        const _Type& /* obj */ /* For implicit template parameter deduction */
+    ) noexcept
+    {
+        return GetPackedSize<_Type>();
+    }
+
+    /************************************************************************************/
+
+    //
+    // Checks if structure contains no padding bytes.
+    // Such structures have the same layout in memory and
+    // in binary buffer, so they can be copied with memcpy.
+    //
+
+    template<
+        typename _Type /* Type to check */
+    > constexpr bool IsPaddingFree() noexcept
+    {
+        return GetPackedSize<_Type>() == sizeof( _Type );
+    }
+
+    template<
+        typename _Type /* Type to check */
+    > constexpr bool IsPaddingFree(
+        const _Type& /* obj */ /* For implicit template parameter deduction */
+    ) noexcept
+    {
+        return IsPaddingFree<_Type>();
+    }
+
+    //
+    // The same as IsPaddingFree, but in form of
+    // a trait, that can be used for tag dispatch.
+    //
+
+    template<typename _Type>
+    using is_padding_free = std::integral_constant<bool, IsPaddingFree<_Type>()>;
+
+} // reflection
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Reflection.h"
+#include "Tuple.h"
+#include "Sort.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif // defined(_MSC_VER)
+
+
+/************************************************************************************
+ * Memcmp-comparable keys
+ *
+ * The key-concept is following:
+ *  - Fields of object (or first several ones) are got with ToTuplePreciseView
+ *    and written one after another, nested structures are written field
+ *    by field recursively. So comparison of keys with memcmp gives the same
+ *    result as lexicographic comparison of fields.
+ *  - Numbers are converted into unsigned integers with the same order (the
+ *    same as radix sort does: sign bit of signed integers is flipped, all
+ *    bits of negative floating-point numbers are flipped) and written in
+ *    big-endian order. Enumerations are written as underlying types.
+ *  - Negative zero is written as positive one, since they are equal as
+ *    numbers. All NaNs are written as the same quiet NaN, which goes after
+ *    positive infinity: NaNs are equal to each other and greater than any
+ *    number in keys, though they are unordered as fields.
+ *  - Strings are written char by char (big-endian as well) and terminated
+ *    with zero char followed by 0x00 byte. Zero chars inside of strings are
+ *    followed by 0xFF byte, so terminator is less than any char and string
+ *    goes before all its continuations.
+ *  - The first 8 bytes of key can be compared as a single integer before
+ *    the rest of key is compared with memcmp.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+namespace details {
+
+    /************************************************************************************/
+
+    //
+    // Tags of field categories
+    //
+
+    struct _KeyIntegerTag { };
+    struct _KeyFloatTag { };
+    struct _KeyEnumTag { };
+    struct _KeyStringTag { };
+    struct _KeyStructTag { };
+
+    template<typename _Type>
+    struct _IsKeyString : std::false_type { };
+
+    template<typename _Char, typename _Traits, typename _Allocator>
+    struct _IsKeyString<std::basic_string<_Char, _Traits, _Allocator>> : std::true_type { };
+
+    template<typename _Type>
+    using _KeyTag_t =
+        typename std::conditional<std::is_integral<_Type>::value, _KeyIntegerTag,
+        typename std::conditional<std::is_floating_point<_Type>::value, _KeyFloatTag,
+        typename std::conditional<std::is_enum<_Type>::value, _KeyEnumTag,
+        typename std::conditional<_IsKeyString<_Type>::value, _KeyStringTag,
+            _KeyStructTag
+        >::type>::type>::type>::type;
+
+    //
+    // Escape bytes of strings
+    //
+    static constexpr unsigned char _KeyTerminator = 0x00;
+    static constexpr unsigned char _KeyEscape = 0xFF;
+
+    /************************************************************************************/
+
+    //
+    // Appends unsigned integer in big-endian order
+    //
+    template<typename _Key, typename _Allocator>
+    void _AppendBigEndian( _Key value, std::vector<unsigned char, _Allocator>& key )
+    {
+        unsigned char bytes[sizeof( _Key )];
+
+        for (size_t i = 0; i < sizeof( _Key ); ++i) {
+            bytes[i] = static_cast<unsigned char>( value >> ( ( sizeof( _Key ) - 1 - i ) * 8 ) );
+        }
+
+        key.insert( key.end(), bytes, bytes + sizeof( _Key ) );
+    }
+
+    //
+    // Loads 8 bytes in big-endian order (all supported
+    // targets are little-endian)
+    //
+    inline uint64_t _LoadBigEndian( const unsigned char* bytes ) noexcept
+    {
+        uint64_t word;
+        std::memcpy( &word, bytes, sizeof( word ) );
+
+#if defined(_MSC_VER)
+        return _byteswap_uint64( word );
+#else
+        return __builtin_bswap64( word );
+#endif // defined(_MSC_VER)
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( const _Type& value, std::vector<unsigned char, _Allocator>& key );
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( _Type value, std::vector<unsigned char, _Allocator>& key, _KeyIntegerTag )
+    {
+        _AppendBigEndian( columnar::details::_ToRadixKey( value ), key );
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( _Type value, std::vector<unsigned char, _Allocator>& key, _KeyFloatTag )
+    {
+        static_assert( sizeof( _Type ) == 4 || sizeof( _Type ) == 8,
+            "Only 32-bit and 64-bit floating-point numbers can be encoded" );
+
+        //
+        // Equal numbers must give equal keys, but -0.0 and NaNs
+        // with different payloads have different bits
+        //
+        if (value == _Type( 0 )) {
+            value = _Type( 0 );
+        }
+        else if (value != value) {
+            value = std::numeric_limits<_Type>::quiet_NaN();
+        }
+
+        _AppendBigEndian( columnar::details::_ToRadixKey( value ), key );
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( _Type value, std::vector<unsigned char, _Allocator>& key, _KeyEnumTag )
+    {
+        using actual_t = typename std::underlying_type<_Type>::type;
+
+        _EncodeValue( static_cast<actual_t>( value ), key, _KeyIntegerTag{} );
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( const _Type& value, std::vector<unsigned char, _Allocator>& key, _KeyStringTag )
+    {
+        using char_t = typename _Type::value_type;
+        using unit_t = columnar::details::_RadixKey_t<char_t>;
+
+        //
+        // Each char takes at least one byte, terminator takes one more
+        //
+        key.reserve( key.size() + ( value.size() + 1 ) * sizeof( char_t ) + 1 );
+
+        for (char_t ch : value)
+        {
+            //
+            // Chars are compared as unsigned ones, the
+            // same as std::char_traits<char> does
+            //
+            _AppendBigEndian( static_cast<unit_t>( ch ), key );
+
+            if (ch == char_t{}) {
+                key.push_back( _KeyEscape );
+            }
+        }
+
+        _AppendBigEndian( unit_t{}, key );
+        key.push_back( _KeyTerminator );
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( const _Type& value, std::vector<unsigned char, _Allocator>& key, _KeyStructTag )
+    {
+        static_assert( is_supported_type_extended<_Type>::value,
+            "Only numbers, enumerations, strings and structures can be encoded into keys" );
+
+        types::for_each( reflection::ToTuplePreciseView( value ), [&key]( const auto& field ) {
+            _EncodeValue( field, key );
+        } );
+    }
+
+    template<typename _Type, typename _Allocator>
+    void _EncodeValue( const _Type& value, std::vector<unsigned char, _Allocator>& key )
+    {
+        _EncodeValue( value, key, _KeyTag_t<_Type>{} );
+    }
+
+    //
+    // Encodes first fields of object
+    //
+    template<
+        typename  _Type      /* Type of object */,
+        typename  _Allocator /* Allocator of key */,
+        size_t... _Idxs      /* Indices of encoded fields */
+    > void _EncodeFields( const _Type& obj, std::vector<unsigned char, _Allocator>& key, std::index_sequence<_Idxs...> /* indices */ )
+    {
+        auto view = reflection::ToTuplePreciseView( obj );
+
+        int dummy[] = { 0, ( _EncodeValue( types::get<_Idxs>( view ), key ), 0 )... };
+        (void)dummy;
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Encodes first _Count fields of object into key. Keys of
+    // two objects compared with CompareKeys (or memcmp, if
+    // both keys are of the same size) are ordered the same
+    // way as their fields compared one by one (except for
+    // NaNs: they are equal to each other and go after all
+    // numbers). Previous content of key is replaced.
+    //
+
+    template<
+        size_t   _Count     /* Number of encoded fields */,
+        typename _Type      /* Type of object */,
+        typename _Allocator /* Allocator of key */
+    > void EncodeKeyPrefix( const _Type& obj, std::vector<unsigned char, _Allocator>& key )
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        static_assert( _Count <= reflection::GetFieldsCount<_Type>(), "Too many fields are requested" );
+
+        key.clear();
+        details::_EncodeFields( obj, key, std::make_index_sequence<_Count>{} );
+    }
+
+    //
+    // Encodes all fields of object into key
+    //
+
+    template<
+        typename _Type      /* Type of object */,
+        typename _Allocator /* Allocator of key */
+    > void EncodeKey( const _Type& obj, std::vector<unsigned char, _Allocator>& key )
+    {
+        EncodeKeyPrefix<reflection::GetFieldsCount<_Type>()>( obj, key );
+    }
+
+    template<
+        typename _Type /* Type of object */
+    > std::vector<unsigned char> EncodeKey( const _Type& obj )
+    {
+        std::vector<unsigned char> key;
+        EncodeKey( obj, key );
+
+        return key;
+    }
+
+    //
+    // Compares keys: returns negative number, zero or positive
+    // number, if the left key is less than, equal to or greater
+    // than the right one. Key is less than its continuations.
+    //
+
+    inline int CompareKeys( const unsigned char* left, size_t leftSize, const unsigned char* right, size_t rightSize ) noexcept
+    {
+        size_t size = leftSize < rightSize ? leftSize : rightSize;
+        size_t offset = 0;
+
+        //
+        // Keys are compared by 8-byte words while it is possible
+        //
+        for (; offset + sizeof( uint64_t ) <= size; offset += sizeof( uint64_t ))
+        {
+            uint64_t leftWord = details::_LoadBigEndian( left + offset );
+            uint64_t rightWord = details::_LoadBigEndian( right + offset );
+
+            if (leftWord != rightWord) {
+                return leftWord < rightWord ? -1 : 1;
+            }
+        }
+
+        if (int result = offset < size ? std::memcmp( left + offset, right + offset, size - offset ) : 0) {
+            return result;
+        }
+
+        return leftSize < rightSize ? -1 : ( rightSize < leftSize ? 1 : 0 );
+    }
+
+    template<typename _Allocator>
+    int CompareKeys( const std::vector<unsigned char, _Allocator>& left, const std::vector<unsigned char, _Allocator>& right ) noexcept
+    {
+        return CompareKeys( left.data(), left.size(), right.data(), right.size() );
+    }
+
+    //
+    // The first 8 bytes of key as integer (shorter keys are
+    // padded with zeros). If prefixes of keys are different,
+    // keys are ordered as their prefixes are, so most of
+    // comparisons take a single integer comparison.
+    //
+    inline uint64_t KeyPrefix( const unsigned char* key, size_t size ) noexcept
+    {
+        if (size >= sizeof( uint64_t )) {
+            return details::_LoadBigEndian( key );
+        }
+
+        uint64_t prefix = 0;
+
+        for (size_t i = 0; i < sizeof( prefix ); ++i) {
+            prefix = ( prefix << 8 ) | ( i < size ? key[i] : 0 );
+        }
+
+        return prefix;
+    }
+
+    template<typename _Allocator>
+    uint64_t KeyPrefix( const std::vector<unsigned char, _Allocator>& key ) noexcept
+    {
+        return KeyPrefix( key.data(), key.size() );
+    }
+
+} // serialization
\ No newline at end of file
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "SizeTArray.h"
+#include "GetTypeIds.h"
+#include "GetFieldsCount.h"
+
+
+/************************************************************************************
+ * Layout structure
+ *
+ * The key-concept is following:
+ *  - GetTypeIds writes id of each field at index equal to offset of this field
+ *    in raw array, so indices of non-zero ids are exactly offsets of fields.
+ *  - Each id can be converted back into a type, so we can find out size and
+ *    alignment of each field.
+ *  - All this information is calculated once in compile-time and stored in
+ *    static constexpr arrays, so no one needs to search for offsets at runtime.
+ *  - Packed offsets are offsets of fields in binary buffer, where fields are
+ *    written one after another without any padding.
+ *
+ ************************************************************************************/
+
+
+namespace reflection {
+namespace details {
+
+    /************************************************************************************/
+
+    //
+    // Returns offsets of all fields (including fields of nested structures).
+    //
+    template<
+        typename _Type /* Type to calculate offsets for */
+    > constexpr auto _GetOffsets_Impl() noexcept
+    {
+        using types::ArrayToIndices;
+        using types::SizeTArray;
+
+        constexpr auto idsRaw = _GetIdsRaw_Impl<_Type>(
+            std::make_index_sequence<GetFieldsCount<_Type>()>{}
+        );
+
+        SizeTArray<idsRaw.CountNonZeros()> offsets{ { 0 } };
+
+        const ArrayToIndices<idsRaw.Size()> transform{
+            const_cast<size_t*>( idsRaw.data ),
+            offsets.data
+        };
+        transform.Run();
+
+        return offsets;
+    }
+
+    //
+    // Returns sizes of types with specified ids.
+    //
+    template<
+        typename  _Type /* Type to calculate sizes for */,
+        size_t... _Idxs /* Indices of internal types (with expanded nested structures) */
+    > constexpr auto _GetSizes_Impl( std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        using types::SizeTArray;
+        using types::get;
+
+        constexpr auto ids = GetTypeIds<_Type>();
+
+        return SizeTArray<sizeof...( _Idxs )>{
+            { sizeof( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )... }
+        };
+    }
+
+    //
+    // Returns alignments of types with specified ids.
+    //
+    template<
+        typename  _Type /* Type to calculate alignments for */,
+        size_t... _Idxs /* Indices of internal types (with expanded nested structures) */
+    > constexpr auto _GetAlignments_Impl( std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        using types::SizeTArray;
+        using types::get;
+
+        constexpr auto ids = GetTypeIds<_Type>();
+
+        return SizeTArray<sizeof...( _Idxs )>{
+            { alignof( decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) ) )... }
+        };
+    }
+
+    //
+    // Returns offsets of fields written one after another.
+    //
+    template<
+        size_t _Size /* Number of fields */
+    > constexpr auto _GetPackedOffsets_Impl( const types::SizeTArray<_Size>& sizes ) noexcept
+    {
+        types::SizeTArray<_Size> packedOffsets{ { 0 } };
+
+        for (size_t i = 1; i < _Size; ++i) {
+            packedOffsets.data[i] = packedOffsets.data[i - 1] + sizes.data[i - 1];
+        }
+
+        return packedOffsets;
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Compile-time description of structure layout.
+    // All arrays are indexed in the same order as
+    // GetTypeIds returns ids of fields in.
+    //
+    template<
+        typename _Type /* Type to describe */
+    > struct Layout
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        //
+        // Number of fields (including fields of nested structures)
+        //
+        static constexpr size_t count = GetTypeIds<_Type>().Size();
+
+        //
+        // Ids of types of fields
+        //
+        static constexpr types::SizeTArray<count> ids = GetTypeIds<_Type>();
+
+        //
+        // Actual offsets of fields inside of structure
+        //
+        static constexpr types::SizeTArray<count> offsets = details::_GetOffsets_Impl<_Type>();
+
+        //
+        // Sizes of fields
+        //
+        static constexpr types::SizeTArray<count> sizes =
+            details::_GetSizes_Impl<_Type>( std::make_index_sequence<count>{} );
+
+        //
+        // Alignments of fields
+        //
+        static constexpr types::SizeTArray<count> alignments =
+            details::_GetAlignments_Impl<_Type>( std::make_index_sequence<count>{} );
+
+        //
+        // Offsets of fields in binary buffer (without padding)
+        //
+        static constexpr types::SizeTArray<count> packedOffsets = details::_GetPackedOffsets_Impl( sizes );
+
+        //
+        // Size of structure without padding
+        //
+        static constexpr size_t packedSize = packedOffsets.data[count - 1] + sizes.data[count - 1];
+    };
+
+    //
+    // Definitions of static members. They are necessary
+    // in C++14, when the arrays are accessed at runtime.
+    //
+
+    template<typename _Type> constexpr size_t Layout<_Type>::count;
+    template<typename _Type> constexpr types::SizeTArray<Layout<_Type>::count> Layout<_Type>::ids;
+    template<typename _Type> constexpr types::SizeTArray<Layout<_Type>::count> Layout<_Type>::offsets;
+    template<typename _Type> constexpr types::SizeTArray<Layout<_Type>::count> Layout<_Type>::sizes;
+    template<typename _Type> constexpr types::SizeTArray<Layout<_Type>::count> Layout<_Type>::alignments;
+    template<typename _Type> constexpr types::SizeTArray<Layout<_Type>::count> Layout<_Type>::packedOffsets;
+    template<typename _Type> constexpr size_t Layout<_Type>::packedSize;
+
+} // reflection
\ No newline at end of file
@@ -0,0 +1,858 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+#include "Buffers.h"
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif // defined(_WIN32)
+
+
+/************************************************************************************
+ * Memory-mapped record files
+ *
+ * The key-concept is following:
+ *  - File contains records one after another in the same format as
+ *    BinaryBatchBuffer stores them, without any header. So the file is
+ *    the same, as if Data() of batch buffer were written into it.
+ *  - Whole file is mapped into memory. Records are written into mapping
+ *    and decoded right from it, there are no read/write calls and no
+ *    intermediate copies. View() gives BinaryBufferView over mapping,
+ *    so it can be scanned (see Scan.h) in place as well.
+ *  - File grows geometrically: it is extended (ftruncate/SetEndOfFile)
+ *    and remapped, when there is no room for new records. On flush and
+ *    on close it is truncated to the exact size of stored records, so
+ *    flushed file is valid even if it is never closed (e.g. on crash).
+ *  - Written records are flushed (msync/FlushViewOfFile) by batches:
+ *    writeback of each batch of records is started without waiting,
+ *    Flush waits until all records and size of file are on disk.
+ *  - Sequential scans tell the kernel about access pattern (madvise),
+ *    so pages are read ahead.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+
+    //
+    // Modes of opening files
+    //
+    enum mapped_file_mode
+    {
+        mapped_read_only,  /* Existing file, records can not be appended */
+        mapped_read_write, /* File is created, if it doesn't exist */
+        mapped_truncate    /* File is created or truncated */
+    };
+
+namespace details {
+
+    //
+    // File is extended at least by this number of bytes
+    //
+    static constexpr uint64_t _MappedGrowSize = 1 << 16;
+
+    //
+    // Default number of records in one flushed batch
+    //
+    static constexpr size_t _DefaultSyncCount = 1 << 12;
+
+    /************************************************************************************/
+
+    //
+    // Mapping of whole file into memory. Size of mapping is
+    // always equal to size of file, empty files are not mapped.
+    //
+
+    class _FileMapping
+    {
+    public:
+        _FileMapping( const char* path, mapped_file_mode mode )
+            : m_readOnly( mode == mapped_read_only )
+            , m_data( nullptr )
+            , m_size( 0 )
+#if defined(_WIN32)
+            , m_file( INVALID_HANDLE_VALUE )
+            , m_mapping( nullptr )
+#else
+            , m_file( -1 )
+#endif // defined(_WIN32)
+        {
+            _Open( path, mode );
+
+            try {
+                _Map( _GetFileSize() );
+            }
+            catch (...)
+            {
+                _CloseFile();
+                throw;
+            }
+        }
+
+        _FileMapping( const _FileMapping& ) = delete;
+        _FileMapping& operator=( const _FileMapping& ) = delete;
+
+        _FileMapping( _FileMapping&& other ) noexcept
+            : m_readOnly( other.m_readOnly )
+            , m_data( other.m_data )
+            , m_size( other.m_size )
+            , m_file( other.m_file )
+#if defined(_WIN32)
+            , m_mapping( other.m_mapping )
+#endif // defined(_WIN32)
+        {
+            other.m_data = nullptr;
+            other.m_size = 0;
+#if defined(_WIN32)
+            other.m_file = INVALID_HANDLE_VALUE;
+            other.m_mapping = nullptr;
+#else
+            other.m_file = -1;
+#endif // defined(_WIN32)
+        }
+
+        ~_FileMapping()
+        {
+            _Unmap();
+            _CloseFile();
+        }
+
+        bool IsOpen() const noexcept
+        {
+#if defined(_WIN32)
+            return m_file != INVALID_HANDLE_VALUE;
+#else
+            return m_file != -1;
+#endif // defined(_WIN32)
+        }
+
+        bool IsReadOnly() const noexcept
+        {
+            return m_readOnly;
+        }
+
+        unsigned char* Data() const noexcept
+        {
+            return m_data;
+        }
+
+        uint64_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        //
+        // Changes size of file and maps it again.
+        // Pointers to previous mapping become invalid.
+        // If file can not be resized or mapped, it keeps
+        // previous size and stays mapped.
+        //
+        void Resize( uint64_t size )
+        {
+            if (size == m_size) {
+                return;
+            }
+
+            uint64_t previous = m_size;
+
+#if defined(_WIN32)
+            //
+            // File with mapped views can not be truncated,
+            // so they are unmapped and restored on failure
+            //
+            if (size < previous)
+            {
+                _Unmap();
+
+                try
+                {
+                    _SetFileSize( size );
+                    _Map( size );
+                }
+                catch (...)
+                {
+                    _SetFileSize( previous );
+                    _Map( previous );
+                    throw;
+                }
+
+                return;
+            }
+#endif // defined(_WIN32)
+
+            //
+            // New mapping is created before previous one
+            // is removed, so data is accessible all the time
+            //
+            unsigned char* data = m_data;
+#if defined(_WIN32)
+            HANDLE mapping = m_mapping;
+            m_mapping = nullptr;
+#endif // defined(_WIN32)
+
+            m_data = nullptr;
+            m_size = 0;
+
+            try
+            {
+                if (size > previous) {
+                    _SetFileSize( size );
+                }
+
+                _Map( size );
+
+                if (size < previous) {
+                    _SetFileSize( size );
+                }
+            }
+            catch (...)
+            {
+                _Unmap();
+
+                //
+                // Size is restored, so file still matches previous mapping
+                //
+                try {
+                    _SetFileSize( previous );
+                }
+                catch (...) { }
+
+                m_data = data;
+                m_size = previous;
+#if defined(_WIN32)
+                m_mapping = mapping;
+#endif // defined(_WIN32)
+
+                throw;
+            }
+
+#if defined(_WIN32)
+            _UnmapView( data, previous, mapping );
+#else
+            _UnmapView( data, previous );
+#endif // defined(_WIN32)
+        }
+
+        //
+        // Waits until size of file (and all written data) is on disk
+        //
+        void SyncFile()
+        {
+#if defined(_WIN32)
+            bool synced = FlushFileBuffers( m_file ) != 0;
+#elif defined(__APPLE__)
+            bool synced = fsync( m_file ) == 0;
+#else
+            bool synced = fdatasync( m_file ) == 0;
+#endif // defined(_WIN32)
+
+            if (!synced) {
+                throw std::runtime_error( "Unable to flush file" );
+            }
+        }
+
+        //
+        // Writes modified pages in range [offset, offset + size)
+        // to disk. If 'wait' is false, writeback is only started.
+        //
+        void Sync( uint64_t offset, uint64_t size, bool wait )
+        {
+            if (!size) {
+                return;
+            }
+
+#if defined(_WIN32)
+            bool synced = FlushViewOfFile( m_data + offset, static_cast<SIZE_T>( size ) ) &&
+                          ( !wait || FlushFileBuffers( m_file ) );
+#else
+            //
+            // Address passed to msync must be aligned to page
+            //
+            auto pageSize = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+            auto aligned = offset - offset % pageSize;
+
+            bool synced = msync( m_data + aligned, static_cast<size_t>( offset + size - aligned ), wait ? MS_SYNC : MS_ASYNC ) == 0;
+#endif // defined(_WIN32)
+
+            if (!synced) {
+                throw std::runtime_error( "Unable to flush file" );
+            }
+        }
+
+        //
+        // Hints that mapping will be read sequentially. Hints
+        // are not mandatory, so their errors are ignored.
+        //
+        void AdviseSequential() const noexcept
+        {
+            if (!m_data) {
+                return;
+            }
+
+#if defined(_WIN32)
+#   if _WIN32_WINNT >= 0x0602 /* _WIN32_WINNT_WIN8 */
+            WIN32_MEMORY_RANGE_ENTRY range{ m_data, static_cast<SIZE_T>( m_size ) };
+            PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+#   endif // _WIN32_WINNT >= 0x0602
+#else
+            madvise( m_data, static_cast<size_t>( m_size ), MADV_SEQUENTIAL );
+            madvise( m_data, static_cast<size_t>( m_size ), MADV_WILLNEED );
+#endif // defined(_WIN32)
+        }
+
+        //
+        // Truncates file to 'size' bytes and closes it
+        //
+        void Close( uint64_t size )
+        {
+            _Unmap();
+
+            if (!IsOpen()) {
+                return;
+            }
+
+            try
+            {
+                if (!m_readOnly) {
+                    _SetFileSize( size );
+                }
+            }
+            catch (...)
+            {
+                _CloseFile();
+                throw;
+            }
+
+            _CloseFile();
+        }
+
+    private:
+        void _Open( const char* path, mapped_file_mode mode )
+        {
+#if defined(_WIN32)
+            DWORD access = m_readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+            DWORD disposition = mode == mapped_read_only  ? OPEN_EXISTING :
+                                mode == mapped_read_write ? OPEN_ALWAYS : CREATE_ALWAYS;
+
+            //
+            // Read-only files may be read, while they are written
+            // by someone else (e.g. logs, see WriteAheadLog.h)
+            //
+            DWORD share = m_readOnly ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ;
+
+            m_file = CreateFileA( path, access, share, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr );
+#else
+            int flags = mode == mapped_read_only  ? O_RDONLY :
+                        mode == mapped_read_write ? O_RDWR | O_CREAT : O_RDWR | O_CREAT | O_TRUNC;
+
+            m_file = open( path, flags, 0644 );
+#endif // defined(_WIN32)
+
+            if (!IsOpen()) {
+                throw std::runtime_error( "Unable to open file" );
+            }
+        }
+
+        void _CloseFile() noexcept
+        {
+            if (!IsOpen()) {
+                return;
+            }
+
+#if defined(_WIN32)
+            CloseHandle( m_file );
+            m_file = INVALID_HANDLE_VALUE;
+#else
+            close( m_file );
+            m_file = -1;
+#endif // defined(_WIN32)
+        }
+
+        uint64_t _GetFileSize() const
+        {
+#if defined(_WIN32)
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx( m_file, &size )) {
+                throw std::runtime_error( "Unable to get size of file" );
+            }
+
+            return static_cast<uint64_t>( size.QuadPart );
+#else
+            struct stat status;
+            if (fstat( m_file, &status ) != 0) {
+                throw std::runtime_error( "Unable to get size of file" );
+            }
+
+            return static_cast<uint64_t>( status.st_size );
+#endif // defined(_WIN32)
+        }
+
+        void _SetFileSize( uint64_t size )
+        {
+#if defined(_WIN32)
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>( size );
+
+            bool resized = SetFilePointerEx( m_file, offset, nullptr, FILE_BEGIN ) && SetEndOfFile( m_file );
+#else
+            bool resized = ftruncate( m_file, static_cast<off_t>( size ) ) == 0;
+#endif // defined(_WIN32)
+
+            if (!resized) {
+                throw std::runtime_error( "Unable to resize file" );
+            }
+        }
+
+        void _Map( uint64_t size )
+        {
+            //
+            // Empty mapping is not allowed
+            //
+            if (!size) {
+                return;
+            }
+
+            if (size > static_cast<uint64_t>( SIZE_MAX )) {
+                throw std::runtime_error( "File is too large to be mapped" );
+            }
+
+#if defined(_WIN32)
+            DWORD protection = m_readOnly ? PAGE_READONLY : PAGE_READWRITE;
+            DWORD access = m_readOnly ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE;
+
+            m_mapping = CreateFileMappingA( m_file, nullptr, protection, 0, 0, nullptr );
+            if (!m_mapping) {
+                throw std::runtime_error( "Unable to map file" );
+            }
+
+            auto data = MapViewOfFile( m_mapping, access, 0, 0, static_cast<SIZE_T>( size ) );
+            if (!data)
+            {
+                CloseHandle( m_mapping );
+                m_mapping = nullptr;
+
+                throw std::runtime_error( "Unable to map file" );
+            }
+#else
+            int protection = m_readOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+
+            auto data = mmap( nullptr, static_cast<size_t>( size ), protection, MAP_SHARED, m_file, 0 );
+            if (data == MAP_FAILED) {
+                throw std::runtime_error( "Unable to map file" );
+            }
+#endif // defined(_WIN32)
+
+            m_data = static_cast<unsigned char*>( data );
+            m_size = size;
+        }
+
+        void _Unmap() noexcept
+        {
+#if defined(_WIN32)
+            _UnmapView( m_data, m_size, m_mapping );
+            m_mapping = nullptr;
+#else
+            _UnmapView( m_data, m_size );
+#endif // defined(_WIN32)
+
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+#if defined(_WIN32)
+        static void _UnmapView( unsigned char* data, uint64_t /* size */, HANDLE mapping ) noexcept
+        {
+            if (!data) {
+                return;
+            }
+
+            UnmapViewOfFile( data );
+            CloseHandle( mapping );
+        }
+#else
+        static void _UnmapView( unsigned char* data, uint64_t size ) noexcept
+        {
+            if (!data) {
+                return;
+            }
+
+            munmap( data, static_cast<size_t>( size ) );
+        }
+#endif // defined(_WIN32)
+
+    private:
+
+        //
+        // Is file opened for reading only?
+        //
+        bool m_readOnly;
+
+        //
+        // Mapped memory (null for empty file)
+        //
+        unsigned char* m_data;
+
+        //
+        // Size of mapped memory (and file) in bytes
+        //
+        uint64_t m_size;
+
+#if defined(_WIN32)
+        HANDLE m_file;
+        HANDLE m_mapping;
+#else
+        int m_file;
+#endif // defined(_WIN32)
+    };
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // File of records, that is accessed through memory mapping.
+    // Records can be appended, loaded by index and scanned
+    // sequentially. Pointers and views got from file become
+    // invalid, when file grows.
+    //
+
+    template<
+        typename _Type /* Type of records */
+    > class MappedRecordFile
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        using value_t = _Type;
+
+    public:
+        MappedRecordFile( const char* path, mapped_file_mode mode = mapped_read_write, size_t syncCount = details::_DefaultSyncCount )
+            : m_mapping( path, mode )
+            , m_count( 0 )
+            , m_synced( 0 )
+            , m_flushed( 0 )
+            , m_syncCount( syncCount ? syncCount : 1 )
+        {
+            //
+            // File is truncated on flush and on close, so its
+            // size is always a multiple of size of record
+            //
+            if (m_mapping.Size() % RecordSize() != 0) {
+                throw std::runtime_error( "Invalid size of file" );
+            }
+
+            m_count = static_cast<size_t>( m_mapping.Size() / RecordSize() );
+            m_synced = m_count;
+            m_flushed = m_count;
+        }
+
+        MappedRecordFile( const MappedRecordFile<_Type>& ) = delete;
+        MappedRecordFile& operator=( const MappedRecordFile<_Type>& ) = delete;
+
+        MappedRecordFile( MappedRecordFile<_Type>&& ) = default;
+
+        ~MappedRecordFile()
+        {
+            //
+            // Errors can not be reported from destructor,
+            // call Close explicitly to get them.
+            //
+            try {
+                Close();
+            }
+            catch (...) { }
+        }
+
+        //
+        // Size of one serialized record in bytes
+        //
+        static constexpr size_t RecordSize() noexcept
+        {
+            return reflection::Layout<value_t>::packedSize;
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return m_count == 0;
+        }
+
+        //
+        // Number of stored records
+        //
+        size_t Count() const noexcept
+        {
+            return m_count;
+        }
+
+        //
+        // Appends record to the end of file
+        //
+        void Append( const value_t& obj )
+        {
+            details::SaveBinary( obj, _Grow( 1 ) );
+            _SyncBatches();
+        }
+
+        //
+        // Appends all records from range [first, last)
+        //
+        template<
+            typename _InputIt /* Input iterator type */
+        > void AppendRange( _InputIt first, _InputIt last )
+        {
+            using category_t = typename std::iterator_traits<_InputIt>::iterator_category;
+
+            _AppendRange_Impl( first, last, category_t{} );
+            _SyncBatches();
+        }
+
+        //
+        // Loads record with specified index
+        //
+        void Load( value_t& obj, size_t index ) const
+        {
+            if (index >= m_count) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            details::LoadBinary( obj, m_mapping.Data() + index * RecordSize() );
+        }
+
+        //
+        // Calls 'func' with each record in order.
+        // Records are decoded right from mapping.
+        //
+        template<typename _Func>
+        void ForEach( _Func func ) const
+        {
+            m_mapping.AdviseSequential();
+
+            auto src = m_mapping.Data();
+            for (size_t i = 0; i < m_count; ++i, src += RecordSize())
+            {
+                value_t obj;
+                details::LoadBinary( obj, src );
+
+                func( obj );
+            }
+        }
+
+        //
+        // Loads all records into a vector.
+        // Previous content of vector is replaced.
+        //
+        template<
+            typename _Allocator /* Allocator of vector */
+        > void LoadRange( std::vector<value_t, _Allocator>& objs ) const
+        {
+            m_mapping.AdviseSequential();
+
+            objs.resize( m_count );
+
+            auto src = m_mapping.Data();
+            for (auto& obj : objs)
+            {
+                details::LoadBinary( obj, src );
+                src += RecordSize();
+            }
+        }
+
+        //
+        // View of all records in mapping
+        //
+        BinaryBufferView<value_t> View() const
+        {
+            return BinaryBufferView<value_t>( m_mapping.Data(), m_count * RecordSize() );
+        }
+
+        //
+        // Waits until all appended records are written to disk.
+        // File is truncated to the exact size of records, so
+        // pointers and views got from file become invalid.
+        //
+        void Flush()
+        {
+            if (m_flushed == m_count && m_mapping.Size() == static_cast<uint64_t>( m_count ) * RecordSize()) {
+                return;
+            }
+
+            uint64_t offset = static_cast<uint64_t>( m_flushed ) * RecordSize();
+            uint64_t size = static_cast<uint64_t>( m_count - m_flushed ) * RecordSize();
+
+            m_mapping.Sync( offset, size, true );
+
+            //
+            // Grown file contains free room after records, that
+            // would be read as records after crash. So file is
+            // truncated and its size is written to disk too.
+            //
+            m_mapping.Resize( static_cast<uint64_t>( m_count ) * RecordSize() );
+            m_mapping.SyncFile();
+
+            m_synced = m_count;
+            m_flushed = m_count;
+        }
+
+        //
+        // Flushes records, truncates file to their size
+        // and closes it. File can not be used after that.
+        //
+        void Close()
+        {
+            if (!m_mapping.IsOpen()) {
+                return;
+            }
+
+            if (!m_mapping.IsReadOnly()) {
+                Flush();
+            }
+
+            m_mapping.Close( static_cast<uint64_t>( m_count ) * RecordSize() );
+
+            m_count = 0;
+            m_synced = 0;
+            m_flushed = 0;
+        }
+
+    private:
+
+        //
+        // Forward iterators: number of records is known,
+        // so file is extended once before writing.
+        //
+        template<typename _ForwardIt>
+        void _AppendRange_Impl( _ForwardIt first, _ForwardIt last, std::forward_iterator_tag )
+        {
+            auto count = static_cast<size_t>( std::distance( first, last ) );
+            auto dst = _Grow( count );
+            auto written = m_count - count;
+
+            try
+            {
+                for (; first != last; ++first, ++written)
+                {
+                    details::SaveBinary( *first, dst );
+                    dst += RecordSize();
+                }
+            }
+            catch (...)
+            {
+                //
+                // Records, that were not written, are dropped
+                //
+                m_count = written;
+                throw;
+            }
+        }
+
+        template<typename _InputIt>
+        void _AppendRange_Impl( _InputIt first, _InputIt last, std::input_iterator_tag )
+        {
+            for (; first != last; ++first)
+            {
+                //
+                // Record is read before room is made for it,
+                // so exception from iterator does not leave
+                // unwritten record in file
+                //
+                const auto& obj = *first;
+                details::SaveBinary( obj, _Grow( 1 ) );
+            }
+        }
+
+        //
+        // Makes room for 'count' records and returns
+        // pointer to the first of them. Capacity of
+        // file is at least doubled each time.
+        //
+        unsigned char* _Grow( size_t count )
+        {
+            if (m_mapping.IsReadOnly()) {
+                throw std::logic_error( "File is opened for reading only" );
+            }
+
+            if (!m_mapping.IsOpen()) {
+                throw std::logic_error( "File is closed" );
+            }
+
+            uint64_t offset = static_cast<uint64_t>( m_count ) * RecordSize();
+            uint64_t required = offset + static_cast<uint64_t>( count ) * RecordSize();
+
+            if (required > m_mapping.Size())
+            {
+                uint64_t capacity = m_mapping.Size() * 2;
+
+                if (capacity < m_mapping.Size() + details::_MappedGrowSize) {
+                    capacity = m_mapping.Size() + details::_MappedGrowSize;
+                }
+
+                if (capacity < required) {
+                    capacity = required;
+                }
+
+                m_mapping.Resize( capacity );
+            }
+
+            m_count += count;
+
+            return m_mapping.Data() + offset;
+        }
+
+        //
+        // Starts writeback of each full batch of records
+        //
+        void _SyncBatches()
+        {
+            if (m_count - m_synced < m_syncCount) {
+                return;
+            }
+
+            uint64_t offset = static_cast<uint64_t>( m_synced ) * RecordSize();
+            uint64_t size = static_cast<uint64_t>( m_count - m_synced ) * RecordSize();
+
+            m_mapping.Sync( offset, size, false );
+            m_synced = m_count;
+        }
+
+    private:
+
+        //
+        // Mapping of file
+        //
+        details::_FileMapping m_mapping;
+
+        //
+        // Number of stored records
+        //
+        size_t m_count;
+
+        //
+        // Number of records, which writeback is started
+        //
+        size_t m_synced;
+
+        //
+        // Number of records, that are surely on disk
+        //
+        size_t m_flushed;
+
+        //
+        // Number of records in one flushed batch
+        //
+        size_t m_syncCount;
+    };
+
+} // serialization
\ No newline at end of file
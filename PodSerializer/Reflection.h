@@ -8,7 +8,9 @@
 // Library includes
 #include "GetFieldsCount.h"
 #include "GetTypeIds.h"
+#include "Layout.h"
 #include "ToTuple.h"
 #include "FromTuple.h"
 #include "GetTypeList.h"
 #include "ToTuplePrecise.h"
+#include "IsPaddingFree.h"
@@ -0,0 +1,553 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+#include "Buffers.h"
+
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif // defined(_MSC_VER)
+
+
+/************************************************************************************
+ * Scans over serialized binary batches
+ *
+ * The key-concept is following:
+ *  - Each predicate refers to a field by its index in Layout, i.e. fields
+ *    of nested structures are expanded and enumerations are represented
+ *    by their underlying types. Offset of field in serialized record is
+ *    a compile-time constant (Layout<_Type>::packedOffsets), so only bytes
+ *    of this field are read from each record and nothing is deserialized.
+ *  - The first predicate is evaluated for each record and its results are
+ *    packed into a bitmap by 64 records. Other predicates are evaluated
+ *    only for records, that are still selected, so cost of the scan drops
+ *    with its selectivity.
+ *  - Only selected records are loaded afterwards with the same routine as
+ *    buffers use.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+namespace details {
+
+    //
+    // Type of field with specified index in Layout
+    //
+    template<
+        typename _Type /* Type of records */,
+        size_t   _Idx  /* Index of field */
+    > using _LayoutField_t = decltype(
+        reflection::details::_GetTypeById( reflection::details::SizeT<reflection::Layout<_Type>::ids.data[_Idx]>{} )
+    );
+
+    //
+    // Number of records in one word of bitmap
+    //
+    static constexpr size_t _WordBits = 64;
+
+    inline size_t _CountBits( uint64_t word ) noexcept
+    {
+        return std::bitset<_WordBits>( word ).count();
+    }
+
+    inline size_t _LowestBit( uint64_t word ) noexcept
+    {
+#if defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_ARM64) )
+        unsigned long index = 0;
+        _BitScanForward64( &index, word );
+
+        return static_cast<size_t>( index );
+#elif defined(_MSC_VER)
+        //
+        // 32-bit targets: halves of word are scanned separately
+        //
+        unsigned long index = 0;
+
+        if (_BitScanForward( &index, static_cast<unsigned long>( word ) )) {
+            return static_cast<size_t>( index );
+        }
+
+        _BitScanForward( &index, static_cast<unsigned long>( word >> 32 ) );
+
+        return static_cast<size_t>( index ) + 32;
+#else
+        return static_cast<size_t>( __builtin_ctzll( word ) );
+#endif // defined(_MSC_VER)
+    }
+
+    /************************************************************************************/
+
+    //
+    // Operands of predicates are not converted to type of
+    // field (it would truncate them, e.g. 2.5 to 2 for 'int'
+    // field). Enumerations are taken as their underlying types,
+    // as Layout does, other values are compared in their common
+    // type. Integers of different signedness are compared by
+    // value: negative one is less than any unsigned one.
+    //
+
+    template<typename _Value>
+    _Value _Operand( _Value value, std::false_type /* std::is_enum<_Value> */ ) noexcept
+    {
+        return value;
+    }
+
+    template<typename _Value>
+    typename std::underlying_type<_Value>::type _Operand( _Value value, std::true_type /* std::is_enum<_Value> */ ) noexcept
+    {
+        return static_cast<typename std::underlying_type<_Value>::type>( value );
+    }
+
+    template<typename _Value>
+    auto _Operand( _Value value ) noexcept
+    {
+        return _Operand( value, std::is_enum<_Value>{} );
+    }
+
+    template<
+        typename _Left  /* Type of left operand */,
+        typename _Right /* Type of right operand */
+    > using _IsMixedSign = std::integral_constant<bool,
+        std::is_integral<_Left>::value && !std::is_same<_Left, bool>::value &&
+        std::is_integral<_Right>::value && !std::is_same<_Right, bool>::value &&
+        std::is_signed<_Left>::value != std::is_signed<_Right>::value
+    >;
+
+    //
+    // Integers of different signedness
+    //
+
+    template<typename _Left, typename _Right>
+    bool _LessMixed( _Left left, _Right right, std::true_type /* std::is_signed<_Left> */ ) noexcept
+    {
+        return left < 0 || static_cast<typename std::make_unsigned<_Left>::type>( left ) < right;
+    }
+
+    template<typename _Left, typename _Right>
+    bool _LessMixed( _Left left, _Right right, std::false_type /* std::is_signed<_Left> */ ) noexcept
+    {
+        return right > 0 && left < static_cast<typename std::make_unsigned<_Right>::type>( right );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _EqualMixed( _Left left, _Right right, std::true_type /* std::is_signed<_Left> */ ) noexcept
+    {
+        return left >= 0 && static_cast<typename std::make_unsigned<_Left>::type>( left ) == right;
+    }
+
+    template<typename _Left, typename _Right>
+    bool _EqualMixed( _Left left, _Right right, std::false_type /* std::is_signed<_Left> */ ) noexcept
+    {
+        return right >= 0 && left == static_cast<typename std::make_unsigned<_Right>::type>( right );
+    }
+
+    //
+    // Dispatch between common type and mixed signedness
+    //
+
+    template<typename _Left, typename _Right>
+    bool _Less( _Left left, _Right right, std::false_type /* _IsMixedSign */ ) noexcept
+    {
+        using common_t = typename std::common_type<_Left, _Right>::type;
+        return static_cast<common_t>( left ) < static_cast<common_t>( right );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _Less( _Left left, _Right right, std::true_type /* _IsMixedSign */ ) noexcept
+    {
+        return _LessMixed( left, right, std::is_signed<_Left>{} );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _Equal( _Left left, _Right right, std::false_type /* _IsMixedSign */ ) noexcept
+    {
+        using common_t = typename std::common_type<_Left, _Right>::type;
+        return static_cast<common_t>( left ) == static_cast<common_t>( right );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _Equal( _Left left, _Right right, std::true_type /* _IsMixedSign */ ) noexcept
+    {
+        return _EqualMixed( left, right, std::is_signed<_Left>{} );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _Less( _Left left, _Right right ) noexcept
+    {
+        return _Less( left, right, _IsMixedSign<_Left, _Right>{} );
+    }
+
+    template<typename _Left, typename _Right>
+    bool _Equal( _Left left, _Right right ) noexcept
+    {
+        return _Equal( left, right, _IsMixedSign<_Left, _Right>{} );
+    }
+
+    /************************************************************************************/
+
+    //
+    // Operations of predicates
+    //
+
+    struct _EqualOp
+    {
+        template<typename _Field, typename _Value>
+        static bool Test( _Field value, _Value first, _Value /* second */ ) noexcept
+        {
+            return _Equal( value, first );
+        }
+    };
+
+    struct _LessOp
+    {
+        template<typename _Field, typename _Value>
+        static bool Test( _Field value, _Value first, _Value /* second */ ) noexcept
+        {
+            return _Less( value, first );
+        }
+    };
+
+    struct _RangeOp
+    {
+        template<typename _Field, typename _Value>
+        static bool Test( _Field value, _Value first, _Value second ) noexcept
+        {
+            return !_Less( value, first ) && !_Less( second, value );
+        }
+    };
+
+    struct _BitsOp
+    {
+        template<typename _Field, typename _Value>
+        static bool Test( _Field value, _Value first, _Value /* second */ ) noexcept
+        {
+            static_assert( std::is_integral<_Field>::value && std::is_integral<_Value>::value,
+                "Bitmask can be tested for integer fields only" );
+
+            using common_t = typename std::common_type<_Field, _Value>::type;
+
+            return ( static_cast<common_t>( value ) & static_cast<common_t>( first ) ) == static_cast<common_t>( first );
+        }
+    };
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Predicate over field with index _Idx in Layout.
+    // Use functions below to construct predicates.
+    //
+    template<
+        size_t   _Idx   /* Index of field */,
+        typename _Op    /* Operation */,
+        typename _Value /* Type of operands */
+    > struct FieldPredicate
+    {
+        static constexpr size_t index = _Idx;
+
+        _Value first;
+        _Value second;
+    };
+
+    //
+    // Field is equal to 'value'
+    //
+    template<size_t _Idx, typename _Value>
+    constexpr FieldPredicate<_Idx, details::_EqualOp, _Value> FieldEqual( _Value value ) noexcept
+    {
+        return { value, value };
+    }
+
+    //
+    // Field is less than 'value'
+    //
+    template<size_t _Idx, typename _Value>
+    constexpr FieldPredicate<_Idx, details::_LessOp, _Value> FieldLess( _Value value ) noexcept
+    {
+        return { value, value };
+    }
+
+    //
+    // Field is in range [low, high] (both bounds are included)
+    //
+    template<size_t _Idx, typename _Value>
+    constexpr FieldPredicate<_Idx, details::_RangeOp, _Value> FieldInRange( _Value low, _Value high ) noexcept
+    {
+        return { low, high };
+    }
+
+    //
+    // All bits of 'mask' are set in field
+    //
+    template<size_t _Idx, typename _Value>
+    constexpr FieldPredicate<_Idx, details::_BitsOp, _Value> FieldHasBits( _Value mask ) noexcept
+    {
+        return { mask, mask };
+    }
+
+    /************************************************************************************/
+
+    //
+    // Result of scan: bitmap with one bit per record
+    //
+
+    class Selection
+    {
+    public:
+        Selection() noexcept
+            : m_size( 0 )
+            , m_words()
+        { }
+
+        explicit Selection( size_t size )
+            : m_size( size )
+            , m_words( ( size + details::_WordBits - 1 ) / details::_WordBits, 0 )
+        { }
+
+        //
+        // Number of scanned records
+        //
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        //
+        // Number of selected records
+        //
+        size_t Count() const noexcept
+        {
+            size_t count = 0;
+
+            for (auto word : m_words) {
+                count += details::_CountBits( word );
+            }
+
+            return count;
+        }
+
+        bool IsSelected( size_t index ) const
+        {
+            if (index >= m_size) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            return ( m_words[index / details::_WordBits] >> ( index % details::_WordBits ) ) & 1;
+        }
+
+        //
+        // Calls 'func' with index of each selected record in order
+        //
+        template<typename _Func>
+        void ForEach( _Func func ) const
+        {
+            for (size_t i = 0; i < m_words.size(); ++i)
+            {
+                for (uint64_t word = m_words[i]; word; word &= word - 1) {
+                    func( i * details::_WordBits + details::_LowestBit( word ) );
+                }
+            }
+        }
+
+        //
+        // Indices of selected records in order
+        //
+        std::vector<size_t> Indices() const
+        {
+            std::vector<size_t> indices;
+            indices.reserve( Count() );
+
+            ForEach( [&indices]( size_t index ) { indices.push_back( index ); } );
+
+            return indices;
+        }
+
+        //
+        // Words of bitmap: record with index i is
+        // selected, if bit (i % 64) of word (i / 64)
+        // is set. Bits past Size() are zero.
+        //
+
+        uint64_t* Data() noexcept
+        {
+            return m_words.data();
+        }
+
+        const uint64_t* Data() const noexcept
+        {
+            return m_words.data();
+        }
+
+        size_t WordsCount() const noexcept
+        {
+            return m_words.size();
+        }
+
+    private:
+
+        //
+        // Number of scanned records
+        //
+        size_t m_size;
+
+        //
+        // Bitmap
+        //
+        std::vector<uint64_t> m_words;
+    };
+
+namespace details {
+
+    /************************************************************************************/
+
+    //
+    // Reads field with index _Idx from record
+    //
+    template<typename _Type, size_t _Idx>
+    _LayoutField_t<_Type, _Idx> _ReadField( const unsigned char* record ) noexcept
+    {
+        _LayoutField_t<_Type, _Idx> value;
+        std::memcpy( &value, record + reflection::Layout<_Type>::packedOffsets.data[_Idx], sizeof( value ) );
+
+        return value;
+    }
+
+    //
+    // Evaluates the first predicate for all records
+    //
+    template<typename _Type, size_t _Idx, typename _Op, typename _Value>
+    void _ScanAll( const unsigned char* data, const FieldPredicate<_Idx, _Op, _Value>& predicate, Selection& selection ) noexcept
+    {
+        constexpr size_t recordSize = reflection::Layout<_Type>::packedSize;
+
+        const auto first = _Operand( predicate.first );
+        const auto second = _Operand( predicate.second );
+
+        uint64_t* words = selection.Data();
+        size_t count = selection.Size();
+
+        for (size_t word = 0; word * _WordBits < count; ++word)
+        {
+            size_t bits = count - word * _WordBits < _WordBits ? count - word * _WordBits : _WordBits;
+            uint64_t result = 0;
+
+            for (size_t bit = 0; bit < bits; ++bit, data += recordSize) {
+                result |= static_cast<uint64_t>( _Op::Test( _ReadField<_Type, _Idx>( data ), first, second ) ) << bit;
+            }
+
+            words[word] = result;
+        }
+    }
+
+    //
+    // Evaluates next predicate for selected records only
+    //
+    template<typename _Type, size_t _Idx, typename _Op, typename _Value>
+    void _ScanSelected( const unsigned char* data, const FieldPredicate<_Idx, _Op, _Value>& predicate, Selection& selection ) noexcept
+    {
+        constexpr size_t recordSize = reflection::Layout<_Type>::packedSize;
+
+        const auto first = _Operand( predicate.first );
+        const auto second = _Operand( predicate.second );
+
+        uint64_t* words = selection.Data();
+
+        for (size_t word = 0; word < selection.WordsCount(); ++word)
+        {
+            for (uint64_t bits = words[word]; bits; bits &= bits - 1)
+            {
+                size_t bit = _LowestBit( bits );
+                auto record = data + ( word * _WordBits + bit ) * recordSize;
+
+                if (!_Op::Test( _ReadField<_Type, _Idx>( record ), first, second )) {
+                    words[word] &= ~( uint64_t( 1 ) << bit );
+                }
+            }
+        }
+    }
+
+    template<typename _Type, typename _Predicate>
+    void _CheckPredicate() noexcept
+    {
+        static_assert( _Predicate::index < reflection::Layout<_Type>::count, "Index of field is out of range" );
+    }
+
+} // details
+
+    /************************************************************************************/
+
+    //
+    // Selects records, that satisfy all predicates. Records
+    // are not deserialized: only fields used by predicates
+    // are read.
+    //
+
+    template<
+        typename    _Type       /* Type of records */,
+        typename    _Predicate  /* Type of the first predicate */,
+        typename... _Predicates /* Types of other predicates */
+    > Selection Scan( const BinaryBufferView<_Type>& view, const _Predicate& predicate, const _Predicates&... predicates )
+    {
+        using _Expander = int[];
+
+        (void)_Expander{ 0, ( details::_CheckPredicate<_Type, _Predicate>(), 0 ), ( details::_CheckPredicate<_Type, _Predicates>(), 0 )... };
+
+        Selection selection( view.Count() );
+
+        details::_ScanAll<_Type>( view.Data(), predicate, selection );
+        (void)_Expander{ 0, ( details::_ScanSelected<_Type>( view.Data(), predicates, selection ), 0 )... };
+
+        return selection;
+    }
+
+    template<
+        typename    _Type       /* Type of records */,
+        typename... _Predicates /* Types of predicates */
+    > Selection Scan( const BinaryBatchBuffer<_Type>& buffer, const _Predicates&... predicates )
+    {
+        return Scan( BinaryBufferView<_Type>( buffer ), predicates... );
+    }
+
+    //
+    // Loads selected records only. Previous content
+    // of vector is replaced.
+    //
+
+    template<
+        typename _Type      /* Type of records */,
+        typename _Allocator /* Allocator of vector */
+    > void LoadSelected( const BinaryBufferView<_Type>& view, const Selection& selection, std::vector<_Type, _Allocator>& objs )
+    {
+        if (selection.Size() != view.Count()) {
+            throw std::invalid_argument( "Selection doesn't match buffer" );
+        }
+
+        objs.resize( selection.Count() );
+
+        auto current = objs.begin();
+
+        selection.ForEach( [&view, &current]( size_t index ) {
+            details::LoadBinary( *current++, view.Data() + index * view.RecordSize() );
+        } );
+    }
+
+    template<
+        typename _Type      /* Type of records */,
+        typename _Allocator /* Allocator of vector */
+    > void LoadSelected( const BinaryBatchBuffer<_Type>& buffer, const Selection& selection, std::vector<_Type, _Allocator>& objs )
+    {
+        LoadSelected( BinaryBufferView<_Type>( buffer ), selection, objs );
+    }
+
+} // serialization
\ No newline at end of file
@@ -0,0 +1,410 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+#include "Buffers.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if !defined(_WIN32)
+#   include <cerrno>
+#   include <climits>
+#   include <sys/socket.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif // !defined(_WIN32)
+
+
+/************************************************************************************
+ * Scatter-gather output
+ *
+ * The key-concept is following:
+ *  - Sink collects segments (pointer and size), that refer to serialized
+ *    bytes of buffers. Nothing is copied: header, payload and trailer are
+ *    serialized into their own buffers and go out in one writev/sendmsg
+ *    call straight from these buffers. Buffers must outlive the sink.
+ *  - Objects can also be saved into sink itself: they are serialized into
+ *    blocks owned by sink. Contiguous segments are merged, so objects
+ *    saved one after another take a single segment.
+ *  - Segments are iovec structures on POSIX systems and have layout of
+ *    WSABUF on Windows, so they are passed to writev/sendmsg/WSASend
+ *    as is. Written bytes are consumed from the front of sink, so
+ *    partial writes are continued from the right place.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+
+    //
+    // Segment of output
+    //
+#if defined(_WIN32)
+    struct IoSegment
+    {
+        unsigned long len; /* The same layout as WSABUF */
+        char*         buf;
+    };
+#else
+    using IoSegment = iovec;
+#endif // defined(_WIN32)
+
+namespace details {
+
+    //
+    // Size of blocks for objects saved into sink
+    //
+    static constexpr size_t _SinkBlockSize = 1 << 12;
+
+    inline IoSegment _MakeSegment( const unsigned char* data, size_t size ) noexcept
+    {
+        IoSegment segment;
+
+#if defined(_WIN32)
+        segment.buf = reinterpret_cast<char*>( const_cast<unsigned char*>( data ) );
+        segment.len = static_cast<unsigned long>( size );
+#else
+        segment.iov_base = const_cast<unsigned char*>( data );
+        segment.iov_len = size;
+#endif // defined(_WIN32)
+
+        return segment;
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Fields of segment (their names differ between platforms)
+    //
+
+    inline const unsigned char* SegmentData( const IoSegment& segment ) noexcept
+    {
+#if defined(_WIN32)
+        return reinterpret_cast<const unsigned char*>( segment.buf );
+#else
+        return static_cast<const unsigned char*>( segment.iov_base );
+#endif // defined(_WIN32)
+    }
+
+    inline size_t SegmentSize( const IoSegment& segment ) noexcept
+    {
+#if defined(_WIN32)
+        return segment.len;
+#else
+        return segment.iov_len;
+#endif // defined(_WIN32)
+    }
+
+    /************************************************************************************/
+
+    //
+    // Sink of serialized bytes, that are written
+    // with a single scatter-gather call
+    //
+
+    class ScatterGatherSink
+    {
+        using block_t = std::unique_ptr<unsigned char[]>;
+
+    public:
+        ScatterGatherSink()
+            : m_segments()
+            , m_first( 0 )
+            , m_size( 0 )
+            , m_blocks()
+            , m_blockUsed( 0 )
+            , m_blockSize( 0 )
+        { }
+
+        ScatterGatherSink( const ScatterGatherSink& ) = delete;
+        ScatterGatherSink& operator=( const ScatterGatherSink& ) = delete;
+
+        ScatterGatherSink( ScatterGatherSink&& ) = default;
+        ScatterGatherSink& operator=( ScatterGatherSink&& ) = default;
+
+        bool IsEmpty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        //
+        // Number of bytes to be written
+        //
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        //
+        // Segments to be written
+        //
+
+        const IoSegment* Segments() const noexcept
+        {
+            return m_segments.data() + m_first;
+        }
+
+        size_t SegmentsCount() const noexcept
+        {
+            return m_segments.size() - m_first;
+        }
+
+        //
+        // Adds segment, that refers to external memory.
+        // Memory is not copied and must outlive sink.
+        //
+        void Add( const unsigned char* data, size_t size )
+        {
+            if (!size) {
+                return;
+            }
+
+            //
+            // Segments, that continue each other, are merged
+            //
+            if (SegmentsCount())
+            {
+                auto& last = m_segments.back();
+
+                if (SegmentData( last ) + SegmentSize( last ) == data)
+                {
+                    last = details::_MakeSegment( SegmentData( last ), SegmentSize( last ) + size );
+                    m_size += size;
+
+                    return;
+                }
+            }
+
+            m_segments.push_back( details::_MakeSegment( data, size ) );
+            m_size += size;
+        }
+
+        //
+        // Adds serialized bytes of buffer
+        //
+
+        template<typename _Type, typename _Storage>
+        void Add( const BasicBinaryBuffer<_Type, _Storage>& buffer )
+        {
+            if (buffer.IsEmpty()) {
+                throw std::logic_error( "Buffer is empty" );
+            }
+
+            Add( buffer.Data(), buffer.Size() );
+        }
+
+        template<typename _Type>
+        void Add( const BinaryBatchBuffer<_Type>& buffer )
+        {
+            Add( buffer.Data(), buffer.Size() );
+        }
+
+        template<typename _Type>
+        void Add( const BinaryBufferView<_Type>& view )
+        {
+            Add( view.Data(), view.Size() );
+        }
+
+        //
+        // Serializes object into memory owned by sink
+        //
+        template<typename _Type>
+        void Save( const _Type& obj )
+        {
+            REFLECTION_CHECK_TYPE( _Type );
+
+            constexpr size_t size = reflection::Layout<_Type>::packedSize;
+
+            auto dst = _Allocate( size );
+            details::SaveBinary( obj, dst );
+
+            Add( dst, size );
+        }
+
+        //
+        // Drops 'size' bytes from the front of sink
+        // (e.g. after they are written)
+        //
+        void Consume( size_t size )
+        {
+            if (size > m_size) {
+                throw std::out_of_range( "Too many bytes are consumed" );
+            }
+
+            m_size -= size;
+
+            while (size)
+            {
+                auto& first = m_segments[m_first];
+                auto firstSize = SegmentSize( first );
+
+                if (size < firstSize)
+                {
+                    first = details::_MakeSegment( SegmentData( first ) + size, firstSize - size );
+                    break;
+                }
+
+                size -= firstSize;
+                ++m_first;
+            }
+
+            if (!m_size) {
+                Clear();
+            }
+        }
+
+        //
+        // Drops all segments. Memory of saved objects is
+        // kept, so sink can be reused without allocations.
+        //
+        void Clear() noexcept
+        {
+            m_segments.clear();
+            m_first = 0;
+            m_size = 0;
+
+            //
+            // Only the last block is reused, because
+            // older ones are smaller or of the same size
+            //
+            if (m_blocks.size() > 1)
+            {
+                m_blocks.front() = std::move( m_blocks.back() );
+                m_blocks.resize( 1 );
+            }
+
+            m_blockUsed = 0;
+        }
+
+    private:
+
+        //
+        // Allocates 'size' bytes in the current block or in a new one
+        //
+        unsigned char* _Allocate( size_t size )
+        {
+            if (m_blocks.empty() || m_blockSize - m_blockUsed < size)
+            {
+                size_t blockSize = size > details::_SinkBlockSize ? size : details::_SinkBlockSize;
+
+                m_blocks.emplace_back( new unsigned char[blockSize] );
+                m_blockUsed = 0;
+                m_blockSize = blockSize;
+            }
+
+            auto data = m_blocks.back().get() + m_blockUsed;
+            m_blockUsed += size;
+
+            return data;
+        }
+
+    private:
+
+        //
+        // All segments (including consumed ones)
+        //
+        std::vector<IoSegment> m_segments;
+
+        //
+        // Index of the first segment, that is not consumed
+        //
+        size_t m_first;
+
+        //
+        // Number of bytes in segments, that are not consumed
+        //
+        size_t m_size;
+
+        //
+        // Blocks for saved objects
+        //
+        std::vector<block_t> m_blocks;
+
+        //
+        // Number of used bytes in the last block
+        //
+        size_t m_blockUsed;
+
+        //
+        // Size of the last block
+        //
+        size_t m_blockSize;
+    };
+
+#if !defined(_WIN32)
+
+namespace details {
+
+    //
+    // Calls 'write' until sink is empty or descriptor
+    // would block. Returns number of written bytes.
+    //
+    template<typename _Write>
+    size_t _WriteSegments( ScatterGatherSink& sink, _Write write )
+    {
+        size_t written = 0;
+
+        while (!sink.IsEmpty())
+        {
+            int count = sink.SegmentsCount() > IOV_MAX ? IOV_MAX : static_cast<int>( sink.SegmentsCount() );
+            ssize_t result = write( sink.Segments(), count );
+
+            if (result < 0)
+            {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+
+                throw std::runtime_error( "Unable to write segments" );
+            }
+
+            sink.Consume( static_cast<size_t>( result ) );
+            written += static_cast<size_t>( result );
+        }
+
+        return written;
+    }
+
+} // details
+
+    //
+    // Writes segments of sink with writev. Written bytes
+    // are consumed, for non-blocking descriptors the rest
+    // stays in sink. Returns number of written bytes.
+    //
+    inline size_t WriteSegments( int fd, ScatterGatherSink& sink )
+    {
+        return details::_WriteSegments( sink, [fd]( const IoSegment* segments, int count ) {
+            return writev( fd, segments, count );
+        } );
+    }
+
+    //
+    // The same for sockets with sendmsg
+    //
+    inline size_t SendSegments( int socket, ScatterGatherSink& sink, int flags = 0 )
+    {
+        return details::_WriteSegments( sink, [socket, flags]( const IoSegment* segments, int count ) {
+            msghdr message{};
+            message.msg_iov = const_cast<IoSegment*>( segments );
+            message.msg_iovlen = static_cast<decltype( message.msg_iovlen )>( count );
+
+            return sendmsg( socket, &message, flags );
+        } );
+    }
+
+#endif // !defined(_WIN32)
+
+} // serialization
\ No newline at end of file
@@ -8,3 +8,15 @@
 // Library includes
 #include "BasicSerializer.h"
 #include "Buffers.h"
+#include "Dispatch.h"
+#include "FrameStream.h"
+#include "KeyEncoding.h"
+#include "MappedRecordFile.h"
+#include "Scan.h"
+#include "ScatterGather.h"
+#include "Storage.h"
+#include "TextFile.h"
+#include "TextFileParallel.h"
+#include "TextReader.h"
+#include "TextWriter.h"
+#include "WriteAheadLog.h"
@@ -2,6 +2,8 @@
 
 #include "pch.h"
 
+#include "Config.h"
+
 namespace types {
 
     /************************************************************************************/
@@ -51,7 +53,7 @@ namespace types {
         size_t _Size /* Size of array */
     > constexpr size_t get( const SizeTArray<_Size>& array ) noexcept
     {
-        static_assert( _Idx < _Size, "Out of range in " __FUNCTION__ );
+        static_assert( _Idx < _Size, "Out of range in get" );
         return array.data[_Idx];
     }
 
@@ -71,12 +73,28 @@ namespace types {
         size_t* pSecond; // Pointer to second array
 
         //
-        // Recursive transformation
+        // Recursive transformation (C++14) or 
+        // loop (since C++17)
         // 
         constexpr void Run() const noexcept
         {
-#pragma warning(push)
-#pragma warning(disable: 4127) // conditional expression is constant
+#if ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 )
+            //
+            // Simply copy non-zero values in a loop. No template is 
+            // instantiated per element, so it is much cheaper for 
+            // compiler in case of big arrays.
+            // 
+            for (size_t i = _Idx1, j = _Idx2; i < _Size1; ++i)
+            {
+                if (pFirst[i]) {
+                    const_cast<size_t*>( pSecond )[j++] = pFirst[i];
+                }
+            }
+#else
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable: 4127) // conditional expression is constant
+#endif // defined(_MSC_VER)
             if (_Idx1 < _Size1)
             {
                 if (pFirst[_Idx1]) 
@@ -101,7 +119,10 @@ namespace types {
                     next.Run();
                 }
             }
-#pragma warning(pop)
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif // defined(_MSC_VER)
+#endif // ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 )
         }
     };
 
@@ -137,12 +158,28 @@ namespace types {
         size_t* pSecond; // Pointer to second array
 
         //
-        // Recursive transformation
+        // Recursive transformation (C++14) or 
+        // loop (since C++17)
         // 
         constexpr void Run() const noexcept
         {
-#pragma warning(push)
-#pragma warning(disable: 4127) // conditional expression is constant
+#if ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 )
+            //
+            // Simply copy indices of non-zero values in a loop. No template is 
+            // instantiated per element, so it is much cheaper for 
+            // compiler in case of big arrays.
+            // 
+            for (size_t i = _Idx1, j = _Idx2; i < _Size1; ++i)
+            {
+                if (pFirst[i]) {
+                    const_cast<size_t*>( pSecond )[j++] = i;
+                }
+            }
+#else
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable: 4127) // conditional expression is constant
+#endif // defined(_MSC_VER)
             if (_Idx1 < _Size1)
             {
                 if (pFirst[_Idx1])
@@ -167,7 +204,10 @@ namespace types {
                     next.Run();
                 }
             }
-#pragma warning(pop)
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif // defined(_MSC_VER)
+#endif // ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 )
         }
     };
 
@@ -0,0 +1,574 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Reflection.h"
+#include "TypeList.h"
+#include "Tuple.h"
+#include "Misc.h"
+#include "Transpose.h"
+
+#include <cstdint>
+#include <limits>
+
+
+/************************************************************************************
+ * Columnar (structure-of-arrays) container
+ *
+ * The key-concept is following:
+ *  - Types of fields are got with GetTypeList, and each field is stored
+ *    in its own column - a vector of values of this field. Nested
+ *    structures and not-POD fields (e.g. strings) are stored as is.
+ *  - Memory of columns is aligned by cache line, so scanning of one field
+ *    reads only values of this field and no cache line is shared between
+ *    columns.
+ *  - Object is split into columns on insertion and reassembled on request.
+ *    Row of container can be viewed as a tuple of references to its values
+ *    (the same as ToTuplePreciseView does for objects).
+ *  - Arrays of POD objects are transposed into columns and back by
+ *    kernels from Transpose.h.
+ *
+ ************************************************************************************/
+
+
+namespace columnar {
+
+    //
+    // Size of cache line, that columns are aligned by
+    //
+    static constexpr size_t CacheLineSize = 64;
+
+    /************************************************************************************/
+
+    //
+    // Standard-compatible allocator, that returns
+    // memory aligned by cache line. Values are default-
+    // initialized on resize, so columns of fundamental
+    // types are not filled with zeros before they are
+    // overwritten by transposition.
+    //
+
+    template<
+        typename _Type /* Type of allocated objects */
+    > class CacheAlignedAllocator
+    {
+    public:
+        using value_type = _Type;
+
+        CacheAlignedAllocator() noexcept = default;
+
+        template<typename _Other>
+        CacheAlignedAllocator( const CacheAlignedAllocator<_Other>& /* other */ ) noexcept
+        { }
+
+        _Type* allocate( size_t count )
+        {
+            //
+            // Block is allocated with an extra cache line: it
+            // is enough to align memory and store pointer to
+            // the beginning of block right before aligned memory.
+            //
+            constexpr size_t extra = CacheLineSize + sizeof( void* );
+
+            if (count > ( (std::numeric_limits<size_t>::max)() - extra ) / sizeof( _Type )) {
+                throw std::bad_alloc();
+            }
+
+            auto block = static_cast<unsigned char*>( ::operator new( count * sizeof( _Type ) + extra ) );
+
+            auto address = reinterpret_cast<std::uintptr_t>( block + sizeof( void* ) );
+            auto aligned = ( address + CacheLineSize - 1 ) & ~static_cast<std::uintptr_t>( CacheLineSize - 1 );
+
+            reinterpret_cast<void**>( aligned )[-1] = block;
+
+            return reinterpret_cast<_Type*>( aligned );
+        }
+
+        void deallocate( _Type* ptr, size_t /* count */ ) noexcept
+        {
+            ::operator delete( reinterpret_cast<void**>( ptr )[-1] );
+        }
+
+        template<typename _Other>
+        void construct( _Other* ptr ) noexcept( std::is_nothrow_default_constructible<_Other>::value )
+        {
+            ::new( static_cast<void*>( ptr ) ) _Other;
+        }
+
+        template<typename _Other, typename... _Args>
+        void construct( _Other* ptr, _Args&&... args )
+        {
+            ::new( static_cast<void*>( ptr ) ) _Other( std::forward<_Args>( args )... );
+        }
+
+        template<typename _Other>
+        bool operator==( const CacheAlignedAllocator<_Other>& /* other */ ) const noexcept
+        {
+            return true;
+        }
+
+        template<typename _Other>
+        bool operator!=( const CacheAlignedAllocator<_Other>& /* other */ ) const noexcept
+        {
+            return false;
+        }
+    };
+
+    /************************************************************************************/
+
+    //
+    // Non-owning view of contiguous values of one column.
+    // It is invalidated when container is changed.
+    //
+
+    template<
+        typename _Type /* Type of values */
+    > class ColumnSpan
+    {
+    public:
+        ColumnSpan( _Type* data, size_t size ) noexcept
+            : m_data( data )
+            , m_size( size )
+        { }
+
+        _Type* Data() const noexcept
+        {
+            return m_data;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        _Type& operator[]( size_t index ) const noexcept
+        {
+            return m_data[index];
+        }
+
+        //
+        // Iterators for range-based for
+        //
+
+        _Type* begin() const noexcept
+        {
+            return m_data;
+        }
+
+        _Type* end() const noexcept
+        {
+            return m_data + m_size;
+        }
+
+    private:
+
+        //
+        // Pointer to the first value
+        //
+        _Type* m_data;
+
+        //
+        // Number of values
+        //
+        size_t m_size;
+    };
+
+namespace details {
+
+    //
+    // std::vector<bool> is a bitset without data(), so values of
+    // 'bool' fields are stored in byte-sized cells. Cell has the same
+    // size and representation as 'bool', so column of cells is viewed
+    // as an array of 'bool' and is filled by transposition as is.
+    //
+    struct _BoolCell
+    {
+        _BoolCell() noexcept = default;
+
+        _BoolCell( bool value ) noexcept
+            : value( value )
+        { }
+
+        bool value;
+    };
+
+    static_assert( sizeof( _BoolCell ) == sizeof( bool ), "Cell of bool column must be of size of bool" );
+
+    template<typename _Field>
+    struct _Cell
+    {
+        using type = _Field;
+    };
+
+    template<>
+    struct _Cell<bool>
+    {
+        using type = _BoolCell;
+    };
+
+    //
+    // Column of values of one field
+    //
+    template<typename _Field>
+    using _Column_t = std::vector<typename _Cell<_Field>::type, CacheAlignedAllocator<typename _Cell<_Field>::type>>;
+
+    //
+    // Access to value stored in cell
+    //
+
+    template<typename _Value>
+    _Value& _Unwrap( _Value& value ) noexcept
+    {
+        return value;
+    }
+
+    inline bool& _Unwrap( _BoolCell& cell ) noexcept
+    {
+        return cell.value;
+    }
+
+    inline const bool& _Unwrap( const _BoolCell& cell ) noexcept
+    {
+        return cell.value;
+    }
+
+    //
+    // Pointer to the first value of column
+    //
+
+    template<typename _Value, typename _Allocator>
+    _Value* _Data( std::vector<_Value, _Allocator>& column ) noexcept
+    {
+        return column.data();
+    }
+
+    template<typename _Value, typename _Allocator>
+    const _Value* _Data( const std::vector<_Value, _Allocator>& column ) noexcept
+    {
+        return column.data();
+    }
+
+    template<typename _Allocator>
+    bool* _Data( std::vector<_BoolCell, _Allocator>& column ) noexcept
+    {
+        return reinterpret_cast<bool*>( column.data() );
+    }
+
+    template<typename _Allocator>
+    const bool* _Data( const std::vector<_BoolCell, _Allocator>& column ) noexcept
+    {
+        return reinterpret_cast<const bool*>( column.data() );
+    }
+
+    //
+    // Tuple of columns for each type in type list
+    //
+
+    template<typename _TypeList>
+    struct _Columns; /* Not implemented */
+
+    template<typename... _Fields>
+    struct _Columns<type_list::TypeList<_Fields...>>
+    {
+        using type = types::Tuple<_Column_t<_Fields>...>;
+    };
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Container, that stores each field of objects in separate
+    // column. Interface is the same as one of other containers
+    // of library: objects are pushed and got back by index.
+    //
+
+    template<
+        typename _Type /* Type to be stored */
+    > class SoaVector
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        using value_t = _Type;
+        using fields_t = decltype( reflection::GetTypeList<_Type>() );
+        using columns_t = typename details::_Columns<fields_t>::type;
+
+    public:
+
+        //
+        // Number of fields (and columns)
+        //
+        static constexpr size_t fieldsCount = reflection::GetFieldsCount<_Type>();
+
+        //
+        // Type of field with specified index
+        //
+        template<size_t _Idx>
+        using field_t = typename decltype( type_list::get<_Idx>( fields_t{} ) )::type;
+
+        SoaVector() = default;
+
+        SoaVector( const SoaVector<_Type>& ) = default;
+        SoaVector& operator=( const SoaVector<_Type>& ) = default;
+
+        SoaVector( SoaVector<_Type>&& ) = default;
+        SoaVector& operator=( SoaVector<_Type>&& ) = default;
+
+        //
+        // Number of stored objects
+        //
+        size_t Size() const noexcept
+        {
+            return types::get<0>( m_columns ).size();
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return Size() == 0;
+        }
+
+        void Reserve( size_t count )
+        {
+            types::for_each( m_columns, [count]( auto& column ) { column.reserve( count ); } );
+        }
+
+        void Clear() noexcept
+        {
+            types::for_each( m_columns, []( auto& column ) { column.clear(); } );
+        }
+
+        //
+        // Splits object into columns. If any value can
+        // not be copied, container is left unchanged.
+        //
+
+        void PushBack( const value_t& obj )
+        {
+            auto view = reflection::ToTuplePreciseView( obj );
+            _PushBack_Impl( view, std::make_index_sequence<fieldsCount>{}, std::false_type{} );
+        }
+
+        void PushBack( value_t&& obj )
+        {
+            auto view = reflection::ToTuplePreciseView( obj );
+            _PushBack_Impl( view, std::make_index_sequence<fieldsCount>{}, std::true_type{} );
+        }
+
+        //
+        // Appends 'count' objects from array
+        //
+        void AppendRange( const value_t* objs, size_t count )
+        {
+            _AppendRange_Impl( objs, count, is_supported_type<_Type>{} );
+        }
+
+        //
+        // Reassembles object with specified index
+        //
+        value_t Get( size_t index ) const
+        {
+            if (index >= Size()) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            return _Get_Impl( index, std::make_index_sequence<fieldsCount>{} );
+        }
+
+        //
+        // Reassembles 'count' objects starting at 'index' into array
+        //
+        void LoadRange( value_t* objs, size_t index, size_t count ) const
+        {
+            if (index > Size() || count > Size() - index) {
+                throw std::out_of_range( "Index is out of range" );
+            }
+
+            _LoadRange_Impl( objs, index, count, is_supported_type<_Type>{} );
+        }
+
+        //
+        // Views row with specified index as a tuple of
+        // references to its values. Index is not checked.
+        //
+
+        auto operator[]( size_t index ) noexcept
+        {
+            return _Row_Impl( m_columns, index, std::make_index_sequence<fieldsCount>{} );
+        }
+
+        auto operator[]( size_t index ) const noexcept
+        {
+            return _Row_Impl( m_columns, index, std::make_index_sequence<fieldsCount>{} );
+        }
+
+        //
+        // Views values of one field
+        //
+
+        template<size_t _Idx>
+        ColumnSpan<field_t<_Idx>> Column() noexcept
+        {
+            auto& column = types::get<_Idx>( m_columns );
+            return ColumnSpan<field_t<_Idx>>( details::_Data( column ), column.size() );
+        }
+
+        template<size_t _Idx>
+        ColumnSpan<const field_t<_Idx>> Column() const noexcept
+        {
+            auto& column = types::get<_Idx>( m_columns );
+            return ColumnSpan<const field_t<_Idx>>( details::_Data( column ), column.size() );
+        }
+
+    private:
+
+        //
+        // Values are moved from object, if it is rvalue
+        //
+
+        template<typename _Value>
+        static const _Value& _Pass( const _Value& value, std::false_type /* move */ ) noexcept
+        {
+            return value;
+        }
+
+        template<typename _Value>
+        static _Value&& _Pass( _Value& value, std::true_type /* move */ ) noexcept
+        {
+            return std::move( value );
+        }
+
+        template<
+            typename  _View /* Tuple of references to fields */,
+            size_t... _Idxs /* Indices of fields */,
+            typename  _Move /* Are values moved? */
+        > void _PushBack_Impl( _View& view, std::index_sequence<_Idxs...> /* indices */, _Move move )
+        {
+            using types::get;
+
+            size_t pushed = 0;
+
+            try
+            {
+                int dummy[] = { 0, (
+                    get<_Idxs>( m_columns ).push_back( _Pass( get<_Idxs>( view ), move ) ), ++pushed, 0
+                )... };
+
+                (void)dummy;
+            }
+            catch (...)
+            {
+                //
+                // Columns, that already got their values, are rolled back
+                //
+                size_t index = 0;
+
+                types::for_each( m_columns, [&index, pushed]( auto& column )
+                {
+                    if (index++ < pushed) {
+                        column.pop_back();
+                    }
+                } );
+
+                throw;
+            }
+        }
+
+        //
+        // POD objects: columns are resized once and
+        // filled by transposition kernel
+        //
+        void _AppendRange_Impl( const value_t* objs, size_t count, std::true_type /* is_supported_type<_Type> */ )
+        {
+            _AppendRange_Impl( objs, count, std::make_index_sequence<fieldsCount>{} );
+        }
+
+        template<size_t... _Idxs>
+        void _AppendRange_Impl( const value_t* objs, size_t count, std::index_sequence<_Idxs...> indices )
+        {
+            using types::get;
+
+            size_t size = Size();
+
+            try
+            {
+                int dummy[] = { 0, ( get<_Idxs>( m_columns ).resize( size + count ), 0 )... };
+                (void)dummy;
+            }
+            catch (...)
+            {
+                int dummy[] = { 0, ( get<_Idxs>( m_columns ).resize( size ), 0 )... };
+                (void)dummy;
+
+                throw;
+            }
+
+            void* const columns[] = { details::_Data( get<_Idxs>( m_columns ) ) + size... };
+
+            details::_Gather<_Type, fields_t>( objs, count, columns, indices );
+        }
+
+        //
+        // Other objects are pushed one by one
+        //
+        void _AppendRange_Impl( const value_t* objs, size_t count, std::false_type /* is_supported_type<_Type> */ )
+        {
+            Reserve( Size() + count );
+
+            for (size_t i = 0; i < count; ++i) {
+                PushBack( objs[i] );
+            }
+        }
+
+        void _LoadRange_Impl( value_t* objs, size_t index, size_t count, std::true_type /* is_supported_type<_Type> */ ) const
+        {
+            _LoadRange_Impl( objs, index, count, std::make_index_sequence<fieldsCount>{} );
+        }
+
+        template<size_t... _Idxs>
+        void _LoadRange_Impl( value_t* objs, size_t index, size_t count, std::index_sequence<_Idxs...> indices ) const
+        {
+            const void* const columns[] = { details::_Data( types::get<_Idxs>( m_columns ) ) + index... };
+
+            details::_Scatter<_Type, fields_t>( columns, count, objs, indices );
+        }
+
+        void _LoadRange_Impl( value_t* objs, size_t index, size_t count, std::false_type /* is_supported_type<_Type> */ ) const
+        {
+            for (size_t i = 0; i < count; ++i) {
+                objs[i] = _Get_Impl( index + i, std::make_index_sequence<fieldsCount>{} );
+            }
+        }
+
+        template<size_t... _Idxs>
+        value_t _Get_Impl( size_t index, std::index_sequence<_Idxs...> /* indices */ ) const
+        {
+            return value_t{ details::_Unwrap( types::get<_Idxs>( m_columns )[index] )... };
+        }
+
+        template<
+            typename  _Columns /* Tuple of columns (maybe const) */,
+            size_t... _Idxs    /* Indices of fields */
+        > static auto _Row_Impl( _Columns& columns, size_t index, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+        {
+            using tuple_t = types::Tuple<decltype( details::_Unwrap( types::get<_Idxs>( columns )[index] ) )...>;
+
+            return tuple_t{ details::_Unwrap( types::get<_Idxs>( columns )[index] )... };
+        }
+
+    private:
+
+        //
+        // Columns of fields
+        //
+        columns_t m_columns;
+    };
+
+} // columnar
\ No newline at end of file
@@ -0,0 +1,601 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Reflection.h"
+#include "Tuple.h"
+#include "Aggregate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+/************************************************************************************
+ * Sorting of objects by field
+ *
+ * The key-concept is following:
+ *  - Field is chosen by its index in GetTypeList and its value is got by
+ *    the same loaders as aggregations use. Enumerations are sorted by their
+ *    underlying types.
+ *  - Integer and floating-point values are converted into unsigned keys of
+ *    the same size, which preserve order: sign bit of integers is flipped,
+ *    all bits of negative floating-point numbers are flipped. Keys are
+ *    sorted with radix sort by bytes, bytes equal in all keys are skipped.
+ *  - Large arrays are split into buckets by the highest differing byte
+ *    first, and each bucket is sorted by the rest of bytes (LSD), when it
+ *    fits into cache. So only one pass writes into 256 distant places of
+ *    memory.
+ *  - Keys are sorted together with indices of objects, so objects are
+ *    moved only once, after sorting.
+ *  - Parallel variant splits keys into equal chunks for the first pass:
+ *    each thread counts bytes in its chunk, and then writes its keys into
+ *    its own part of each bucket. Then buckets are sorted by threads
+ *    independently.
+ *  - Fields of other types are sorted with std::stable_sort and operator <.
+ *
+ ************************************************************************************/
+
+
+namespace columnar {
+namespace details {
+
+    //
+    // Radix of sort: keys are sorted by bytes
+    //
+    static constexpr size_t _RadixBits = 8;
+    static constexpr size_t _RadixBuckets = 1 << _RadixBits;
+
+    //
+    // Smaller arrays are sorted by comparison: passes
+    // over buckets are too expensive for them
+    //
+    static constexpr size_t _RadixMinCount = 256;
+
+    //
+    // Buckets of keys, that are smaller, are sorted by insertion
+    //
+    static constexpr size_t _InsertionSortCount = 32;
+
+    //
+    // Smaller ranges are split into buckets by the highest
+    // byte: buckets are small enough to be sorted by
+    // insertion, that is cheaper than LSD passes
+    //
+    static constexpr size_t _RadixLsdMinCount = _RadixBuckets * _InsertionSortCount;
+
+    //
+    // Number of keys, that are sorted in cache (with buffer
+    // they take 2 MB for 8-byte keys, i.e. fit into L2)
+    //
+    static constexpr size_t _RadixCacheCount = 1 << 16;
+
+    //
+    // Arrays, that are smaller, are not split between threads
+    //
+    static constexpr size_t _ParallelSortMinCount = 1 << 16;
+
+    /************************************************************************************/
+
+    //
+    // Tags of sort algorithms
+    //
+
+    struct _RadixSortTag { };
+    struct _CompareSortTag { };
+
+    template<typename _Field>
+    using _SortTag_t = typename std::conditional<
+        std::is_arithmetic<_Arithmetic_t<_Field>>::value && !std::is_same<_Arithmetic_t<_Field>, long double>::value,
+        _RadixSortTag, _CompareSortTag
+    >::type;
+
+    //
+    // Unsigned key of the same size as value
+    //
+
+    template<size_t _Size>
+    struct _UnsignedOfSize; /* Not implemented */
+
+    template<> struct _UnsignedOfSize<1> { using type = uint8_t;  };
+    template<> struct _UnsignedOfSize<2> { using type = uint16_t; };
+    template<> struct _UnsignedOfSize<4> { using type = uint32_t; };
+    template<> struct _UnsignedOfSize<8> { using type = uint64_t; };
+
+    template<typename _Value>
+    using _RadixKey_t = typename _UnsignedOfSize<sizeof( _Value )>::type;
+
+    //
+    // Converts value into key with the same order
+    //
+
+    template<typename _Value>
+    _RadixKey_t<_Value> _ToRadixKey( _Value value, std::true_type /* std::is_integral<_Value> */ ) noexcept
+    {
+        using key_t = _RadixKey_t<_Value>;
+
+        constexpr auto sign = static_cast<key_t>( std::is_signed<_Value>::value ? key_t( 1 ) << ( sizeof( key_t ) * 8 - 1 ) : 0 );
+
+        return static_cast<key_t>( static_cast<key_t>( value ) ^ sign );
+    }
+
+    template<typename _Value>
+    _RadixKey_t<_Value> _ToRadixKey( _Value value, std::false_type /* std::is_integral<_Value> */ ) noexcept
+    {
+        using key_t = _RadixKey_t<_Value>;
+
+        constexpr auto sign = static_cast<key_t>( key_t( 1 ) << ( sizeof( key_t ) * 8 - 1 ) );
+
+        key_t key;
+        std::memcpy( &key, &value, sizeof( key ) );
+
+        //
+        // Larger magnitude of negative number means smaller
+        // value, so all its bits are flipped. Positive
+        // numbers just go after negative ones.
+        //
+        return static_cast<key_t>( ( key & sign ) ? ~key : key | sign );
+    }
+
+    template<typename _Value>
+    _RadixKey_t<_Value> _ToRadixKey( _Value value ) noexcept
+    {
+        return _ToRadixKey( value, std::is_integral<_Value>{} );
+    }
+
+    template<typename _Key>
+    size_t _Digit( _Key key, size_t pass ) noexcept
+    {
+        return static_cast<size_t>( ( key >> ( pass * _RadixBits ) ) & ( _RadixBuckets - 1 ) );
+    }
+
+    //
+    // Key and index of object
+    //
+    template<typename _Key>
+    struct _KeyIndex
+    {
+        _Key   key;
+        size_t index;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Runs func( 0 ), ..., func( threadsCount - 1 ) in parallel.
+    // Current thread runs func( 0 ) itself. If thread can not be
+    // created, the rest of calls are made by current thread.
+    //
+    template<typename _Func>
+    void _RunParallel( size_t threadsCount, _Func func )
+    {
+        std::vector<std::thread> threads;
+        threads.reserve( threadsCount );
+
+        try
+        {
+            for (size_t index = 1; index < threadsCount; ++index) {
+                threads.emplace_back( func, index );
+            }
+        }
+        catch (...)
+        {
+            for (size_t index = threads.size() + 1; index < threadsCount; ++index) {
+                func( index );
+            }
+        }
+
+        func( 0 );
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    //
+    // Returns range of items of chunk with specified index
+    //
+    inline void _ChunkRange( size_t count, size_t chunksCount, size_t chunk, size_t& first, size_t& last ) noexcept
+    {
+        size_t chunkSize = ( count + chunksCount - 1 ) / chunksCount;
+
+        first = (std::min)( chunk * chunkSize, count );
+        last = (std::min)( first + chunkSize, count );
+    }
+
+    /************************************************************************************/
+
+    //
+    // Counts bytes [0, bytes) of keys. Returns the highest
+    // byte, that is not the same in all keys, or 'bytes'
+    // if all keys are equal.
+    //
+    template<typename _Key>
+    size_t _CountDigits( const _KeyIndex<_Key>* items, size_t count, size_t bytes, size_t ( *counts )[_RadixBuckets] ) noexcept
+    {
+        //
+        // All bytes are counted: loop over them has constant
+        // bounds, so it is unrolled, and it is cheaper than
+        // skipping of unused ones
+        //
+        std::fill( counts[0], counts[0] + sizeof( _Key ) * _RadixBuckets, 0 );
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t pass = 0; pass < sizeof( _Key ); ++pass) {
+                ++counts[pass][_Digit( items[i].key, pass )];
+            }
+        }
+
+        for (size_t pass = bytes; pass-- > 0; )
+        {
+            if (counts[pass][_Digit( items[0].key, pass )] != count) {
+                return pass;
+            }
+        }
+
+        return bytes;
+    }
+
+    //
+    // Moves items into buckets of one byte. Offsets
+    // of buckets are advanced past written items.
+    //
+    template<typename _Key>
+    void _ScatterDigits( const _KeyIndex<_Key>* items, size_t count, size_t pass, _KeyIndex<_Key>* buffer, size_t* offsets ) noexcept
+    {
+        for (size_t i = 0; i < count; ++i) {
+            buffer[offsets[_Digit( items[i].key, pass )]++] = items[i];
+        }
+    }
+
+    inline void _BucketOffsets( const size_t* counts, size_t* offsets ) noexcept
+    {
+        size_t offset = 0;
+
+        for (size_t digit = 0; digit < _RadixBuckets; ++digit)
+        {
+            offsets[digit] = offset;
+            offset += counts[digit];
+        }
+    }
+
+    //
+    // Sorts few items by insertion (it is stable)
+    //
+    template<typename _Key>
+    void _InsertionSort( _KeyIndex<_Key>* items, size_t count ) noexcept
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            auto item = items[i];
+            size_t j = i;
+
+            for (; j > 0 && item.key < items[j - 1].key; --j) {
+                items[j] = items[j - 1];
+            }
+
+            items[j] = item;
+        }
+    }
+
+    //
+    // Sorts items of 'source' by bytes [0, bytes) of keys.
+    // Result is written into 'target', that is either 'source'
+    // or 'other'. The other one is used as a buffer.
+    //
+    // Ranges, that fit into cache, are sorted with LSD radix
+    // sort. Larger ones are split into buckets by the highest
+    // differing byte first (it is the only pass, that writes
+    // to 256 distant places), so each bucket is sorted by the
+    // rest of bytes in cache. Small ranges are split the same
+    // way, and their buckets are sorted by insertion.
+    //
+    template<typename _Key>
+    void _RadixSort( _KeyIndex<_Key>* source, _KeyIndex<_Key>* other, _KeyIndex<_Key>* target, size_t count, size_t bytes ) noexcept
+    {
+        size_t counts[sizeof( _Key )][_RadixBuckets];
+        size_t offsets[_RadixBuckets];
+
+        size_t highest = count < _InsertionSortCount ? bytes : _CountDigits( source, count, bytes, counts );
+
+        if (count < _InsertionSortCount) {
+            _InsertionSort( source, count );
+        }
+        else if (highest == bytes) {
+            /* All keys are equal */
+        }
+        else if (count >= _RadixLsdMinCount && count <= _RadixCacheCount)
+        {
+            auto destination = other;
+
+            for (size_t pass = 0; pass <= highest; ++pass)
+            {
+                if (counts[pass][_Digit( source[0].key, pass )] == count) {
+                    continue;
+                }
+
+                _BucketOffsets( counts[pass], offsets );
+                _ScatterDigits( source, count, pass, destination, offsets );
+
+                std::swap( source, destination );
+            }
+        }
+        else
+        {
+            _BucketOffsets( counts[highest], offsets );
+            _ScatterDigits( source, count, highest, other, offsets );
+
+            //
+            // Offsets are ends of buckets now
+            //
+            size_t first = 0;
+
+            for (size_t digit = 0; digit < _RadixBuckets; ++digit)
+            {
+                size_t last = offsets[digit];
+
+                _RadixSort( other + first, source + first, target + first, last - first, highest );
+                first = last;
+            }
+
+            return;
+        }
+
+        if (source != target) {
+            std::copy( source, source + count, target );
+        }
+    }
+
+    //
+    // The same as _RadixSort, but the first pass over buckets
+    // is split between threads by chunks of items, and then
+    // buckets are taken by threads one by one.
+    //
+    template<typename _Key>
+    void _RadixSortParallel( _KeyIndex<_Key>* items, _KeyIndex<_Key>* buffer, size_t count, size_t threadsCount )
+    {
+        using counts_t = std::vector<size_t>;
+
+        constexpr size_t bytes = sizeof( _Key );
+
+        //
+        // Counts of digits of each byte in each chunk
+        //
+        std::vector<std::vector<counts_t>> counts( threadsCount, std::vector<counts_t>( bytes, counts_t( _RadixBuckets ) ) );
+
+        _RunParallel( threadsCount, [&]( size_t chunk )
+        {
+            size_t first, last;
+            _ChunkRange( count, threadsCount, chunk, first, last );
+
+            for (size_t i = first; i < last; ++i)
+            {
+                for (size_t pass = 0; pass < bytes; ++pass) {
+                    ++counts[chunk][pass][_Digit( items[i].key, pass )];
+                }
+            }
+        } );
+
+        //
+        // The highest differing byte
+        //
+        size_t highest = bytes;
+
+        for (size_t pass = bytes; pass-- > 0 && highest == bytes; )
+        {
+            size_t digit = _Digit( items[0].key, pass );
+            size_t total = 0;
+
+            for (size_t chunk = 0; chunk < threadsCount; ++chunk) {
+                total += counts[chunk][pass][digit];
+            }
+
+            if (total != count) {
+                highest = pass;
+            }
+        }
+
+        if (highest == bytes) {
+            return;
+        }
+
+        //
+        // Each bucket is split between chunks in order
+        // of chunks, so sort remains stable
+        //
+        std::vector<counts_t> offsets( threadsCount, counts_t( _RadixBuckets ) );
+        counts_t ends( _RadixBuckets );
+
+        size_t offset = 0;
+
+        for (size_t digit = 0; digit < _RadixBuckets; ++digit)
+        {
+            for (size_t chunk = 0; chunk < threadsCount; ++chunk)
+            {
+                offsets[chunk][digit] = offset;
+                offset += counts[chunk][highest][digit];
+            }
+
+            ends[digit] = offset;
+        }
+
+        _RunParallel( threadsCount, [&]( size_t chunk )
+        {
+            size_t first, last;
+            _ChunkRange( count, threadsCount, chunk, first, last );
+
+            _ScatterDigits( items + first, last - first, highest, buffer, offsets[chunk].data() );
+        } );
+
+        std::atomic<size_t> nextDigit{ 0 };
+
+        _RunParallel( threadsCount, [&]( size_t /* thread */ )
+        {
+            for (size_t digit = nextDigit++; digit < _RadixBuckets; digit = nextDigit++)
+            {
+                size_t first = digit ? ends[digit - 1] : 0;
+                size_t last = ends[digit];
+
+                _RadixSort( buffer + first, items + first, items + first, last - first, highest );
+            }
+        } );
+    }
+
+    /************************************************************************************/
+
+    template<size_t _Idx, typename _Type>
+    void _SortByField_Impl( _Type* objs, size_t count, size_t threadsCount, _RadixSortTag )
+    {
+        using value_t = _Arithmetic_t<_Field_t<_Idx, _Type>>;
+        using key_t = _RadixKey_t<value_t>;
+        using pod_t = is_supported_type<_Type>;
+
+        if (count < _RadixMinCount)
+        {
+            auto Less = []( const _Type& left, const _Type& right )
+            {
+                return _ToRadixKey( _MakeLoader<_Idx>( &left, pod_t{} )( 0 ) ) < _ToRadixKey( _MakeLoader<_Idx>( &right, pod_t{} )( 0 ) );
+            };
+
+            std::stable_sort( objs, objs + count, Less );
+            return;
+        }
+
+        //
+        // Arrays are not value-initialized: they are
+        // overwritten anyway
+        //
+        std::unique_ptr<_KeyIndex<key_t>[]> items( new _KeyIndex<key_t>[count] );
+        std::unique_ptr<_KeyIndex<key_t>[]> buffer( new _KeyIndex<key_t>[count] );
+
+        auto load = _MakeLoader<_Idx>( objs, pod_t{} );
+
+        _RunParallel( threadsCount, [&]( size_t chunk )
+        {
+            size_t first, last;
+            _ChunkRange( count, threadsCount, chunk, first, last );
+
+            for (size_t i = first; i < last; ++i) {
+                items[i] = _KeyIndex<key_t>{ _ToRadixKey( load( i ) ), i };
+            }
+        } );
+
+        if (threadsCount > 1) {
+            _RadixSortParallel( items.get(), buffer.get(), count, threadsCount );
+        }
+        else {
+            _RadixSort( items.get(), buffer.get(), items.get(), count, sizeof( key_t ) );
+        }
+
+        //
+        // Objects are moved into their places through
+        // temporary array
+        //
+        buffer.reset();
+
+        std::unique_ptr<_Type[]> sorted( new _Type[count] );
+
+        _RunParallel( threadsCount, [&]( size_t chunk )
+        {
+            size_t first, last;
+            _ChunkRange( count, threadsCount, chunk, first, last );
+
+            for (size_t i = first; i < last; ++i) {
+                sorted[i] = std::move( objs[items[i].index] );
+            }
+        } );
+
+        _RunParallel( threadsCount, [&]( size_t chunk )
+        {
+            size_t first, last;
+            _ChunkRange( count, threadsCount, chunk, first, last );
+
+            std::move( sorted.get() + first, sorted.get() + last, objs + first );
+        } );
+    }
+
+    template<size_t _Idx, typename _Type>
+    void _SortByField_Impl( _Type* objs, size_t count, size_t /* threadsCount */, _CompareSortTag )
+    {
+        auto Less = []( const _Type& left, const _Type& right )
+        {
+            return types::get<_Idx>( reflection::ToTuplePreciseView( left ) ) < types::get<_Idx>( reflection::ToTuplePreciseView( right ) );
+        };
+
+        std::stable_sort( objs, objs + count, Less );
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Sorts objects by field with index _Idx in ascending order.
+    // Sort is stable. Integer, floating-point and enumeration
+    // fields are sorted with radix sort: -0.0 goes before +0.0,
+    // NaNs go to the beginning or to the end by their sign.
+    // Other fields are compared with operator <.
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > void SortByField( _Type* objs, size_t count )
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        details::_SortByField_Impl<_Idx>( objs, count, 1, details::_SortTag_t<details::_Field_t<_Idx, _Type>>{} );
+    }
+
+    template<
+        size_t   _Idx       /* Index of field */,
+        typename _Type      /* Type of objects */,
+        typename _Allocator /* Allocator of vector */
+    > void SortByField( std::vector<_Type, _Allocator>& objs )
+    {
+        SortByField<_Idx>( objs.data(), objs.size() );
+    }
+
+    //
+    // The same as SortByField, but radix sort is run by several
+    // threads. If 'threadsCount' is zero, number of hardware
+    // threads is used. Small arrays and fields, that are not
+    // sorted by radix sort, are sorted by current thread only.
+    //
+
+    template<
+        size_t   _Idx  /* Index of field */,
+        typename _Type /* Type of objects */
+    > void SortByFieldParallel( _Type* objs, size_t count, size_t threadsCount = 0 )
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        if (!threadsCount) {
+            threadsCount = (std::max)( std::thread::hardware_concurrency(), 1u );
+        }
+
+        if (count < details::_ParallelSortMinCount) {
+            threadsCount = 1;
+        }
+
+        details::_SortByField_Impl<_Idx>( objs, count, threadsCount, details::_SortTag_t<details::_Field_t<_Idx, _Type>>{} );
+    }
+
+    template<
+        size_t   _Idx       /* Index of field */,
+        typename _Type      /* Type of objects */,
+        typename _Allocator /* Allocator of vector */
+    > void SortByFieldParallel( std::vector<_Type, _Allocator>& objs, size_t threadsCount = 0 )
+    {
+        SortByFieldParallel<_Idx>( objs.data(), objs.size(), threadsCount );
+    }
+
+} // columnar
\ No newline at end of file
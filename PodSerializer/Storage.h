@@ -0,0 +1,315 @@
+#pragma once
+
+#include "pch.h"
+
+
+/************************************************************************************
+ * Storage policies for binary buffers.
+ *
+ * Each storage provides the same interface:
+ *  - void Allocate( size_t size ) - prepares 'size' bytes (called once by buffer)
+ *  - unsigned char* Data()        - pointer to prepared bytes
+ *  - size_t Size() const          - number of prepared bytes
+ *
+ * Following storages are implemented:
+ *  - DynamicStorage  - bytes are allocated with an allocator (heap by default)
+ *  - InlineStorage   - bytes are stored inside of storage object itself
+ *  - ExternalStorage - bytes are provided by caller (e.g. network frame)
+ *
+ * Arena and ArenaAllocator can be used with DynamicStorage to allocate
+ * memory from caller-provided block without touching heap.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+
+    /************************************************************************************/
+
+    //
+    // Storage that allocates bytes with an allocator
+    //
+
+    template<
+        typename _Allocator = std::allocator<unsigned char> /* Allocator */
+    > class DynamicStorage
+    {
+        using buffer_t = std::vector<unsigned char, _Allocator>;
+
+    public:
+        explicit DynamicStorage( const _Allocator& allocator = _Allocator{} )
+            : m_buffer( allocator )
+        { }
+
+        void Allocate( size_t size )
+        {
+            m_buffer.resize( size );
+        }
+
+        unsigned char* Data() noexcept
+        {
+            return m_buffer.data();
+        }
+
+        const unsigned char* Data() const noexcept
+        {
+            return m_buffer.data();
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_buffer.size();
+        }
+
+    private:
+
+        //
+        // Allocated bytes
+        //
+        buffer_t m_buffer;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Storage that keeps bytes inside of itself.
+    // No memory is allocated at all.
+    //
+
+    template<
+        size_t _Capacity /* Maximal number of bytes */
+    > class InlineStorage
+    {
+    public:
+        InlineStorage() noexcept
+            : m_size( 0 )
+        { }
+
+        void Allocate( size_t size )
+        {
+            if (size > _Capacity) {
+                throw std::length_error( "Storage capacity is exceeded" );
+            }
+
+            m_size = size;
+        }
+
+        unsigned char* Data() noexcept
+        {
+            return m_buffer;
+        }
+
+        const unsigned char* Data() const noexcept
+        {
+            return m_buffer;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+    private:
+
+        //
+        // Number of used bytes
+        //
+        size_t m_size;
+
+        //
+        // Bytes
+        //
+        unsigned char m_buffer[_Capacity];
+    };
+
+    /************************************************************************************/
+
+    //
+    // Storage over memory provided by caller.
+    // Memory must outlive the storage. Storage can not be
+    // copied, because two storages would share the same memory.
+    //
+
+    class ExternalStorage
+    {
+    public:
+        ExternalStorage( unsigned char* data, size_t capacity ) noexcept
+            : m_data( data )
+            , m_capacity( capacity )
+            , m_size( 0 )
+        { }
+
+        ExternalStorage( const ExternalStorage& ) = delete;
+        ExternalStorage& operator=( const ExternalStorage& ) = delete;
+
+        ExternalStorage( ExternalStorage&& ) = default;
+        ExternalStorage& operator=( ExternalStorage&& ) = default;
+
+        void Allocate( size_t size )
+        {
+            if (size > m_capacity) {
+                throw std::length_error( "Storage capacity is exceeded" );
+            }
+
+            m_size = size;
+        }
+
+        unsigned char* Data() noexcept
+        {
+            return m_data;
+        }
+
+        const unsigned char* Data() const noexcept
+        {
+            return m_data;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+    private:
+
+        //
+        // Pointer to external memory
+        //
+        unsigned char* m_data;
+
+        //
+        // Size of external memory
+        //
+        size_t m_capacity;
+
+        //
+        // Number of used bytes
+        //
+        size_t m_size;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Bump allocator over caller-provided memory.
+    // Memory is never released one by one: whole arena
+    // is reset at once (e.g. at the end of request).
+    //
+
+    class Arena
+    {
+    public:
+        Arena( void* memory, size_t size ) noexcept
+            : m_begin( static_cast<unsigned char*>( memory ) )
+            , m_size( size )
+            , m_used( 0 )
+        { }
+
+        Arena( const Arena& ) = delete;
+        Arena& operator=( const Arena& ) = delete;
+
+        void* Allocate( size_t size, size_t alignment )
+        {
+            auto address = reinterpret_cast<std::uintptr_t>( m_begin + m_used );
+            auto padding = (alignment - address % alignment) % alignment;
+
+            if (padding + size > m_size - m_used) {
+                throw std::bad_alloc();
+            }
+
+            m_used += padding;
+            void* result = m_begin + m_used;
+            m_used += size;
+
+            return result;
+        }
+
+        void Reset() noexcept
+        {
+            m_used = 0;
+        }
+
+        size_t Used() const noexcept
+        {
+            return m_used;
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+    private:
+
+        //
+        // Beginning of memory block
+        //
+        unsigned char* m_begin;
+
+        //
+        // Size of memory block
+        //
+        size_t m_size;
+
+        //
+        // Number of allocated bytes
+        //
+        size_t m_used;
+    };
+
+    //
+    // Standard-compatible allocator, that takes memory from arena
+    //
+
+    template<
+        typename _Type /* Type of allocated objects */
+    > class ArenaAllocator
+    {
+        template<typename> friend class ArenaAllocator;
+
+    public:
+        using value_type = _Type;
+
+        ArenaAllocator( Arena& arena ) noexcept
+            : m_arena( &arena )
+        { }
+
+        template<typename _Other>
+        ArenaAllocator( const ArenaAllocator<_Other>& other ) noexcept
+            : m_arena( other.m_arena )
+        { }
+
+        _Type* allocate( size_t count )
+        {
+            return static_cast<_Type*>( m_arena->Allocate( count * sizeof( _Type ), alignof( _Type ) ) );
+        }
+
+        void deallocate( _Type* /* ptr */, size_t /* count */ ) noexcept
+        { /* Memory is released with Arena::Reset */ }
+
+        template<typename _Other>
+        bool operator==( const ArenaAllocator<_Other>& other ) const noexcept
+        {
+            return m_arena == other.m_arena;
+        }
+
+        template<typename _Other>
+        bool operator!=( const ArenaAllocator<_Other>& other ) const noexcept
+        {
+            return m_arena != other.m_arena;
+        }
+
+    private:
+
+        //
+        // Arena to allocate memory from
+        //
+        Arena* m_arena;
+    };
+
+    //
+    // Alias for storage, that allocates memory from arena
+    //
+
+    using ArenaStorage = DynamicStorage<ArenaAllocator<unsigned char>>;
+
+} // serialization
\ No newline at end of file
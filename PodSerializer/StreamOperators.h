@@ -11,6 +11,33 @@
 
 
 namespace io_operators {
+
+    //
+    // Operators are used recursively for nested structures,
+    // so they must be declared before internal implementation.
+    // Definitions are below.
+    // 
+
+    template<
+        typename _Type /* Type of structure, that we want to get from stream */,
+        typename _Char /* Type of chars used in stream */,
+        typename _Traits
+            = std::char_traits<_Char>
+    > constexpr std::basic_istream<_Char, _Traits>& operator>>(
+        std::basic_istream<_Char, _Traits>& stream, _Type& obj
+    );
+
+    template<
+        typename _Type /* Type of structure, that we want to put into stream */,
+        typename _Char /* Type of chars used in stream */,
+        typename _Traits
+            = std::char_traits<_Char>
+    > constexpr std::basic_ostream<_Char, _Traits>& operator<<(
+        std::basic_ostream<_Char, _Traits>& stream, const _Type& obj
+    );
+
+    /************************************************************************************/
+
 namespace {
 
     //
@@ -29,28 +56,22 @@ namespace {
         std::index_sequence<_Idxs...> /* indices */
     )
     {
-        using reflection::ToTuplePrecise;
-        using reflection::FromTuple;
-        using types::Tuple;
-        using types::get;
-
-        //
-        // Determine type of a tuple
-        // 
-        using tuple_t = decltype( ToTuplePrecise( obj ) );
+        using reflection::ToTuplePreciseView;
 
         auto sep = static_cast<_Char>( stream.iword( io_manipulators::io_internal::separator_fmt_id ) );
         bool bIsSepSet = stream.iword( io_manipulators::io_internal::is_separator_set_fmt_id ) == io_manipulators::io_internal::separator_enabled;
 
         //
-        // Create one and put values from stream type-safely into it
+        // View contains references to fields of our object, so values
+        // from stream are put type-safely directly into its fields.
+        // No temporary tuple and no assignment of whole object are necessary.
         // 
-        tuple_t container;
+        auto view = ToTuplePreciseView( obj );
         size_t index = 0;
 
         auto PutToTuple = [&stream = stream, &index, sep, bIsSepSet]( auto& /* non-const lvalue */ element ) 
         {
-            using _CleanType = std::decay<decltype( element )>::type;
+            using _CleanType = typename std::decay<decltype( element )>::type;
 
             //
             // If type is supported to be reflected,
@@ -83,9 +104,7 @@ namespace {
             }
         };
 
-        types::for_each( container, PutToTuple );
-
-        obj = FromTuple<_Type>( container );
+        types::for_each( view, PutToTuple );
 
         return stream;
     }
@@ -113,7 +132,7 @@ namespace {
     )
     {
         return _OperatorFromStream_Impl( 
-            stream, obj, std::make_index_sequence<GetFieldsCount<_Type>()>{} 
+            stream, obj, std::make_index_sequence<reflection::GetFieldsCount<_Type>()>{} 
         );
     }
 
@@ -155,11 +174,11 @@ namespace {
         std::basic_ostream<_Char, _Traits>& stream, const _Type& obj, std::false_type
     )
     {
-        using reflection::ToTuplePrecise;
+        using reflection::ToTuplePreciseView;
 
         //
-        // Convert object to tuple and then put each
-        // element of tuple into our stream
+        // View object as a tuple of references and then
+        // put each referenced field into our stream
         // 
         
         auto sep = static_cast<_Char>( stream.iword( io_manipulators::io_internal::separator_fmt_id ) );
@@ -170,7 +189,7 @@ namespace {
             stream << "{ ";
         }
 
-        auto obj_tpl = ToTuplePrecise( obj );
+        auto obj_tpl = ToTuplePreciseView( obj );
         size_t index = 0;
 
         auto FlushToStream = [&stream, &index, bIsBeautiful, sep, bIsSepSet]( auto&& element ) 
@@ -185,7 +204,7 @@ namespace {
                 }
             }
 
-            stream << std::forward<std::remove_reference<decltype( element )>::type>( element );
+            stream << std::forward<typename std::remove_reference<decltype( element )>::type>( element );
         };
 
         types::for_each( obj_tpl, FlushToStream );
@@ -230,7 +249,6 @@ namespace {
         typename _Type /* Type of structure, that we want to get from stream */,
         typename _Char /* Type of chars used in stream */,
         typename _Traits
-            = std::char_traits<_Char>
     > constexpr std::basic_istream<_Char, _Traits>& operator>>(
         std::basic_istream<_Char, _Traits>& stream, _Type& obj
     )
@@ -248,7 +266,6 @@ namespace {
         typename _Type /* Type of structure, that we want to put into stream */,
         typename _Char /* Type of chars used in stream */,
         typename _Traits
-            = std::char_traits<_Char>
     > constexpr std::basic_ostream<_Char, _Traits>& operator<<(
         std::basic_ostream<_Char, _Traits>& stream, const _Type& obj
     )
@@ -87,4 +87,4 @@ using is_supported_type_extended = \
     static_assert(                                                               \
         is_supported_type_extended<__Type>::value,                               \
         #__Type " doesn't match the requirements for reflection (see Support.h)" \
-    );
\ No newline at end of file
+    );
@@ -0,0 +1,506 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "TextReader.h"
+#include "TextWriter.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/************************************************************************************
+ * Text files
+ *
+ * The key-concept is following:
+ *  - File contains records, that are separated with delimiter ('\n' by
+ *    default). Fields of each record are separated with separator, i.e.
+ *    each record is laid out as io_operators lay it out with separator
+ *    set by set_separator. Floating-point numbers are written in shortest
+ *    round-trip form (see TextWriter.h), so files are only guaranteed to
+ *    round-trip through io_text reader. Strings must contain neither
+ *    separator, nor delimiter.
+ *  - Records are formatted into and parsed from a block of memory with
+ *    io_text writer and reader. File is accessed by whole blocks only
+ *    (stdio buffering is turned off), so memory used is bounded by block
+ *    size (or by the longest record, if it is longer than block).
+ *  - Wide files contain raw wchar_t values.
+ *
+ ************************************************************************************/
+
+
+namespace io_text {
+namespace details {
+
+    //
+    // Default size of block in chars
+    //
+    static constexpr size_t _DefaultBlockSize = 1 << 16;
+
+    //
+    // Deleter for files
+    //
+    struct _FileCloser
+    {
+        void operator()( std::FILE* file ) const noexcept
+        {
+            std::fclose( file );
+        }
+    };
+
+    using _FilePtr = std::unique_ptr<std::FILE, _FileCloser>;
+
+    //
+    // Opens file without stdio buffering: files
+    // are read and written by whole blocks anyway.
+    //
+    inline _FilePtr _OpenFile( const char* path, const char* mode )
+    {
+        std::FILE* file = nullptr;
+
+#if defined(_MSC_VER)
+        if (fopen_s( &file, path, mode ) != 0) {
+            file = nullptr;
+        }
+#else
+        file = std::fopen( path, mode );
+#endif // defined(_MSC_VER)
+
+        if (!file) {
+            throw std::runtime_error( "Unable to open file" );
+        }
+
+        std::setvbuf( file, nullptr, _IONBF, 0 );
+
+        return _FilePtr( file );
+    }
+
+    //
+    // Files may be larger than 2 GB, so
+    // 64-bit offsets are used explicitly
+    //
+
+    inline void _SeekFile( std::FILE* file, uint64_t offset )
+    {
+#if defined(_MSC_VER)
+        int result = _fseeki64( file, static_cast<long long>( offset ), SEEK_SET );
+#else
+        int result = fseeko( file, static_cast<off_t>( offset ), SEEK_SET );
+#endif // defined(_MSC_VER)
+
+        if (result != 0) {
+            throw std::runtime_error( "Unable to seek file" );
+        }
+    }
+
+    inline uint64_t _FileSize( std::FILE* file )
+    {
+        //
+        // Current position is restored, so the size
+        // can be queried in the middle of reading
+        //
+
+#if defined(_MSC_VER)
+        long long position = _ftelli64( file );
+        int result = position >= 0 ? _fseeki64( file, 0, SEEK_END ) : -1;
+        long long size = result == 0 ? _ftelli64( file ) : -1;
+#else
+        long long position = static_cast<long long>( ftello( file ) );
+        int result = position >= 0 ? fseeko( file, 0, SEEK_END ) : -1;
+        long long size = result == 0 ? static_cast<long long>( ftello( file ) ) : -1;
+#endif // defined(_MSC_VER)
+
+        if (size < 0) {
+            throw std::runtime_error( "Unable to get size of file" );
+        }
+
+        _SeekFile( file, static_cast<uint64_t>( position ) );
+
+        return static_cast<uint64_t>( size );
+    }
+
+    template<typename _Char>
+    void _CheckDelimiters( _Char separator, _Char delimiter )
+    {
+        if (separator == delimiter) {
+            throw std::invalid_argument( "Separator and delimiter must be different" );
+        }
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Writer of records into a file. Records are collected
+    // in a block and written when block is full, on Flush
+    // and on destruction.
+    //
+
+    template<
+        typename _Type /* Type of records */,
+        typename _Char /* Type of chars */,
+        typename _Traits = std::char_traits<_Char> /* Char traits */,
+        typename _Allocator = std::allocator<_Char> /* Allocator */
+    > class BasicTextFileWriter
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        using writer_t = BasicTextWriter<_Char, _Traits, _Allocator>;
+        using value_t = _Type;
+
+    public:
+        BasicTextFileWriter( const char* path, _Char separator, _Char delimiter = _Char( '\n' ), size_t blockSize = details::_DefaultBlockSize )
+            : m_file()
+            , m_delim( delimiter )
+            , m_blockSize( blockSize )
+            , m_count( 0 )
+            , m_writer( separator )
+        {
+            details::_CheckDelimiters( separator, delimiter );
+
+            m_file = details::_OpenFile( path, "wb" );
+            m_writer.Reserve( m_blockSize );
+        }
+
+        BasicTextFileWriter( const BasicTextFileWriter<_Type, _Char, _Traits, _Allocator>& ) = delete;
+        BasicTextFileWriter& operator=( const BasicTextFileWriter<_Type, _Char, _Traits, _Allocator>& ) = delete;
+
+        BasicTextFileWriter( BasicTextFileWriter<_Type, _Char, _Traits, _Allocator>&& ) = default;
+
+        ~BasicTextFileWriter()
+        {
+            //
+            // Errors can not be reported from destructor,
+            // call Flush explicitly to get them.
+            //
+            try {
+                Flush();
+            }
+            catch (...) { }
+        }
+
+        //
+        // Appends record
+        //
+        void Write( const value_t& obj )
+        {
+            m_writer.Write( obj );
+            m_writer.Put( m_delim );
+
+            ++m_count;
+
+            if (m_writer.Size() >= m_blockSize) {
+                Flush();
+            }
+        }
+
+        //
+        // Writes collected records into file
+        //
+        void Flush()
+        {
+            if (!m_file || !m_writer.Size()) {
+                return;
+            }
+
+            auto written = std::fwrite( m_writer.Data(), sizeof( _Char ), m_writer.Size(), m_file.get() );
+
+            //
+            // Records are dropped even if they are not written:
+            // otherwise they would be written twice on retry.
+            //
+            auto size = m_writer.Size();
+            m_writer.Clear();
+
+            if (written != size) {
+                throw std::runtime_error( "Unable to write file" );
+            }
+        }
+
+        //
+        // Number of written records
+        //
+        size_t Count() const noexcept
+        {
+            return m_count;
+        }
+
+    private:
+
+        //
+        // Output file
+        //
+        details::_FilePtr m_file;
+
+        //
+        // Delimiter of records
+        //
+        _Char m_delim;
+
+        //
+        // Size of block in chars
+        //
+        size_t m_blockSize;
+
+        //
+        // Number of written records
+        //
+        size_t m_count;
+
+        //
+        // Writer, that contains current block
+        //
+        writer_t m_writer;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Reader of records from a file. File is read by blocks,
+    // records are parsed directly from block.
+    //
+
+    template<
+        typename _Type /* Type of records */,
+        typename _Char /* Type of chars */,
+        typename _Traits = std::char_traits<_Char> /* Char traits */
+    > class BasicTextFileReader
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        using reader_t = BasicTextReader<_Char, _Traits>;
+        using buffer_t = std::vector<_Char>;
+        using value_t = _Type;
+
+    public:
+        BasicTextFileReader( const char* path, _Char separator, _Char delimiter = _Char( '\n' ), size_t blockSize = details::_DefaultBlockSize )
+            : m_file()
+            , m_sep( separator )
+            , m_delim( delimiter )
+            , m_isEof( false )
+            , m_offset( 0 )
+            , m_current( 0 )
+            , m_size( 0 )
+            , m_buffer( blockSize ? blockSize : 1 )
+        {
+            details::_CheckDelimiters( separator, delimiter );
+
+            m_file = details::_OpenFile( path, "rb" );
+        }
+
+        BasicTextFileReader( const BasicTextFileReader<_Type, _Char, _Traits>& ) = delete;
+        BasicTextFileReader& operator=( const BasicTextFileReader<_Type, _Char, _Traits>& ) = delete;
+
+        BasicTextFileReader( BasicTextFileReader<_Type, _Char, _Traits>&& ) = default;
+        BasicTextFileReader& operator=( BasicTextFileReader<_Type, _Char, _Traits>&& ) = default;
+
+        //
+        // Reads next record. Returns false if there
+        // are no records anymore.
+        //
+        bool Read( value_t& obj )
+        {
+            const _Char* first;
+            const _Char* last;
+
+            if (!_NextRecord( first, last )) {
+                return false;
+            }
+
+            reader_t reader( first, static_cast<size_t>( last - first ), m_sep );
+            reader.Read( obj );
+
+            return true;
+        }
+
+        //
+        // Offset of next record in file (in chars)
+        //
+        uint64_t Position() const noexcept
+        {
+            return m_offset + m_current;
+        }
+
+        //
+        // Size of file in chars
+        //
+        uint64_t FileSize() const
+        {
+            return details::_FileSize( m_file.get() ) / sizeof( _Char );
+        }
+
+        //
+        // Moves to the first record, that starts at 'offset'
+        // (in chars) or after it. Record starts at the beginning
+        // of file or right after delimiter.
+        //
+        void Seek( uint64_t offset )
+        {
+            //
+            // Char before offset is read too: if it is
+            // delimiter, record starts exactly at offset
+            //
+            uint64_t start = offset ? offset - 1 : 0;
+
+            details::_SeekFile( m_file.get(), start * sizeof( _Char ) );
+
+            m_isEof = false;
+            m_offset = start;
+            m_current = 0;
+            m_size = 0;
+
+            if (offset)
+            {
+                const _Char* first;
+                const _Char* last;
+
+                _NextRecord( first, last );
+            }
+        }
+
+    private:
+
+        //
+        // Finds next record in block. Block is refilled
+        // from file, if it contains no whole record.
+        //
+        bool _NextRecord( const _Char*& first, const _Char*& last )
+        {
+            while (true)
+            {
+                auto begin = m_buffer.data() + m_current;
+                auto end = m_buffer.data() + m_size;
+
+                auto found = details::_FindSeparator( begin, end, m_delim, _Traits{} );
+                if (found != end)
+                {
+                    first = begin;
+                    last = found;
+
+                    m_current = static_cast<size_t>( found - m_buffer.data() ) + 1;
+                    return true;
+                }
+
+                if (m_isEof)
+                {
+                    //
+                    // The last record may be not followed by delimiter
+                    //
+                    if (begin == end) {
+                        return false;
+                    }
+
+                    first = begin;
+                    last = end;
+
+                    m_current = m_size;
+                    return true;
+                }
+
+                _Fill();
+            }
+        }
+
+        //
+        // Moves unread part of block to its beginning and
+        // reads file after it. Block grows only if one
+        // record doesn't fit into it.
+        //
+        void _Fill()
+        {
+            size_t tail = m_size - m_current;
+
+            if (m_current)
+            {
+                _Traits::move( m_buffer.data(), m_buffer.data() + m_current, tail );
+
+                m_offset += m_current;
+                m_current = 0;
+                m_size = tail;
+            }
+
+            if (m_size == m_buffer.size()) {
+                m_buffer.resize( m_buffer.size() * 2 );
+            }
+
+            size_t requested = m_buffer.size() - m_size;
+            size_t read = std::fread( m_buffer.data() + m_size, sizeof( _Char ), requested, m_file.get() );
+
+            if (read != requested)
+            {
+                if (std::ferror( m_file.get() )) {
+                    throw std::runtime_error( "Unable to read file" );
+                }
+
+                m_isEof = true;
+            }
+
+            m_size += read;
+        }
+
+    private:
+
+        //
+        // Input file
+        //
+        details::_FilePtr m_file;
+
+        //
+        // Separator between fields
+        //
+        _Char m_sep;
+
+        //
+        // Delimiter of records
+        //
+        _Char m_delim;
+
+        //
+        // Is whole file read into block?
+        //
+        bool m_isEof;
+
+        //
+        // Offset of block in file (in chars)
+        //
+        uint64_t m_offset;
+
+        //
+        // Position of next record in block
+        //
+        size_t m_current;
+
+        //
+        // Number of chars in block
+        //
+        size_t m_size;
+
+        //
+        // Block of file
+        //
+        buffer_t m_buffer;
+    };
+
+    //
+    // Some aliases for files
+    //
+
+    template<typename _Type>
+    using TextFileWriter = BasicTextFileWriter<_Type, char>;
+
+    template<typename _Type>
+    using WTextFileWriter = BasicTextFileWriter<_Type, wchar_t>;
+
+    template<typename _Type>
+    using TextFileReader = BasicTextFileReader<_Type, char>;
+
+    template<typename _Type>
+    using WTextFileReader = BasicTextFileReader<_Type, wchar_t>;
+
+} // io_text
\ No newline at end of file
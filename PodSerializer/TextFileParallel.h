@@ -0,0 +1,175 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "TextFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+/************************************************************************************
+ * Parallel reading of text files
+ *
+ * The key-concept is following:
+ *  - File is split into chunks of equal size. Each chunk owns records,
+ *    that start inside of it: reader of chunk skips the record, that is
+ *    started in previous chunk, and reads the last record till its end
+ *    even if it goes into the next chunk. So chunks are aligned to
+ *    records without any preliminary pass through the file.
+ *  - Chunks are parsed by several threads with their own files and blocks.
+ *    Threads take chunks one by one, so slow chunks don't stall others.
+ *  - Records of each chunk are stored into separate vector, vectors are
+ *    returned in order of chunks, i.e. records are in order of file.
+ *
+ ************************************************************************************/
+
+
+namespace io_text {
+namespace details {
+
+    //
+    // Default size of chunk in chars
+    //
+    static constexpr uint64_t _DefaultChunkSize = 16 << 20;
+
+    //
+    // Reads records, that start in [first, last)
+    //
+    template<
+        typename _Type /* Type of records */,
+        typename _Char /* Type of chars */,
+        typename _Traits /* Char traits */
+    > void _ReadChunk(
+        const char* path, _Char separator, _Char delimiter,
+        uint64_t first, uint64_t last, std::vector<_Type>& records
+    )
+    {
+        BasicTextFileReader<_Type, _Char, _Traits> reader( path, separator, delimiter );
+        reader.Seek( first );
+
+        _Type record{};
+
+        while (reader.Position() < last && reader.Read( record )) {
+            records.push_back( std::move( record ) );
+        }
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Reads all records of file in parallel. Returns records
+    // of each chunk in separate vector, vectors are in order
+    // of chunks. If 'threadsCount' is zero, number of hardware
+    // threads is used. The first exception thrown by any thread
+    // is rethrown after all threads are finished.
+    //
+
+    template<
+        typename _Type /* Type of records */,
+        typename _Char /* Type of chars */,
+        typename _Traits = std::char_traits<_Char> /* Char traits */
+    > std::vector<std::vector<_Type>> ReadTextFileParallel(
+        const char* path, _Char separator, _Char delimiter = _Char( '\n' ),
+        size_t threadsCount = 0, uint64_t chunkSize = details::_DefaultChunkSize
+    )
+    {
+        REFLECTION_CHECK_TYPE_EXTENDED( _Type );
+
+        if (!chunkSize) {
+            throw std::invalid_argument( "Size of chunk must not be zero" );
+        }
+
+        //
+        // Size is got from the reader itself, so file
+        // and delimiters are checked here as well
+        //
+        uint64_t fileSize = BasicTextFileReader<_Type, _Char, _Traits>( path, separator, delimiter ).FileSize();
+
+        auto chunksCount = static_cast<size_t>( ( fileSize + chunkSize - 1 ) / chunkSize );
+        std::vector<std::vector<_Type>> chunks( chunksCount );
+
+        if (!threadsCount) {
+            threadsCount = (std::max)( std::thread::hardware_concurrency(), 1u );
+        }
+
+        threadsCount = (std::min)( threadsCount, chunksCount );
+
+        std::atomic<size_t> nextChunk{ 0 };
+
+        //
+        // Only the thread, that fails first, stores its exception
+        //
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+
+        auto Worker = [&]()
+        {
+            try
+            {
+                for (size_t chunk = nextChunk++; chunk < chunksCount; chunk = nextChunk++)
+                {
+                    uint64_t first = chunk * chunkSize;
+                    uint64_t last = (std::min)( first + chunkSize, fileSize );
+
+                    details::_ReadChunk<_Type, _Char, _Traits>( path, separator, delimiter, first, last, chunks[chunk] );
+                }
+            }
+            catch (...)
+            {
+                //
+                // Other threads are stopped as soon as possible
+                //
+                nextChunk = chunksCount;
+
+                if (!failed.exchange( true )) {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve( threadsCount );
+
+        try
+        {
+            for (size_t index = 1; index < threadsCount; ++index) {
+                threads.emplace_back( Worker );
+            }
+        }
+        catch (...)
+        {
+            //
+            // Thread can not be created: the rest of
+            // chunks is read by created ones
+            //
+        }
+
+        //
+        // Current thread is one of workers too
+        //
+        if (threadsCount) {
+            Worker();
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (error) {
+            std::rethrow_exception( error );
+        }
+
+        return chunks;
+    }
+
+} // io_text
\ No newline at end of file
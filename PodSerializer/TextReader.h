@@ -0,0 +1,457 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Config.h"
+#include "Support.h"
+#include "Reflection.h"
+#include "StringStream.h"
+#include "TextWriter.h"
+#include "Tuple.h"
+
+#include <cstring>
+#include <cwchar>
+#include <string>
+#include <limits>
+
+
+/************************************************************************************
+ * Text reader
+ *
+ * The key-concept is following:
+ *  - Reader reads text, that is produced by io_operators (or io_text writer)
+ *    with separator set, directly from contiguous range of chars. Nothing is
+ *    copied into temporary streams.
+ *  - Text of each field is found with memchr (wmemchr for wide chars), that
+ *    is vectorized by standard library, and then parsed in place: numbers
+ *    with std::from_chars, strings are assigned at once, nested structures
+ *    are read recursively.
+ *  - Results are the same as ones of io_operators: if text of field can not
+ *    be parsed by fast path (leading spaces, '+' sign, invalid number, etc.),
+ *    it is parsed by standard stream as before.
+ *
+ ************************************************************************************/
+
+
+namespace io_text {
+namespace details {
+
+    /************************************************************************************/
+
+    //
+    // Searches for separator in [first, last) and returns pointer
+    // to it or 'last' if there is no separator in range
+    //
+
+    inline const char* _FindSeparator( const char* first, const char* last, char sep, std::char_traits<char> ) noexcept
+    {
+        auto found = std::memchr( first, static_cast<unsigned char>( sep ), static_cast<size_t>( last - first ) );
+        return found ? static_cast<const char*>( found ) : last;
+    }
+
+    inline const wchar_t* _FindSeparator( const wchar_t* first, const wchar_t* last, wchar_t sep, std::char_traits<wchar_t> ) noexcept
+    {
+        auto found = std::wmemchr( first, sep, static_cast<size_t>( last - first ) );
+        return found ? found : last;
+    }
+
+    template<
+        typename _Char /* Type of chars */,
+        typename _Traits /* Char traits */
+    > const _Char* _FindSeparator( const _Char* first, const _Char* last, _Char sep, _Traits ) noexcept
+    {
+        auto found = _Traits::find( first, static_cast<size_t>( last - first ), sep );
+        return found ? found : last;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Checks if text of a number can be parsed by fast path:
+    // it must start with digit, point or minus followed by
+    // digit or point. Everything else ('+' sign, spaces,
+    // 'inf', etc.) is left to standard stream.
+    //
+    template<
+        typename _Char /* Type of chars */
+    > bool _IsPlainNumber( const _Char* first, const _Char* last ) noexcept
+    {
+        auto IsDigitOrPoint = []( _Char ch ) {
+            return ( ch >= static_cast<_Char>( '0' ) && ch <= static_cast<_Char>( '9' ) ) || ch == static_cast<_Char>( '.' );
+        };
+
+        if (first != last && *first == static_cast<_Char>( '-' )) {
+            ++first;
+        }
+
+        return first != last && IsDigitOrPoint( *first );
+    }
+
+    //
+    // Checks if char is a space in classic locale
+    //
+    template<
+        typename _Char /* Type of chars */
+    > bool _IsSpace( _Char ch ) noexcept
+    {
+        return ch == static_cast<_Char>( ' ' ) || ( ch >= static_cast<_Char>( '\t' ) && ch <= static_cast<_Char>( '\r' ) );
+    }
+
+    //
+    // Copies number into array of narrow chars, because
+    // std::from_chars accepts them only. Returns false if
+    // number is too long.
+    //
+    template<
+        typename _Char /* Type of chars */
+    > bool _NarrowNumber( const _Char* first, const _Char* last, char* buffer ) noexcept
+    {
+        if (last - first >= static_cast<ptrdiff_t>( _MaxNumberLength )) {
+            return false;
+        }
+
+        for (; first != last; ++first)
+        {
+            //
+            // Chars out of ASCII are not parts of number,
+            // so they are replaced with invalid one
+            //
+            *buffer++ = ( *first > static_cast<_Char>( 0 ) && *first < static_cast<_Char>( 0x7f ) )
+                ? static_cast<char>( *first ) : '\x7f';
+        }
+
+        *buffer = '\0';
+        return true;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Parses number from null-terminated 'buffer'.
+    // Returns false if number can not be parsed.
+    //
+
+    template<
+        typename _Type /* Integer type */
+    > bool _ParseInteger( const char* buffer, size_t length, _Type& value ) noexcept
+    {
+#if defined(__POD_SERIALIZER_HAS_TO_CHARS)
+        _Type result;
+
+        auto res = std::from_chars( buffer, buffer + length, result );
+        if (res.ec != std::errc{}) {
+            return false;
+        }
+
+        value = result;
+        return true;
+#else
+        using unsigned_t = typename std::make_unsigned<_Type>::type;
+
+        bool isNegative = *buffer == '-';
+        if (isNegative)
+        {
+            //
+            // Standard stream negates unsigned values,
+            // so they are left to it
+            //
+            if (std::is_unsigned<_Type>::value) {
+                return false;
+            }
+
+            ++buffer;
+        }
+
+        //
+        // Limit of magnitude: for negative numbers
+        // it is greater by one than for positive ones
+        //
+        auto limit = static_cast<unsigned_t>( (std::numeric_limits<_Type>::max)() ) + ( isNegative ? 1 : 0 );
+
+        unsigned_t magnitude = 0;
+        const char* digits = buffer;
+
+        for (; *buffer >= '0' && *buffer <= '9'; ++buffer)
+        {
+            auto digit = static_cast<unsigned_t>( *buffer - '0' );
+
+            if (magnitude > ( limit - digit ) / 10) {
+                return false;
+            }
+
+            magnitude = static_cast<unsigned_t>( magnitude * 10 + digit );
+        }
+
+        if (buffer == digits) {
+            return false;
+        }
+
+        value = static_cast<_Type>( isNegative ? static_cast<unsigned_t>( 0 - magnitude ) : magnitude );
+
+        (void)length;
+        return true;
+#endif // defined(__POD_SERIALIZER_HAS_TO_CHARS)
+    }
+
+    template<
+        typename _Type /* Floating-point type */
+    > bool _ParseFloating( const char* buffer, size_t length, _Type& value ) noexcept
+    {
+#if defined(__POD_SERIALIZER_HAS_TO_CHARS)
+        _Type result;
+
+        auto res = std::from_chars( buffer, buffer + length, result );
+        if (res.ec != std::errc{}) {
+            return false;
+        }
+
+        value = result;
+        return true;
+#else
+        using parse_t = typename std::conditional<
+            std::is_same<_Type, long double>::value, long double, double
+        >::type;
+
+        //
+        // Hexadecimal numbers and values out of range
+        // are left to standard stream
+        //
+        if (std::strpbrk( buffer, "xX" )) {
+            return false;
+        }
+
+        auto result = static_cast<_Type>( _ParseFloat( buffer, parse_t{} ) );
+        if (result == std::numeric_limits<_Type>::infinity() || result == -std::numeric_limits<_Type>::infinity()) {
+            return false;
+        }
+
+        value = result;
+
+        (void)length;
+        return true;
+#endif // defined(__POD_SERIALIZER_HAS_TO_CHARS)
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Reader of text representation of objects.
+    // It doesn't own text, so text must outlive the reader.
+    // Fields are separated with separator, that must be the
+    // same as one used when text was written.
+    //
+
+    template<
+        typename _Char /* Type of chars */,
+        typename _Traits = std::char_traits<_Char> /* Char traits */
+    > class BasicTextReader
+    {
+    public:
+        BasicTextReader( const _Char* data, size_t size, _Char separator ) noexcept
+            : m_first( data )
+            , m_current( data )
+            , m_last( data + size )
+            , m_sep( separator )
+        { }
+
+        //
+        // Reads object starting at current position
+        //
+        template<typename _Type>
+        void Read( _Type& obj )
+        {
+            _ReadValue( obj, details::_ValueTag_t<_Type, _Char>{} );
+        }
+
+        //
+        // Is whole text read?
+        //
+        bool IsEnd() const noexcept
+        {
+            return m_current == m_last;
+        }
+
+        //
+        // Number of chars read
+        //
+        size_t Position() const noexcept
+        {
+            return static_cast<size_t>( m_current - m_first );
+        }
+
+    private:
+
+        //
+        // Returns text of next field and moves current
+        // position past the separator after it
+        //
+        const _Char* _NextField( const _Char*& end ) noexcept
+        {
+            auto begin = m_current;
+
+            end = details::_FindSeparator( m_current, m_last, m_sep, _Traits{} );
+            m_current = ( end == m_last ) ? m_last : end + 1;
+
+            return begin;
+        }
+
+        //
+        // Slow path: field is parsed by standard stream,
+        // exactly as io_operators do it
+        //
+        template<typename _Type>
+        void _ReadFromStream( const _Char* first, const _Char* last, _Type& value )
+        {
+            io_stream::BasicStringStream<_Char, _Traits> buffer;
+            buffer.write( first, static_cast<std::streamsize>( last - first ) );
+
+            buffer >> value;
+        }
+
+        void _ReadValue( bool& value, details::_BoolTag )
+        {
+            const _Char* last;
+            auto first = _NextField( last );
+
+            if (last - first == 1 && ( *first == static_cast<_Char>( '0' ) || *first == static_cast<_Char>( '1' ) )) {
+                value = *first == static_cast<_Char>( '1' );
+            }
+            else {
+                _ReadFromStream( first, last, value );
+            }
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_CharTag )
+        {
+            const _Char* last;
+            auto first = _NextField( last );
+
+            //
+            // Standard stream skips leading spaces and leaves
+            // value unchanged, if there is nothing else
+            //
+            while (first != last && details::_IsSpace( *first )) {
+                ++first;
+            }
+
+            if (first != last) {
+                value = static_cast<_Type>( *first );
+            }
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_IntegerTag )
+        {
+            const _Char* last;
+            auto first = _NextField( last );
+
+            char buffer[details::_MaxNumberLength];
+
+            bool isParsed = details::_IsPlainNumber( first, last )
+                         && details::_NarrowNumber( first, last, buffer )
+                         && details::_ParseInteger( buffer, static_cast<size_t>( last - first ), value );
+
+            if (!isParsed) {
+                _ReadFromStream( first, last, value );
+            }
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_FloatTag )
+        {
+            const _Char* last;
+            auto first = _NextField( last );
+
+            char buffer[details::_MaxNumberLength];
+
+            bool isParsed = details::_IsPlainNumber( first, last )
+                         && details::_NarrowNumber( first, last, buffer )
+                         && details::_ParseFloating( buffer, static_cast<size_t>( last - first ), value );
+
+            if (!isParsed) {
+                _ReadFromStream( first, last, value );
+            }
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_EnumTag )
+        {
+            using actual_t = typename std::underlying_type<_Type>::type;
+
+            actual_t actual{};
+            Read( actual );
+
+            value = static_cast<_Type>( actual );
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_StringTag )
+        {
+            const _Char* last;
+            auto first = _NextField( last );
+
+            value.assign( first, last );
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_StructTag )
+        {
+            using reflection::ToTuplePreciseView;
+
+            auto view = ToTuplePreciseView( value );
+
+            auto ReadField = [this]( auto& /* non-const lvalue */ element ) {
+                this->Read( element );
+            };
+
+            types::for_each( view, ReadField );
+        }
+
+        template<typename _Type>
+        void _ReadValue( _Type& value, details::_OtherTag )
+        {
+            //
+            // Unknown type: it is parsed by its own operator >>
+            //
+            const _Char* last;
+            auto first = _NextField( last );
+
+            _ReadFromStream( first, last, value );
+        }
+
+    private:
+
+        //
+        // Beginning of text
+        //
+        const _Char* m_first;
+
+        //
+        // Current position in text
+        //
+        const _Char* m_current;
+
+        //
+        // End of text
+        //
+        const _Char* m_last;
+
+        //
+        // Separator between fields
+        //
+        _Char m_sep;
+    };
+
+    //
+    // Some aliases for readers
+    //
+
+    using TextReader = BasicTextReader<char>;
+    using WTextReader = BasicTextReader<wchar_t>;
+
+} // io_text
\ No newline at end of file
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Config.h"
+#include "Support.h"
+#include "Reflection.h"
+#include "Tuple.h"
+
+#include <string>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+
+#if ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 ) && defined(__has_include)
+#   if __has_include(<charconv>)
+#       include <charconv>
+#   endif // __has_include(<charconv>)
+#endif // ( __POD_SERIALIZER_LANGUAGE_VERSION >= __POD_SERIALIZER_CXX17 ) && defined(__has_include)
+
+//
+// std::to_chars for all arithmetic types (including floating-point ones)
+//
+#if defined(__cpp_lib_to_chars)
+#   define __POD_SERIALIZER_HAS_TO_CHARS
+#endif // defined(__cpp_lib_to_chars)
+
+
+/************************************************************************************
+ * Text writer
+ *
+ * The key-concept is following:
+ *  - Layout of text is the same as one produced by io_operators, but
+ *    values are formatted directly into a growable array of chars, so no
+ *    locale facets, sentries and iword lookups are involved.
+ *  - Floating-point numbers differ: writer emits the shortest round-trip
+ *    representation, while streams use 6 significant digits by default
+ *    (3.14159265 and 3.14159). Such text is only guaranteed to round-trip
+ *    through io_text reader.
+ *  - Each field is dispatched by its type at compile-time: characters are
+ *    written as is, numbers are formatted with std::to_chars (shortest
+ *    round-trip representation for floating-point numbers), nested
+ *    structures are written recursively.
+ *  - Types, that are not known to writer, are formatted with standard
+ *    stream as a fallback.
+ *
+ ************************************************************************************/
+
+
+namespace io_text {
+namespace details {
+
+    /************************************************************************************/
+
+    //
+    // Tags of value categories
+    //
+
+    struct _BoolTag { };
+    struct _CharTag { };
+    struct _IntegerTag { };
+    struct _FloatTag { };
+    struct _EnumTag { };
+    struct _StringTag { };
+    struct _StructTag { };
+    struct _OtherTag { };
+
+    template<typename _Type, typename _Char>
+    struct _IsString : std::false_type { };
+
+    template<typename _Char, typename _Traits, typename _Allocator>
+    struct _IsString<std::basic_string<_Char, _Traits, _Allocator>, _Char> : std::true_type { };
+
+    //
+    // Types, that standard streams write as characters:
+    // char and stream's char type, and also signed and
+    // unsigned char for narrow streams.
+    //
+    template<typename _Type, typename _Char>
+    using _IsCharacter = traits::disjunction<
+        std::is_same<_Type, char>,
+        std::is_same<_Type, _Char>,
+        traits::conjunction<
+            std::is_same<_Char, char>,
+            traits::disjunction<
+                std::is_same<_Type, signed char>,
+                std::is_same<_Type, unsigned char>
+            >
+        >
+    >;
+
+    //
+    // Returns tag of value category of _Type
+    //
+    template<
+        typename _Type /* Type of value */,
+        typename _Char /* Type of chars written */
+    > using _ValueTag_t =
+        typename std::conditional<std::is_same<_Type, bool>::value, _BoolTag,
+        typename std::conditional<_IsCharacter<_Type, _Char>::value, _CharTag,
+        typename std::conditional<std::is_integral<_Type>::value, _IntegerTag,
+        typename std::conditional<std::is_floating_point<_Type>::value, _FloatTag,
+        typename std::conditional<std::is_enum<_Type>::value, _EnumTag,
+        typename std::conditional<_IsString<_Type, _Char>::value, _StringTag,
+        typename std::conditional<
+            std::is_class<_Type>::value && is_supported_type_extended<_Type>::value, _StructTag,
+            _OtherTag
+        >::type>::type>::type>::type>::type>::type>::type;
+
+    /************************************************************************************/
+
+    //
+    // Maximal length of formatted number
+    //
+    static constexpr size_t _MaxNumberLength = 64;
+
+    //
+    // Formats integer into 'buffer' and returns pointer past the last char
+    //
+    template<
+        typename _Type /* Integer type */
+    > char* _FormatInteger( char* buffer, _Type value ) noexcept
+    {
+#if defined(__POD_SERIALIZER_HAS_TO_CHARS)
+        return std::to_chars( buffer, buffer + _MaxNumberLength, value ).ptr;
+#else
+        using unsigned_t = typename std::make_unsigned<_Type>::type;
+
+        //
+        // Magnitude is calculated in unsigned type,
+        // so minimal negative value is not overflowed.
+        //
+        auto magnitude = static_cast<unsigned_t>( value );
+        if (value < 0)
+        {
+            *buffer++ = '-';
+            magnitude = static_cast<unsigned_t>( 0 - magnitude );
+        }
+
+        char digits[_MaxNumberLength];
+        char* current = digits;
+
+        do
+        {
+            *current++ = static_cast<char>( '0' + magnitude % 10 );
+            magnitude /= 10;
+        }
+        while (magnitude);
+
+        while (current != digits) {
+            *buffer++ = *--current;
+        }
+
+        return buffer;
+#endif // defined(__POD_SERIALIZER_HAS_TO_CHARS)
+    }
+
+#if !defined(__POD_SERIALIZER_HAS_TO_CHARS)
+
+    //
+    // Fallback for floating-point numbers: the least precision,
+    // which is enough to read the same value back, is chosen.
+    //
+
+    inline int _PrintFloat( char* buffer, int precision, double value ) noexcept
+    {
+        return std::snprintf( buffer, _MaxNumberLength, "%.*g", precision, value );
+    }
+
+    inline int _PrintFloat( char* buffer, int precision, long double value ) noexcept
+    {
+        return std::snprintf( buffer, _MaxNumberLength, "%.*Lg", precision, value );
+    }
+
+    inline double _ParseFloat( const char* buffer, double /* tag */ ) noexcept
+    {
+        return std::strtod( buffer, nullptr );
+    }
+
+    inline long double _ParseFloat( const char* buffer, long double /* tag */ ) noexcept
+    {
+        return std::strtold( buffer, nullptr );
+    }
+
+#endif // !defined(__POD_SERIALIZER_HAS_TO_CHARS)
+
+    //
+    // Formats floating-point number into 'buffer' and
+    // returns pointer past the last char
+    //
+    template<
+        typename _Type /* Floating-point type */
+    > char* _FormatFloat( char* buffer, _Type value ) noexcept
+    {
+#if defined(__POD_SERIALIZER_HAS_TO_CHARS)
+        return std::to_chars( buffer, buffer + _MaxNumberLength, value ).ptr;
+#else
+        //
+        // float is printed as double, because it is promoted anyway
+        //
+        using print_t = typename std::conditional<
+            std::is_same<_Type, long double>::value, long double, double
+        >::type;
+
+        int length = 0;
+
+        for (int precision = std::numeric_limits<_Type>::digits10;
+             precision <= std::numeric_limits<_Type>::max_digits10; ++precision)
+        {
+            length = _PrintFloat( buffer, precision, static_cast<print_t>( value ) );
+            if (static_cast<_Type>( _ParseFloat( buffer, print_t{} ) ) == value) {
+                break;
+            }
+        }
+
+        return buffer + length;
+#endif // defined(__POD_SERIALIZER_HAS_TO_CHARS)
+    }
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Writer of text representation of objects.
+    // By default fields are separated with spaces. If separator
+    // is set, it is written between fields instead.
+    //
+
+    template<
+        typename _Char /* Type of chars */,
+        typename _Traits = std::char_traits<_Char> /* Char traits */,
+        typename _Allocator = std::allocator<_Char> /* Allocator */
+    > class BasicTextWriter
+    {
+        using buffer_t = std::basic_string<_Char, _Traits, _Allocator>;
+
+    public:
+        BasicTextWriter() noexcept
+            : m_isSepSet( false )
+            , m_sep( _Char{} )
+            , m_isBeautiful( false )
+        { }
+
+        explicit BasicTextWriter( _Char separator ) noexcept
+            : m_isSepSet( true )
+            , m_sep( separator )
+            , m_isBeautiful( false )
+        { }
+
+        //
+        // The same as io_manipulators::beautiful_struct
+        //
+        void SetBeautiful( bool isBeautiful ) noexcept
+        {
+            m_isBeautiful = isBeautiful;
+        }
+
+        //
+        // Appends text representation of object
+        //
+        template<typename _Type>
+        void Write( const _Type& obj )
+        {
+            _WriteValue( obj, details::_ValueTag_t<_Type, _Char>{} );
+        }
+
+        //
+        // Appends single char as is (e.g. delimiter of records)
+        //
+        void Put( _Char ch )
+        {
+            m_buffer.push_back( ch );
+        }
+
+        void Reserve( size_t size )
+        {
+            m_buffer.reserve( size );
+        }
+
+        void Clear() noexcept
+        {
+            m_buffer.clear();
+        }
+
+        const _Char* Data() const noexcept
+        {
+            return m_buffer.data();
+        }
+
+        size_t Size() const noexcept
+        {
+            return m_buffer.size();
+        }
+
+        const buffer_t& Str() const noexcept
+        {
+            return m_buffer;
+        }
+
+    private:
+        void _WriteChars( const char* first, const char* last )
+        {
+            //
+            // Formatted numbers contain ASCII chars only,
+            // so they can be simply casted to any char type.
+            //
+            for (; first != last; ++first) {
+                m_buffer.push_back( static_cast<_Char>( *first ) );
+            }
+        }
+
+        void _WriteValue( bool value, details::_BoolTag )
+        {
+            m_buffer.push_back( static_cast<_Char>( value ? '1' : '0' ) );
+        }
+
+        template<typename _Type>
+        void _WriteValue( _Type value, details::_CharTag )
+        {
+            m_buffer.push_back( static_cast<_Char>( value ) );
+        }
+
+        template<typename _Type>
+        void _WriteValue( _Type value, details::_IntegerTag )
+        {
+            char buffer[details::_MaxNumberLength];
+            _WriteChars( buffer, details::_FormatInteger( buffer, value ) );
+        }
+
+        template<typename _Type>
+        void _WriteValue( _Type value, details::_FloatTag )
+        {
+            char buffer[details::_MaxNumberLength];
+            _WriteChars( buffer, details::_FormatFloat( buffer, value ) );
+        }
+
+        template<typename _Type>
+        void _WriteValue( _Type value, details::_EnumTag )
+        {
+            using actual_t = typename std::underlying_type<_Type>::type;
+
+            Write( static_cast<actual_t>( value ) );
+        }
+
+        template<typename _Type>
+        void _WriteValue( const _Type& value, details::_StringTag )
+        {
+            m_buffer.append( value.data(), value.size() );
+        }
+
+        template<typename _Type>
+        void _WriteValue( const _Type& value, details::_StructTag )
+        {
+            using reflection::ToTuplePreciseView;
+
+            if (m_isBeautiful) {
+                _WriteChars( "{ ", "{ " + 2 );
+            }
+
+            bool isFirst = true;
+
+            auto WriteField = [this, &isFirst]( const auto& element )
+            {
+                if (!isFirst)
+                {
+                    if (m_isSepSet) {
+                        m_buffer.push_back( m_sep );
+                    }
+                    else if (m_isBeautiful) {
+                        this->_WriteChars( ", ", ", " + 2 );
+                    }
+                    else {
+                        m_buffer.push_back( static_cast<_Char>( ' ' ) );
+                    }
+                }
+
+                isFirst = false;
+                this->Write( element );
+            };
+
+            types::for_each( ToTuplePreciseView( value ), WriteField );
+
+            if (m_isBeautiful) {
+                _WriteChars( " }", " }" + 2 );
+            }
+        }
+
+        template<typename _Type>
+        void _WriteValue( const _Type& value, details::_OtherTag )
+        {
+            //
+            // Unknown type: it is formatted by its own operator <<
+            //
+            std::basic_ostringstream<_Char, _Traits, _Allocator> stream;
+            stream << value;
+
+            m_buffer.append( stream.str() );
+        }
+
+    private:
+
+        //
+        // Is separator set?
+        //
+        bool m_isSepSet;
+
+        //
+        // Separator between fields
+        //
+        _Char m_sep;
+
+        //
+        // Are structures written in braces?
+        //
+        bool m_isBeautiful;
+
+        //
+        // Written text
+        //
+        buffer_t m_buffer;
+    };
+
+    //
+    // Some aliases for writers
+    //
+
+    using TextWriter = BasicTextWriter<char>;
+    using WTextWriter = BasicTextWriter<wchar_t>;
+
+} // io_text
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Support.h"
 #include "Tuple.h"
 #include "GetTypeIds.h"
+#include "Layout.h"
 #include "GetFieldsCount.h"
 
 
@@ -14,6 +15,9 @@
  * The key-concept is following:
  *  - Convert built inside array of ids of types into types back and use them to 
  *    initialize tuple
+ *  - Take each value from structure at offset stored in Layout
+ *  - ToTupleView does the same, but stores references to fields instead of
+ *    their copies, so no values are copied at all
  *    
  ************************************************************************************/
 
@@ -45,8 +49,6 @@ namespace details {
         std::index_sequence<_Idxs...> /* indices */ 
     ) noexcept
     {
-        using types::ArrayToIndices;
-        using types::SizeTArray;
         using types::Tuple;
         using types::get;
 
@@ -63,65 +65,72 @@ namespace details {
             decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )...
         >;
 
-        //
-        // This is the case, when tuple and structure have the same layout.
-        // It is possible when they have equal size, because they contain
-        // the same types in the same order.
-        // Here we can just cast structure to a tuple. ( Black magic }-) )
-        // 
-        #pragma warning(suppress: 4127) // conditional expression is constant
-        if __CONSTEXPR_SINCE_CXX17 (sizeof( tuple_t ) == sizeof( _Type )){
-            auto pObj = static_cast<const void*>( &obj );
-            return *static_cast<const tuple_t*>( pObj );
-        }
-
         //
         // The key-concept of working with nested structs:
-        // - They completely break contiguous aligning of data.
-        // - We can find out a minimal possible offset of each field
-        //   by counting sizes of previous fields.
-        // - If this minimal offset match the property offset % alignof( _Type )
-        //   it is the place, where our data is stored.
-        // - Otherwise we need to find closest largest offset with property above.
+        // - They completely break contiguous aligning of data, so
+        //   we cannot just cast structure to a tuple.
+        // - Layout contains exact offset of each field (including
+        //   fields of nested structures), so we simply read each
+        //   value at its offset.
         // 
 
-        constexpr auto idsRaw = _GetIdsRaw_Impl<_Type>( 
-            std::make_index_sequence<GetFieldsCount<_Type>()>{} 
-        );
+        using layout_t = Layout<_Type>;
 
-        //
-        // Now we need to calculate possible offsets.
-        // Just extract them as indices of non-zero ids.
-        // 
-        constexpr SizeTArray<idsRaw.CountNonZeros()> offsets{ { 0 } };
+        auto src = reinterpret_cast<const char*>( &obj );
 
-        constexpr ArrayToIndices<idsRaw.Size()> transform{
-            const_cast<size_t*>( idsRaw.data ),
-            const_cast<size_t*>( offsets.data )
+        return tuple_t{
+            *reinterpret_cast<const decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )*>( 
+                src + get<_Idxs>( layout_t::offsets ) 
+            )...
         };
-        transform.Run();
+    }
+
+    /************************************************************************************/
+
+    //
+    // Type of element in view: it is const if
+    // viewed object is const.
+    // 
+    template<
+        typename _Object /* Type of viewed object (possibly const) */,
+        typename _Field  /* Type of field */
+    > using _ViewElement_t = typename std::conditional<
+        std::is_const<_Object>::value, const _Field, _Field
+    >::type;
+
+    template<
+        typename  _Object /* Type of object to view as a tuple (possibly const) */,
+        size_t... _Idxs   /* Indices of internal types (with expanded nested structures) */
+    > constexpr auto _ToTupleView_Impl( 
+        _Object& obj /* Object to view as a tuple */, 
+        std::index_sequence<_Idxs...> /* indices */ 
+    ) noexcept
+    {
+        using types::Tuple;
+        using types::get;
+
+        using _Type = typename std::remove_const<_Object>::type;
+
+        constexpr auto ids = GetTypeIds<_Type>();
 
         //
-        // Now it's time to put values into a tuple.
-        // we know here their offsets (actually we 
-        // can correct them a bit later).
+        // The same as in _ToTuple_Impl, but tuple
+        // contains references to fields.
         // 
-        tuple_t tpl;
-        size_t index = 0;
-
-        auto PutAligned = [src = reinterpret_cast<const char*>( &obj ), &index, &offsets]( auto& element ) 
-        {
-            using element_t = typename std::decay<decltype( element )>::type;
 
-            size_t offset = offsets.data[index++];
-            while (offset % alignof( element_t ) != 0) offset++;
+        using tuple_t = Tuple<
+            _ViewElement_t<_Object, decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )>&...
+        >;
 
-            element = *reinterpret_cast<const element_t*>( src + offset );
-        };
+        using layout_t = Layout<_Type>;
 
-        types::for_each( tpl, PutAligned );
+        auto src = reinterpret_cast<_ViewElement_t<_Object, char>*>( &obj );
 
-        return tpl;
+        return tuple_t{
+            *reinterpret_cast<_ViewElement_t<_Object, decltype( _GetTypeById( SizeT<get<_Idxs>( ids )>{} ) )>*>( 
+                src + get<_Idxs>( layout_t::offsets ) 
+            )...
+        };
     }
 
 } // details
@@ -145,6 +154,26 @@ namespace details {
         );
     }
 
+    //
+    // Returns tuple of references to all fields of object
+    // (including fields of nested structures). References
+    // are const if object is const. Object must outlive the view.
+    // 
+
+    template<typename _Type> 
+    constexpr auto ToTupleView( 
+         _Type& obj /* Object to view as a tuple */
+    ) noexcept
+    {
+        using _CleanType = typename std::remove_cv<_Type>::type;
+
+        REFLECTION_CHECK_TYPE( _CleanType );
+
+        return details::_ToTupleView_Impl( 
+            obj, std::make_index_sequence<details::GetTotalFieldsCount<_CleanType>()>{} 
+        );
+    }
+
     template<typename _Type>
     constexpr  /* Maybe it is possible to construct our tuple in compile-time */
     auto ToStandardTuple(
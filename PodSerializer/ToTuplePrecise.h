@@ -12,6 +12,8 @@
  * The key-concept is following:
  *  - The difference between ToTuplePrecise and ToTuple is that the first one
  *    returns exact types without recursive looking inside internal types.
+ *  - ToTuplePreciseView looks at the object as at a tuple in the same way,
+ *    but returns references to fields, so no values are copied.
  *    
  ************************************************************************************/
 
@@ -38,6 +40,40 @@ namespace details {
         return *static_cast<const tuple_t*>( pObj );
     }
 
+    template<
+        typename  _Object /* Type of object to view as a tuple (possibly const) */,
+        size_t... _Idxs   /* Indices of fields */
+    > constexpr auto _ToTuplePreciseView_Impl(
+        _Object& obj /* Object to view as a tuple */,
+        std::index_sequence<_Idxs...> /* indices */
+    ) noexcept
+    {
+        using types::Tuple;
+        using types::get;
+
+        using _Type   = typename std::remove_const<_Object>::type;
+        using tlist_t = decltype( GetTypeList<_Type>() );
+        using tuple_t = decltype( TupleType( std::declval<tlist_t>() ) );
+
+        using container_t = typename std::conditional<
+            std::is_const<_Object>::value, const tuple_t, tuple_t
+        >::type;
+
+        //
+        // Look at the object as at a tuple (see above) and
+        // take references to its elements instead of copying.
+        // get returns const references for const container.
+        // 
+
+        auto& container = *static_cast<container_t*>( 
+            static_cast<typename std::conditional<std::is_const<_Object>::value, const void, void>::type*>( &obj ) 
+        );
+
+        return Tuple<decltype( get<_Idxs>( container ) )...>{ 
+            get<_Idxs>( container )... 
+        };
+    }
+
 } // namespace details
 
                              /* ^^^  Library internals  ^^^ */
@@ -49,13 +85,32 @@ namespace details {
         const _Type& obj /* Object to convert into tuple */
     )
     {
-        using _CleanType = std::remove_cv<_Type>::type;
+        using _CleanType = typename std::remove_cv<_Type>::type;
 
         REFLECTION_CHECK_TYPE_EXTENDED( _CleanType );
 
         return details::_ToTuplePrecise_Impl( obj );
     }
 
+    //
+    // Returns tuple of references to fields of object. References 
+    // are const if object is const. Object must outlive the view.
+    // 
+
+    template<typename _Type> 
+    constexpr auto ToTuplePreciseView(
+        _Type& obj /* Object to view as a tuple */
+    ) noexcept
+    {
+        using _CleanType = typename std::remove_cv<_Type>::type;
+
+        REFLECTION_CHECK_TYPE_EXTENDED( _CleanType );
+
+        return details::_ToTuplePreciseView_Impl( 
+            obj, std::make_index_sequence<GetFieldsCount<_CleanType>()>{} 
+        );
+    }
+
     template<typename _Type>
     constexpr  /* Maybe it is possible to construct our tuple in compile-time */
     auto ToStandardTuplePrecise(
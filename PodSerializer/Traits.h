@@ -50,6 +50,20 @@ namespace traits {
 
     /************************************************************************************/
 
+    //
+    // std::void_t implementation.
+    // Helper structure is used to make unused
+    // parameters participate in SFINAE reliably.
+    // 
+
+    template<typename... /* _Types */>
+    struct make_void { using type = void; };
+
+    template<typename... _Types>
+    using void_t = typename make_void<_Types...>::type;
+
+    /************************************************************************************/
+
     //
     // Is type registered?
     // 
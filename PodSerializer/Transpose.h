@@ -0,0 +1,476 @@
+#pragma once
+
+#include "pch.h"
+
+#include "SizeTArray.h"
+#include "Layout.h"
+#include "Traits.h"
+#include "TypeList.h"
+
+#include <cstring>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#   define __POD_SERIALIZER_SSSE3
+#   include <tmmintrin.h>
+#endif // defined(__SSSE3__) || defined(__AVX__)
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#endif // defined(__AVX2__)
+
+
+/************************************************************************************
+ * Transposition kernels between arrays of structures and columns
+ *
+ * The key-concept is following:
+ *  - Offsets of fields are taken from Layout in compile-time: offset of
+ *    each field is the offset of its first fundamental field (nested
+ *    structures are expanded in Layout).
+ *  - Each field is copied by its own kernel, that is instantiated with
+ *    compile-time offset, size and stride, so compiler generates exact
+ *    loads and stores without any loops over layout at runtime.
+ *  - If SSSE3 is enabled (__SSSE3__, or __AVX__ for MSVC), structures
+ *    of up to 8 bytes are transposed with byte shuffles: 16 bytes of
+ *    structures are loaded at once and fields of all of them are moved
+ *    into the lowest bytes of vector (and back for scatter).
+ *  - If AVX2 is enabled (__AVX2__), fields of 4 and 8 bytes of larger
+ *    structures are loaded from 8 and 4 structures at once with gather
+ *    instructions.
+ *  - Other fields and tails of arrays are copied by scalar kernels, so
+ *    builds without these instruction sets (e.g. default x86-64 builds
+ *    of GCC and MSVC, that have SSE2 only) are scalar. SSE2 shuffles
+ *    work with 2-byte lanes at least, so they can not move fields of
+ *    arbitrary layout. Scatter of larger structures is scalar in all
+ *    builds: there are no scatter instructions before AVX-512.
+ *  - Structures are gathered by blocks, that fit into L1 cache, so each
+ *    structure is read from memory once, not once per field. Columns are
+ *    scattered into structures row by row with the same compile-time
+ *    offsets, so each structure is written at once.
+ *
+ ************************************************************************************/
+
+
+namespace columnar {
+namespace details {
+
+    //
+    // Size of block of structures in bytes
+    //
+    static constexpr size_t _TransposeBlockSize = 16 * 1024;
+
+    /************************************************************************************/
+
+    //
+    // Number of fields in Layout, that field is expanded into
+    //
+
+    template<typename _Field>
+    constexpr size_t _LayoutFieldsCount( std::true_type /* is_registered_or_aliased<_Field> */ ) noexcept
+    {
+        return 1;
+    }
+
+    template<typename _Field>
+    constexpr size_t _LayoutFieldsCount( std::false_type /* is_registered_or_aliased<_Field> */ ) noexcept
+    {
+        return reflection::Layout<_Field>::count;
+    }
+
+    //
+    // Returns offsets of fields of structure, that
+    // have specified types (i.e. fields of GetTypeList)
+    //
+    template<
+        typename    _Type   /* Type of structure */,
+        typename... _Fields /* Types of fields */
+    > constexpr auto _GetFieldOffsets( type_list::TypeList<_Fields...> ) noexcept
+    {
+        constexpr size_t count = sizeof...( _Fields );
+        constexpr size_t layoutCounts[] = { _LayoutFieldsCount<_Fields>( traits::is_registered_or_aliased<_Fields>{} )... };
+
+        types::SizeTArray<count> offsets{ { 0 } };
+
+        for (size_t i = 0, first = 0; i < count; first += layoutCounts[i++]) {
+            offsets.data[i] = reflection::Layout<_Type>::offsets.data[first];
+        }
+
+        return offsets;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Kernel tags: number of bytes moved by one lane of
+    // vector instruction (4 and 8 for gathers, 1 for byte
+    // shuffles) or zero for scalar kernel
+    //
+
+    using _ScalarKernel = std::integral_constant<size_t, 0>;
+    using _ShuffleKernel = std::integral_constant<size_t, 1>;
+
+    //
+    // Structures, that are transposed with byte shuffles:
+    // 16-byte vector holds at least two of them
+    //
+    template<
+        typename _Type /* Type of structure */
+    > using _IsShuffled = std::integral_constant<bool,
+#if defined(__POD_SERIALIZER_SSSE3)
+        sizeof( _Type ) <= 8
+#else
+        false
+#endif // defined(__POD_SERIALIZER_SSSE3)
+    >;
+
+    template<
+        typename _Type  /* Type of structure */,
+        typename _Field /* Type of field */
+    > using _KernelTag_t = std::integral_constant<size_t,
+        _IsShuffled<_Type>::value ? _ShuffleKernel::value :
+#if defined(__AVX2__)
+        /* Indices of gather are 32-bit */
+        ( sizeof( _Type ) * 8 <= 0x7fffffff ) && ( sizeof( _Field ) == 4 || sizeof( _Field ) == 8 )
+            ? sizeof( _Field ) : 0
+#else
+        0
+#endif // defined(__AVX2__)
+    >;
+
+    /************************************************************************************/
+
+#if defined(__POD_SERIALIZER_SSSE3)
+
+    //
+    // Number of structures, which fields are moved by one
+    // shuffle, and number of structures, that are touched by
+    // 16-byte load (the last one may be partially loaded)
+    //
+
+    template<typename _Type>
+    constexpr size_t _ShuffledCount() noexcept
+    {
+        return 16 / sizeof( _Type );
+    }
+
+    template<typename _Type>
+    constexpr size_t _TouchedCount() noexcept
+    {
+        return ( 16 + sizeof( _Type ) - 1 ) / sizeof( _Type );
+    }
+
+    //
+    // Number of vectors of structures, which fields are
+    // combined into one vector by gather kernel
+    //
+    template<
+        typename _Type  /* Type of structure */,
+        typename _Field /* Type of field */
+    > constexpr size_t _CombinedCount() noexcept
+    {
+        return 16 % ( _ShuffledCount<_Type>() * sizeof( _Field ) ) == 0 ? 16 / ( _ShuffledCount<_Type>() * sizeof( _Field ) ) : 1;
+    }
+
+    //
+    // Shuffle masks: gather mask moves field of each structure
+    // of vector into bytes starting with 'position', scatter
+    // mask moves them back from the lowest bytes. Bytes with
+    // high bit set in mask are zeroed.
+    //
+
+    inline __m128i _GatherMask( size_t structSize, size_t offset, size_t fieldSize, size_t position ) noexcept
+    {
+        const size_t bytes = 16 / structSize * fieldSize;
+
+        alignas( 16 ) unsigned char mask[16];
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            size_t j = i - position;
+
+            mask[i] = static_cast<unsigned char>( i >= position && j < bytes ? j / fieldSize * structSize + offset + j % fieldSize : 0x80 );
+        }
+
+        return _mm_load_si128( reinterpret_cast<const __m128i*>( mask ) );
+    }
+
+    inline __m128i _ScatterMask( size_t structSize, size_t offset, size_t fieldSize ) noexcept
+    {
+        const size_t count = 16 / structSize;
+
+        alignas( 16 ) unsigned char mask[16];
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            size_t row = i / structSize;
+            size_t position = i % structSize;
+
+            mask[i] = static_cast<unsigned char>( row < count && position >= offset && position < offset + fieldSize
+                ? row * fieldSize + position - offset : 0x80 );
+        }
+
+        return _mm_load_si128( reinterpret_cast<const __m128i*>( mask ) );
+    }
+
+    //
+    // Loads and stores of the lowest _Size bytes of vector
+    //
+
+    template<size_t _Size>
+    __m128i _LoadBytes( const void* src ) noexcept
+    {
+        __m128i value = _mm_setzero_si128();
+        std::memcpy( &value, src, _Size );
+
+        return value;
+    }
+
+    template<size_t _Size>
+    void _StoreBytes( void* dst, __m128i value ) noexcept
+    {
+        std::memcpy( dst, &value, _Size );
+    }
+
+#endif // defined(__POD_SERIALIZER_SSSE3)
+
+    /************************************************************************************/
+
+    //
+    // Gather kernels: field with offset _Offset of 'count'
+    // structures starting at 'src' is copied into 'dst'
+    //
+
+    template<
+        typename _Type   /* Type of structure */,
+        typename _Field  /* Type of field */,
+        size_t   _Offset /* Offset of field */
+    > void _GatherField( const unsigned char* src, size_t count, _Field* dst, _ScalarKernel ) noexcept
+    {
+        for (size_t i = 0; i < count; ++i, src += sizeof( _Type )) {
+            std::memcpy( dst + i, src + _Offset, sizeof( _Field ) );
+        }
+    }
+
+#if defined(__POD_SERIALIZER_SSSE3)
+
+    template<
+        typename _Type   /* Type of structure */,
+        typename _Field  /* Type of field */,
+        size_t   _Offset /* Offset of field */
+    > void _GatherField( const unsigned char* src, size_t count, _Field* dst, _ShuffleKernel ) noexcept
+    {
+        constexpr size_t shuffled = _ShuffledCount<_Type>();
+        constexpr size_t combined = _CombinedCount<_Type, _Field>();
+
+        //
+        // Fields of several vectors of structures are combined,
+        // so each store fills whole vector, if it is possible
+        //
+        __m128i masks[combined];
+
+        for (size_t j = 0; j < combined; ++j) {
+            masks[j] = _GatherMask( sizeof( _Type ), _Offset, sizeof( _Field ), j * shuffled * sizeof( _Field ) );
+        }
+
+        size_t i = 0;
+
+        //
+        // Vector is loaded only if all its bytes belong to array
+        //
+        for (; i + ( combined - 1 ) * shuffled + _TouchedCount<_Type>() <= count; i += combined * shuffled, src += combined * shuffled * sizeof( _Type ))
+        {
+            __m128i values = _mm_setzero_si128();
+
+            for (size_t j = 0; j < combined; ++j)
+            {
+                __m128i structs = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + j * shuffled * sizeof( _Type ) ) );
+                values = _mm_or_si128( values, _mm_shuffle_epi8( structs, masks[j] ) );
+            }
+
+            _StoreBytes<combined * shuffled * sizeof( _Field )>( dst + i, values );
+        }
+
+        _GatherField<_Type, _Field, _Offset>( src, count - i, dst + i, _ScalarKernel{} );
+    }
+
+#endif // defined(__POD_SERIALIZER_SSSE3)
+
+#if defined(__AVX2__)
+
+    template<
+        typename _Type   /* Type of structure */,
+        typename _Field  /* Type of field */,
+        size_t   _Offset /* Offset of field */
+    > void _GatherField( const unsigned char* src, size_t count, _Field* dst, std::integral_constant<size_t, 4> ) noexcept
+    {
+        constexpr int stride = static_cast<int>( sizeof( _Type ) );
+
+        const __m256i indices = _mm256_setr_epi32(
+            0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride, 6 * stride, 7 * stride
+        );
+
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8, src += 8 * sizeof( _Type ))
+        {
+            __m256i values = _mm256_i32gather_epi32( reinterpret_cast<const int*>( src + _Offset ), indices, 1 );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), values );
+        }
+
+        _GatherField<_Type, _Field, _Offset>( src, count - i, dst + i, _ScalarKernel{} );
+    }
+
+    template<
+        typename _Type   /* Type of structure */,
+        typename _Field  /* Type of field */,
+        size_t   _Offset /* Offset of field */
+    > void _GatherField( const unsigned char* src, size_t count, _Field* dst, std::integral_constant<size_t, 8> ) noexcept
+    {
+        constexpr int stride = static_cast<int>( sizeof( _Type ) );
+
+        const __m128i indices = _mm_setr_epi32( 0, stride, 2 * stride, 3 * stride );
+
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 4 * sizeof( _Type ))
+        {
+            __m256i values = _mm256_i32gather_epi64( reinterpret_cast<const long long*>( src + _Offset ), indices, 1 );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), values );
+        }
+
+        _GatherField<_Type, _Field, _Offset>( src, count - i, dst + i, _ScalarKernel{} );
+    }
+
+#endif // defined(__AVX2__)
+
+    //
+    // Scatter kernel: 'index'-th value of each column is copied
+    // into fields of structure at 'dst'. Structures are filled
+    // one by one: each one is written with all its fields at once.
+    //
+    template<
+        typename  _Type     /* Type of structure */,
+        typename  _TypeList /* Types of fields */,
+        size_t... _Idxs     /* Indices of fields */
+    > void _ScatterFields( const void* const* columns, size_t index, unsigned char* dst, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        constexpr auto offsets = _GetFieldOffsets<_Type>( _TypeList{} );
+
+        int dummy[] = { 0, (
+            std::memcpy(
+                dst + offsets.data[_Idxs],
+                static_cast<const typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type*>( columns[_Idxs] ) + index,
+                sizeof( typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type )
+            ), 0
+        )... };
+
+        (void)dummy;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Transposes 'count' structures into columns, that already
+    // have room for them. Fields are listed in _TypeList.
+    //
+
+    template<
+        typename  _Type     /* Type of structure */,
+        typename  _TypeList /* Types of fields */,
+        size_t... _Idxs     /* Indices of fields */
+    > void _Gather( const _Type* src, size_t count, void* const* columns, std::index_sequence<_Idxs...> /* indices */ ) noexcept
+    {
+        constexpr auto offsets = _GetFieldOffsets<_Type>( _TypeList{} );
+        constexpr size_t blockCount = sizeof( _Type ) < _TransposeBlockSize ? _TransposeBlockSize / sizeof( _Type ) : 1;
+
+        for (size_t first = 0; first < count; first += blockCount)
+        {
+            size_t current = count - first < blockCount ? count - first : blockCount;
+            auto block = reinterpret_cast<const unsigned char*>( src + first );
+
+            int dummy[] = { 0, (
+                _GatherField<_Type, typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type, offsets.data[_Idxs]>(
+                    block, current,
+                    static_cast<typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type*>( columns[_Idxs] ) + first,
+                    _KernelTag_t<_Type, typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type>{}
+                ), 0
+            )... };
+
+            (void)dummy;
+        }
+    }
+
+    //
+    // Transposes 'count' values of each column into structures
+    //
+
+    template<
+        typename  _Type     /* Type of structure */,
+        typename  _TypeList /* Types of fields */,
+        size_t... _Idxs     /* Indices of fields */
+    > void _ScatterRows( const void* const* columns, size_t first, size_t count, unsigned char* dst, std::index_sequence<_Idxs...> indices, std::false_type /* _IsShuffled<_Type> */ ) noexcept
+    {
+        for (size_t i = first; i < count; ++i, dst += sizeof( _Type )) {
+            _ScatterFields<_Type, _TypeList>( columns, i, dst, indices );
+        }
+    }
+
+#if defined(__POD_SERIALIZER_SSSE3)
+
+    //
+    // Values of all columns are shuffled into 16 bytes of
+    // structures and combined. Padding bytes are zeroed.
+    //
+    template<
+        typename  _Type     /* Type of structure */,
+        typename  _TypeList /* Types of fields */,
+        size_t... _Idxs     /* Indices of fields */
+    > void _ScatterRows( const void* const* columns, size_t first, size_t count, unsigned char* dst, std::index_sequence<_Idxs...> indices, std::true_type /* _IsShuffled<_Type> */ ) noexcept
+    {
+        constexpr auto offsets = _GetFieldOffsets<_Type>( _TypeList{} );
+        constexpr size_t shuffled = _ShuffledCount<_Type>();
+
+        const __m128i masks[] = {
+            _ScatterMask( sizeof( _Type ), offsets.data[_Idxs], sizeof( typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type ) )...
+        };
+
+        size_t i = first;
+
+        //
+        // Bytes after the last shuffled structure are zeroed,
+        // but they are overwritten by the next iteration or
+        // by scalar kernel
+        //
+        for (; i + _TouchedCount<_Type>() <= count; i += shuffled, dst += shuffled * sizeof( _Type ))
+        {
+            __m128i values = _mm_setzero_si128();
+
+            int dummy[] = { 0, (
+                values = _mm_or_si128( values, _mm_shuffle_epi8(
+                    _LoadBytes<shuffled * sizeof( typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type )>(
+                        static_cast<const typename decltype( type_list::get<_Idxs>( _TypeList{} ) )::type*>( columns[_Idxs] ) + i
+                    ),
+                    masks[_Idxs]
+                ) ), 0
+            )... };
+
+            (void)dummy;
+
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), values );
+        }
+
+        _ScatterRows<_Type, _TypeList>( columns, i, count, dst, indices, std::false_type{} );
+    }
+
+#endif // defined(__POD_SERIALIZER_SSSE3)
+
+    template<
+        typename  _Type     /* Type of structure */,
+        typename  _TypeList /* Types of fields */,
+        size_t... _Idxs     /* Indices of fields */
+    > void _Scatter( const void* const* columns, size_t count, _Type* dst, std::index_sequence<_Idxs...> indices ) noexcept
+    {
+        _ScatterRows<_Type, _TypeList>( columns, 0, count, reinterpret_cast<unsigned char*>( dst ), indices, _IsShuffled<_Type>{} );
+    }
+
+} // details
+} // columnar
\ No newline at end of file
@@ -20,11 +20,11 @@ namespace types {
     // 
     template<typename...> struct Tuple;
 
-namespace {
+namespace details {
 
     //
     // Internal implementation.
-    // Tuple and get are listed after this anonymous namespace.
+    // Tuple and get are listed after this namespace.
     // 
 
     /************************************************************************************/
@@ -129,7 +129,11 @@ namespace {
     template<size_t _Idx, typename _Type> 
     constexpr _Type&& _get_Impl( _ValueContainer<_Idx, _Type>&& container ) noexcept
     {
-        return container.value;
+        //
+        // 'container' is an lvalue here, so value must be
+        // casted back to rvalue to be moved from.
+        // 
+        return std::forward<_Type>( container.value );
     }
 
     /************************************************************************************/
@@ -159,7 +163,7 @@ namespace {
     // For some description see 'lvalue reference' above.
     // 
     template<size_t... _Idxs, typename... _Types>
-    constexpr decltype(auto) _ToStdTuple_Impl( const Tuple<_Types...>& tpl )
+    constexpr decltype(auto) _ToStdTuple_Impl( const Tuple<_Types...>& tpl, std::index_sequence<_Idxs...> /* indices */ )
     {
         return std::make_tuple( _get_Impl<_Idxs>( tpl )... );
     }
@@ -169,7 +173,7 @@ namespace {
     // For some description see 'lvalue reference' above.
     // 
     template<size_t... _Idxs, typename... _Types>
-    constexpr decltype(auto) _ToStdTuple_Impl( volatile Tuple<_Types...>& tpl )
+    constexpr decltype(auto) _ToStdTuple_Impl( volatile Tuple<_Types...>& tpl, std::index_sequence<_Idxs...> /* indices */ )
     {
         return std::make_tuple( _get_Impl<_Idxs>( tpl )... );
     }
@@ -179,7 +183,7 @@ namespace {
     // For some description see 'lvalue reference' above.
     // 
     template<size_t... _Idxs, typename... _Types>
-    constexpr decltype(auto) _ToStdTuple_Impl( const volatile Tuple<_Types...>& tpl )
+    constexpr decltype(auto) _ToStdTuple_Impl( const volatile Tuple<_Types...>& tpl, std::index_sequence<_Idxs...> /* indices */ )
     {
         return std::make_tuple( _get_Impl<_Idxs>( tpl )... );
     }
@@ -189,14 +193,18 @@ namespace {
     // For some description see 'lvalue reference' above.
     // 
     template<size_t... _Idxs, typename... _Types>
-    constexpr decltype(auto) _ToStdTuple_Impl( Tuple<_Types...>&& tpl )
+    constexpr decltype(auto) _ToStdTuple_Impl( Tuple<_Types...>&& tpl, std::index_sequence<_Idxs...> /* indices */ )
     {
+        //
+        // Each element is moved into std::tuple. Tuple is forwarded
+        // several times, but each time different element is taken.
+        // 
         return std::make_tuple( 
             _get_Impl<_Idxs>( std::forward<Tuple<_Types...>>( tpl ) )... 
         );
     }
 
-} // anonymous namespace
+} // details
 
     /************************************************************************************/
 
@@ -205,12 +213,12 @@ namespace {
     // 
     template<typename... _Types>
     struct Tuple
-        : _Tuple_Impl<
+        : details::_Tuple_Impl<
             std::make_index_sequence<sizeof...( _Types )>, 
             _Types...
         >
     {
-        using _Tuple_Impl<
+        using details::_Tuple_Impl<
             std::make_index_sequence<sizeof...(_Types)>,
             _Types...
         >::_Tuple_Impl;
@@ -233,8 +241,8 @@ namespace {
     >
     constexpr decltype(auto) get( Tuple<_Types...>& tpl ) noexcept
     {
-        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in " __FUNCTION__ );
-        return _get_Impl<_Idx>( tpl );
+        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in get" );
+        return details::_get_Impl<_Idx>( tpl );
     }
 
     //
@@ -244,8 +252,8 @@ namespace {
     template<size_t _Idx, typename... _Types>
     constexpr decltype(auto) get( const Tuple<_Types...>& tpl ) noexcept
     {
-        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in " __FUNCTION__ );
-        return _get_Impl<_Idx>( tpl );
+        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in get" );
+        return details::_get_Impl<_Idx>( tpl );
     }
 
     //
@@ -255,8 +263,8 @@ namespace {
     template<size_t _Idx, typename... _Types>
     constexpr decltype(auto) get( volatile Tuple<_Types...>& tpl ) noexcept
     {
-        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in " __FUNCTION__ );
-        return _get_Impl<_Idx>( tpl );
+        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in get" );
+        return details::_get_Impl<_Idx>( tpl );
     }
 
     //
@@ -266,8 +274,8 @@ namespace {
     template<size_t _Idx, typename... _Types>
     constexpr decltype(auto) get( const volatile Tuple<_Types...>& tpl ) noexcept
     {
-        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in " __FUNCTION__ );
-        return _get_Impl<_Idx>( tpl );
+        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in get" );
+        return details::_get_Impl<_Idx>( tpl );
     }
 
     //
@@ -277,8 +285,8 @@ namespace {
     template<size_t _Idx, typename... _Types>
     constexpr decltype(auto) get( Tuple<_Types...>&& tpl ) noexcept
     {
-        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in " __FUNCTION__ );
-        return _get_Impl<_Idx>( 
+        static_assert( _Idx < Tuple<_Types...>::size, "Out of range in get" );
+        return details::_get_Impl<_Idx>( 
             std::forward<Tuple<_Types...>>( tpl ) 
         );
     }
@@ -415,7 +423,7 @@ namespace {
         Tuple<_Types...>& tpl /* Tuple to convert into std::tuple */
     )
     {
-        return _ToStdTuple_Impl( 
+        return details::_ToStdTuple_Impl( 
             tpl, std::make_index_sequence<sizeof...( _Types )>{} 
         );
     }
@@ -427,7 +435,7 @@ namespace {
     template<typename... _Types>
     constexpr decltype(auto) ToStdTuple( const Tuple<_Types...>& tpl )
     {
-        return _ToStdTuple_Impl( 
+        return details::_ToStdTuple_Impl( 
             tpl, std::make_index_sequence<sizeof...( _Types )>{} 
         );
     }
@@ -439,7 +447,7 @@ namespace {
     template<typename... _Types>
     constexpr decltype(auto) ToStdTuple( volatile Tuple<_Types...>& tpl )
     {
-        return _ToStdTuple_Impl( 
+        return details::_ToStdTuple_Impl( 
             tpl, std::make_index_sequence<sizeof...( _Types )>{} 
         );
     }
@@ -451,7 +459,7 @@ namespace {
     template<typename... _Types>
     constexpr decltype(auto) ToStdTuple( const volatile Tuple<_Types...>& tpl )
     {
-        return _ToStdTuple_Impl( 
+        return details::_ToStdTuple_Impl( 
             tpl, std::make_index_sequence<sizeof...( _Types )>{} 
         );
     }
@@ -463,7 +471,7 @@ namespace {
     template<typename... _Types>
     constexpr decltype(auto) ToStdTuple( Tuple<_Types...>&& tpl )
     {
-        return _ToStdTuple_Impl( 
+        return details::_ToStdTuple_Impl( 
             std::forward<Tuple<_Types...>>( tpl ), 
             std::make_index_sequence<sizeof...( _Types )>{} 
         );
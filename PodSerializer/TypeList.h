@@ -72,7 +72,7 @@ namespace {
         //
         // Check if index is valid
         // 
-        static_assert( _Idx < Size( tl ), "Out of range in " __FUNCTION__ );
+        static_assert( _Idx < Size( tl ), "Out of range in get" );
 
         return Identity<
             decltype( _get_Impl_T<std::make_index_sequence<_Idx>>::dummy( (_Types*)nullptr... ) )
@@ -0,0 +1,580 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Support.h"
+#include "Layout.h"
+#include "Buffers.h"
+#include "MappedRecordFile.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE4_2__) || defined(__AVX__)
+#   include <nmmintrin.h>
+#endif // defined(__SSE4_2__) || defined(__AVX__)
+
+#if defined(_WIN32)
+#   include <Windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif // defined(_WIN32)
+
+
+/************************************************************************************
+ * Write-ahead logs
+ *
+ * The key-concept is following:
+ *  - Log is a file of frames. Each frame contains 4-byte length of record,
+ *    4-byte CRC-32C of length and record and the record itself in the same
+ *    format as BinaryBuffer stores it.
+ *  - Append returns only when record is on disk. Records appended from
+ *    many threads are committed by groups: one of waiting threads writes
+ *    all collected frames with a single write call and a single fdatasync
+ *    (FlushFileBuffers on Windows), while others append new frames into
+ *    the next group. So number of syncs doesn't grow with number of
+ *    writers, and durable throughput is limited by disk bandwidth rather
+ *    than by latency of sync.
+ *  - Reader stops at the first frame, that is incomplete or damaged (torn
+ *    tail after crash). Writer drops such a tail on open, so new records
+ *    follow the last valid one.
+ *  - If write or sync fails, log is not used anymore: state of file
+ *    is unknown, so all appends throw.
+ *
+ ************************************************************************************/
+
+
+namespace serialization {
+namespace details {
+
+    //
+    // Header of frame: length and checksum
+    //
+    static constexpr size_t _FrameHeaderSize = 2 * sizeof( uint32_t );
+
+    /************************************************************************************/
+
+    //
+    // CRC-32C (Castagnoli). SSE 4.2 has an instruction
+    // for it, table is used otherwise.
+    //
+
+    inline const uint32_t* _Crc32cTable() noexcept
+    {
+        struct _Table
+        {
+            _Table() noexcept
+            {
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t crc = i;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        crc = ( crc >> 1 ) ^ ( ( crc & 1 ) ? 0x82F63B78u : 0 );
+                    }
+
+                    data[i] = crc;
+                }
+            }
+
+            uint32_t data[256];
+        };
+
+        static const _Table table;
+        return table.data;
+    }
+
+    inline uint32_t _Crc32c( const unsigned char* data, size_t size, uint32_t crc = 0 ) noexcept
+    {
+        crc = ~crc;
+
+#if defined(__SSE4_2__) || defined(__AVX__)
+#   if defined(_M_X64) || defined(__x86_64__)
+        for (; size >= sizeof( uint64_t ); size -= sizeof( uint64_t ), data += sizeof( uint64_t ))
+        {
+            uint64_t word;
+            std::memcpy( &word, data, sizeof( word ) );
+
+            crc = static_cast<uint32_t>( _mm_crc32_u64( crc, word ) );
+        }
+#   endif // defined(_M_X64) || defined(__x86_64__)
+
+        for (; size; --size, ++data) {
+            crc = _mm_crc32_u8( crc, *data );
+        }
+#else
+        auto table = _Crc32cTable();
+
+        for (; size; --size, ++data) {
+            crc = table[( crc ^ *data ) & 0xFF] ^ ( crc >> 8 );
+        }
+#endif // defined(__SSE4_2__) || defined(__AVX__)
+
+        return ~crc;
+    }
+
+    /************************************************************************************/
+
+    //
+    // Appends frame with serialized object to buffer
+    //
+    template<typename _Type>
+    void _AppendFrame( const _Type& obj, std::vector<unsigned char>& buffer )
+    {
+        constexpr auto recordSize = static_cast<uint32_t>( reflection::Layout<_Type>::packedSize );
+
+        size_t offset = buffer.size();
+        buffer.resize( offset + _FrameHeaderSize + recordSize );
+
+        auto frame = buffer.data() + offset;
+
+        std::memcpy( frame, &recordSize, sizeof( recordSize ) );
+        SaveBinary( obj, frame + _FrameHeaderSize );
+
+        uint32_t crc = _Crc32c( frame, sizeof( recordSize ) );
+        crc = _Crc32c( frame + _FrameHeaderSize, recordSize, crc );
+
+        std::memcpy( frame + sizeof( recordSize ), &crc, sizeof( crc ) );
+    }
+
+    //
+    // Checks frame at the beginning of [data, data + size).
+    // Returns pointer to record or nullptr, if frame is
+    // incomplete or damaged.
+    //
+    template<typename _Type>
+    const unsigned char* _CheckFrame( const unsigned char* data, uint64_t size ) noexcept
+    {
+        constexpr auto recordSize = static_cast<uint32_t>( reflection::Layout<_Type>::packedSize );
+
+        if (size < _FrameHeaderSize + recordSize) {
+            return nullptr;
+        }
+
+        uint32_t length;
+        uint32_t expected;
+
+        std::memcpy( &length, data, sizeof( length ) );
+        std::memcpy( &expected, data + sizeof( length ), sizeof( expected ) );
+
+        if (length != recordSize) {
+            return nullptr;
+        }
+
+        uint32_t crc = _Crc32c( data, sizeof( length ) );
+        crc = _Crc32c( data + _FrameHeaderSize, recordSize, crc );
+
+        return crc == expected ? data + _FrameHeaderSize : nullptr;
+    }
+
+    /************************************************************************************/
+
+    //
+    // File, that is written only at its end
+    //
+
+    class _LogFile
+    {
+    public:
+        explicit _LogFile( const char* path )
+        {
+#if defined(_WIN32)
+            m_file = CreateFileA( path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+            if (m_file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error( "Unable to open file" );
+            }
+#else
+            m_file = open( path, O_RDWR | O_CREAT | O_APPEND, 0644 );
+            if (m_file == -1) {
+                throw std::runtime_error( "Unable to open file" );
+            }
+#endif // defined(_WIN32)
+        }
+
+        _LogFile( const _LogFile& ) = delete;
+        _LogFile& operator=( const _LogFile& ) = delete;
+
+        ~_LogFile()
+        {
+#if defined(_WIN32)
+            CloseHandle( m_file );
+#else
+            close( m_file );
+#endif // defined(_WIN32)
+        }
+
+        void Write( const unsigned char* data, size_t size )
+        {
+            while (size)
+            {
+#if defined(_WIN32)
+                DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>( size );
+                DWORD written = 0;
+
+                if (!WriteFile( m_file, data, chunk, &written, nullptr )) {
+                    throw std::runtime_error( "Unable to write file" );
+                }
+#else
+                auto written = write( m_file, data, size );
+
+                if (written < 0)
+                {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    throw std::runtime_error( "Unable to write file" );
+                }
+#endif // defined(_WIN32)
+
+                data += written;
+                size -= static_cast<size_t>( written );
+            }
+        }
+
+        //
+        // Waits until written data is on disk
+        //
+        void Sync()
+        {
+#if defined(_WIN32)
+            bool synced = FlushFileBuffers( m_file ) != 0;
+#elif defined(__APPLE__)
+            bool synced = fsync( m_file ) == 0;
+#else
+            bool synced = fdatasync( m_file ) == 0;
+#endif // defined(_WIN32)
+
+            if (!synced) {
+                throw std::runtime_error( "Unable to flush file" );
+            }
+        }
+
+        //
+        // Drops everything after 'size' bytes. Next
+        // write goes to the new end of file.
+        //
+        void Truncate( uint64_t size )
+        {
+#if defined(_WIN32)
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>( size );
+
+            bool truncated = SetFilePointerEx( m_file, offset, nullptr, FILE_BEGIN ) && SetEndOfFile( m_file );
+#else
+            bool truncated = ftruncate( m_file, static_cast<off_t>( size ) ) == 0;
+#endif // defined(_WIN32)
+
+            if (!truncated) {
+                throw std::runtime_error( "Unable to resize file" );
+            }
+        }
+
+    private:
+#if defined(_WIN32)
+        HANDLE m_file;
+#else
+        int m_file;
+#endif // defined(_WIN32)
+    };
+
+} // details
+
+                             /* ^^^  Library internals  ^^^ */
+    /************************************************************************************/
+                             /* vvv       User API      vvv */
+
+    //
+    // Reader of log. Records are decoded right from
+    // mapping of file. Reading stops at the end of
+    // file or at the first damaged frame.
+    //
+
+    template<
+        typename _Type /* Type of records */
+    > class WriteAheadLogReader
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        using value_t = _Type;
+
+    public:
+        explicit WriteAheadLogReader( const char* path )
+            : m_mapping( path, mapped_read_only )
+            , m_offset( 0 )
+            , m_count( 0 )
+        { }
+
+        WriteAheadLogReader( const WriteAheadLogReader<_Type>& ) = delete;
+        WriteAheadLogReader& operator=( const WriteAheadLogReader<_Type>& ) = delete;
+
+        WriteAheadLogReader( WriteAheadLogReader<_Type>&& ) = default;
+
+        //
+        // Reads next record. Returns false if there
+        // are no valid records anymore.
+        //
+        bool Read( value_t& obj )
+        {
+            auto record = details::_CheckFrame<value_t>( m_mapping.Data() + m_offset, m_mapping.Size() - m_offset );
+
+            if (!record) {
+                return false;
+            }
+
+            details::LoadBinary( obj, record );
+
+            m_offset += details::_FrameHeaderSize + reflection::Layout<value_t>::packedSize;
+            ++m_count;
+
+            return true;
+        }
+
+        //
+        // Did reading stop before the end of file?
+        // Bytes after Position() are torn tail then.
+        //
+        bool IsTorn() const noexcept
+        {
+            return m_offset < m_mapping.Size() && !details::_CheckFrame<value_t>( m_mapping.Data() + m_offset, m_mapping.Size() - m_offset );
+        }
+
+        //
+        // Offset of next frame in file
+        //
+        uint64_t Position() const noexcept
+        {
+            return m_offset;
+        }
+
+        //
+        // Number of read records
+        //
+        size_t Count() const noexcept
+        {
+            return m_count;
+        }
+
+    private:
+
+        //
+        // Mapping of log
+        //
+        details::_FileMapping m_mapping;
+
+        //
+        // Offset of next frame
+        //
+        uint64_t m_offset;
+
+        //
+        // Number of read records
+        //
+        size_t m_count;
+    };
+
+    /************************************************************************************/
+
+    //
+    // Append-only log of records. Append can be called from
+    // many threads, concurrent appends are committed together.
+    //
+
+    template<
+        typename _Type /* Type of records */
+    > class WriteAheadLog
+    {
+        REFLECTION_CHECK_TYPE( _Type );
+
+        using value_t = _Type;
+        using buffer_t = std::vector<unsigned char>;
+
+    public:
+        explicit WriteAheadLog( const char* path )
+            : m_file( path )
+            , m_mutex()
+            , m_committed()
+            , m_pending()
+            , m_writing()
+            , m_isCommitting( false )
+            , m_isFailed( false )
+            , m_count( 0 )
+            , m_durable( 0 )
+            , m_commits( 0 )
+        {
+            //
+            // Torn tail is dropped, valid records are kept
+            //
+            uint64_t size = 0;
+
+            {
+                WriteAheadLogReader<value_t> reader( path );
+
+                value_t obj;
+                while (reader.Read( obj )) { }
+
+                size = reader.Position();
+                m_count = reader.Count();
+            }
+
+            m_file.Truncate( size );
+            m_durable = m_count;
+        }
+
+        WriteAheadLog( const WriteAheadLog<_Type>& ) = delete;
+        WriteAheadLog& operator=( const WriteAheadLog<_Type>& ) = delete;
+
+        //
+        // Appends record and waits until it is on disk.
+        // Returns index of record in log.
+        //
+        size_t Append( const value_t& obj )
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+
+            _CheckFailed();
+
+            details::_AppendFrame( obj, m_pending );
+            size_t index = m_count++;
+
+            while (m_durable <= index)
+            {
+                _CheckFailed();
+
+                if (m_isCommitting) {
+                    m_committed.wait( lock );
+                }
+                else {
+                    _Commit( lock );
+                }
+            }
+
+            return index;
+        }
+
+        //
+        // Number of records in log
+        //
+        size_t Count() const
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            return m_count;
+        }
+
+        //
+        // Number of groups written (and synced) so far
+        //
+        size_t CommitsCount() const
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            return m_commits;
+        }
+
+    private:
+
+        //
+        // Writes all pending frames. Lock is released while
+        // file is written, so new frames are collected into
+        // the next group meanwhile.
+        //
+        void _Commit( std::unique_lock<std::mutex>& lock )
+        {
+            m_isCommitting = true;
+            m_pending.swap( m_writing );
+
+            size_t count = m_count;
+            bool isWritten = true;
+
+            lock.unlock();
+
+            try
+            {
+                m_file.Write( m_writing.data(), m_writing.size() );
+                m_file.Sync();
+            }
+            catch (...) {
+                isWritten = false;
+            }
+
+            m_writing.clear();
+
+            lock.lock();
+
+            if (isWritten)
+            {
+                m_durable = count;
+                ++m_commits;
+            }
+            else {
+                m_isFailed = true;
+            }
+
+            m_isCommitting = false;
+            m_committed.notify_all();
+        }
+
+        void _CheckFailed() const
+        {
+            if (m_isFailed) {
+                throw std::runtime_error( "Unable to write log" );
+            }
+        }
+
+    private:
+
+        //
+        // Output file
+        //
+        details::_LogFile m_file;
+
+        //
+        // Guards all members below
+        //
+        mutable std::mutex m_mutex;
+
+        //
+        // Signaled after each commit
+        //
+        std::condition_variable m_committed;
+
+        //
+        // Frames of the next group
+        //
+        buffer_t m_pending;
+
+        //
+        // Frames, that are being written now
+        //
+        buffer_t m_writing;
+
+        //
+        // Is some thread writing a group?
+        //
+        bool m_isCommitting;
+
+        //
+        // Did write or sync fail?
+        //
+        bool m_isFailed;
+
+        //
+        // Number of records in log
+        //
+        size_t m_count;
+
+        //
+        // Number of records on disk
+        //
+        size_t m_durable;
+
+        //
+        // Number of written groups
+        //
+        size_t m_commits;
+    };
+
+} // serialization
\ No newline at end of file
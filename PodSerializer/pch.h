@@ -7,4 +7,7 @@
 #include <vector>
 #include <stdexcept>
 #include <tuple>
-#include <iomanip>
\ No newline at end of file
+#include <iomanip>
+#include <iterator>
+#include <cstdint>
+#include <new>
\ No newline at end of file
@@ -0,0 +1,57 @@
+//
+// AllocationCounter.cpp
+// Replacement of global operator new, that counts allocations.
+//
+
+#include "pch.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+    //
+    // Number of calls to operator new
+    //
+    std::atomic<size_t> g_allocations{ 0 };
+
+} // anonymous namespace
+
+
+namespace allocation_counter {
+
+    size_t GetAllocationsCount() noexcept
+    {
+        return g_allocations.load( std::memory_order_relaxed );
+    }
+
+} // allocation_counter
+
+
+//
+// Array and nothrow forms of operator new call this one
+// by default, so it is enough to replace only it.
+//
+
+void* operator new( size_t size )
+{
+    g_allocations.fetch_add( 1, std::memory_order_relaxed );
+
+    if (void* ptr = std::malloc( size ? size : 1 )) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+    std::free( ptr );
+}
\ No newline at end of file
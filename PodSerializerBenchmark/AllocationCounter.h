@@ -0,0 +1,33 @@
+//
+// AllocationCounter.h
+// Counts heap allocations made through global operator new.
+//
+
+#pragma once
+
+#include "benchmark/benchmark.h"
+
+#include <cstddef>
+
+
+namespace allocation_counter {
+
+    //
+    // Returns number of calls to global operator new
+    // since start of the program
+    //
+    size_t GetAllocationsCount() noexcept;
+
+    //
+    // Adds 'allocs/op' counter to benchmark. 'before' is a value
+    // returned by GetAllocationsCount before benchmark loop.
+    //
+    inline void ReportAllocations( benchmark::State& state, size_t before )
+    {
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>( GetAllocationsCount() - before ),
+            benchmark::Counter::kAvgIterations
+        );
+    }
+
+} // allocation_counter
\ No newline at end of file
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+#
+# compile_time.py
+# Compile-time benchmark of reflection.
+#
+# For each size a translation unit with generated structure of this size is
+# compiled, and compilation time and peak memory of compiler are recorded.
+# Results are printed and written into CSV file.
+#
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+
+#
+# Shapes of generated structures:
+#  - chars: only char fields, i.e. the biggest possible amount of fields
+#  - mixed: fields of different sizes with padding between them
+#
+MIXED_FIELDS = [ ('char', 1), ('int', 4), ('short', 2), ('double', 8) ]
+
+
+def generate_fields(shape, size):
+    if shape == 'chars':
+        return [ 'char' ] * size
+
+    fields = []
+    total = 0
+    while total < size:
+        name, field_size = MIXED_FIELDS[len(fields) % len(MIXED_FIELDS)]
+        fields.append(name)
+        total += field_size
+
+    return fields
+
+
+def generate_source(shape, size):
+    fields = generate_fields(shape, size)
+
+    lines = [
+        '#include "Reflection.h"',
+        '',
+        'struct Generated',
+        '{',
+    ]
+    lines += [ '    {} field{};'.format(field, idx) for idx, field in enumerate(fields) ]
+    lines += [
+        '};',
+        '',
+        'static_assert( reflection::GetFieldsCount<Generated>() == {}, "Wrong fields count" );'.format(len(fields)),
+        '',
+        'constexpr auto ids = reflection::GetTypeIds<Generated>();',
+        'static_assert( ids.Size() == {}, "Wrong ids count" );'.format(len(fields)),
+        '',
+        'size_t PackedSize()',
+        '{',
+        '    return reflection::Layout<Generated>::packedSize;',
+        '}',
+        '',
+    ]
+
+    return '\n'.join(lines), len(fields)
+
+
+def is_msvc(compiler):
+    name = os.path.splitext(os.path.basename(compiler))[0].lower()
+    return name in ('cl', 'clang-cl')
+
+
+def compile_command(compiler, std, include, source, obj):
+    if is_msvc(compiler):
+        return [ compiler, '/nologo', '/EHsc', '/std:c++{}'.format(std),
+                 '/I{}'.format(include), '/c', source, '/Fo{}'.format(obj) ]
+
+    return [ compiler, '-std=c++{}'.format(std), '-I{}'.format(include),
+             '-c', source, '-o', obj ]
+
+
+def run_compiler(command):
+    """Returns (status, seconds, peak memory in KiB or None)."""
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    if hasattr(os, 'wait4'):
+        #
+        # wait4 returns resources used by this child only,
+        # so peak memory is measured for each size separately
+        #
+        _, status, usage = os.wait4(process.pid, 0)
+        seconds = time.perf_counter() - start
+        process.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+
+        peak = usage.ru_maxrss
+        if sys.platform == 'darwin':
+            peak //= 1024  # bytes on macOS, KiB on Linux
+
+        return process.returncode, seconds, peak
+
+    process.communicate()
+    return process.returncode, time.perf_counter() - start, None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile-time benchmark of PodSerializer reflection')
+    parser.add_argument('--compiler', required=True, help='C++ compiler to run')
+    parser.add_argument('--include', required=True, help='Directory with PodSerializer headers')
+    parser.add_argument('--std', default='17', choices=[ '14', '17' ], help='Language standard')
+    parser.add_argument('--shape', default='chars', choices=[ 'chars', 'mixed' ], help='Shape of generated structures')
+    parser.add_argument('--min-size', type=int, default=8, help='Size of the smallest structure in bytes')
+    parser.add_argument('--max-size', type=int, default=4096, help='Size of the biggest structure in bytes')
+    parser.add_argument('--output', default='compile_time.csv', help='CSV file to write results to')
+    args = parser.parse_args()
+
+    results = []
+
+    with tempfile.TemporaryDirectory() as workdir:
+        size = args.min_size
+        while size <= args.max_size:
+            code, fields = generate_source(args.shape, size)
+
+            source = os.path.join(workdir, 'generated_{}.cpp'.format(size))
+            obj = os.path.join(workdir, 'generated_{}.obj'.format(size))
+
+            with open(source, 'w') as file:
+                file.write(code)
+
+            command = compile_command(args.compiler, args.std, args.include, source, obj)
+            status, seconds, peak = run_compiler(command)
+
+            results.append((size, fields, seconds, peak, status))
+            print('{:>6} bytes {:>6} fields {:>9.3f} s {:>10} KiB {}'.format(
+                size, fields, seconds, peak if peak is not None else '-', 'ok' if status == 0 else 'FAILED'))
+
+            size *= 2
+
+    with open(args.output, 'w') as file:
+        file.write('shape,std,size,fields,seconds,peak_kib,status\n')
+        for size, fields, seconds, peak, status in results:
+            file.write('{},{},{},{},{:.3f},{},{}\n'.format(
+                args.shape, args.std, size, fields, seconds, peak if peak is not None else '', status))
+
+    return 0 if all(result[4] == 0 for result in results) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,1584 @@
+#include "pch.h"
+
+//
+// Every benchmark reports:
+//  - time per operation (default Google Benchmark output)
+//  - bytes per second, where one operation processes sizeof( _Type ) bytes
+//  - 'allocs/op' counter with average number of heap allocations
+//
+
+
+/************************************************************************************
+ * Benchmarked shapes
+ */
+
+//
+// Struct without padding: it is serialized with a single memcpy
+//
+struct Tick
+{
+    long long timestamp;
+    double    price;
+    int       volume;
+    short     flags;
+    char      side;
+    char      venue;
+};
+
+static_assert( IsPaddingFree<Tick>(), "Tick must be padding-free" );
+
+//
+// Struct with padding: it is serialized field by field
+//
+struct PaddedTick
+{
+    char      side;
+    long long timestamp;
+    short     flags;
+    double    price;
+    char      venue;
+    int       volume;
+};
+
+static_assert( !IsPaddingFree<PaddedTick>(), "PaddedTick must contain padding" );
+
+//
+// The same shapes as in tests
+//
+
+struct TwoFields
+{
+    char field1;
+    int  field2;
+};
+
+struct TenFields
+{
+    char field1; int field2; int field3; double field4; short field5;
+    char field6; int field7; int field8; double field9; short field10;
+};
+
+struct Nested
+{
+    int  field1;
+    char field2;
+};
+
+struct ThreeFieldsWithNestedStruct
+{
+    double field1;
+    Nested field2;
+    char   field3;
+};
+
+struct NotPod
+{
+    char        field1;
+    std::string field2;
+    double      field3;
+};
+
+//
+// Objects with non-trivial values. String in NotPod does not
+// fit into small buffer and contains no spaces, so it can be
+// read back by stream operators without separator.
+//
+
+template<typename _Type>
+_Type MakeSample()
+{
+    return _Type{};
+}
+
+template<>
+TwoFields MakeSample<TwoFields>()
+{
+    return TwoFields{ 'a', 123456 };
+}
+
+template<>
+TenFields MakeSample<TenFields>()
+{
+    return TenFields{ 'a', 25, 4, 3.14, 10, 'b', 54, 32, 2.71, 9 };
+}
+
+template<>
+ThreeFieldsWithNestedStruct MakeSample<ThreeFieldsWithNestedStruct>()
+{
+    return ThreeFieldsWithNestedStruct{ 3.14, { 42, 'a' }, 'b' };
+}
+
+template<>
+NotPod MakeSample<NotPod>()
+{
+    return NotPod{ 'a', "Long_string_that_does_not_fit_into_small_buffer", 3.14 };
+}
+
+
+/************************************************************************************
+ * Binary serialization benchmarks
+ */
+
+template<typename _Type>
+static void BM_BinarySerialize( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+
+    BinarySerializer<_Type> serializer;
+    BinaryBuffer<_Type> buffer;
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &original );
+        serializer.Serialize( original, buffer );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_BinaryDeserialize( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+    _Type loaded{};
+
+    BinarySerializer<_Type> serializer;
+    BinaryBuffer<_Type> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        serializer.Deserialize( loaded, buffer );
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_InlineBinarySerialize( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+
+    InlineBinarySerializer<_Type> serializer;
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        //
+        // Buffer is constructed each time: no heap allocation happens
+        //
+        InlineBinaryBuffer<_Type> buffer;
+
+        benchmark::DoNotOptimize( &original );
+        serializer.Serialize( original, buffer );
+        benchmark::DoNotOptimize( &buffer );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+//
+// Baseline: hand-written copy of the whole record
+//
+template<typename _Type>
+static void BM_MemcpyBaseline( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+    unsigned char buffer[sizeof( _Type )];
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &original );
+        memcpy( buffer, &original, sizeof( _Type ) );
+        benchmark::DoNotOptimize( buffer );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_BinarySerialize, Tick );
+BENCHMARK_TEMPLATE( BM_BinarySerialize, PaddedTick );
+BENCHMARK_TEMPLATE( BM_BinarySerialize, TwoFields );
+BENCHMARK_TEMPLATE( BM_BinarySerialize, TenFields );
+BENCHMARK_TEMPLATE( BM_BinarySerialize, ThreeFieldsWithNestedStruct );
+
+BENCHMARK_TEMPLATE( BM_BinaryDeserialize, Tick );
+BENCHMARK_TEMPLATE( BM_BinaryDeserialize, PaddedTick );
+BENCHMARK_TEMPLATE( BM_BinaryDeserialize, TwoFields );
+BENCHMARK_TEMPLATE( BM_BinaryDeserialize, TenFields );
+BENCHMARK_TEMPLATE( BM_BinaryDeserialize, ThreeFieldsWithNestedStruct );
+
+BENCHMARK_TEMPLATE( BM_InlineBinarySerialize, Tick );
+BENCHMARK_TEMPLATE( BM_InlineBinarySerialize, PaddedTick );
+
+BENCHMARK_TEMPLATE( BM_MemcpyBaseline, Tick );
+BENCHMARK_TEMPLATE( BM_MemcpyBaseline, TwoFields );
+BENCHMARK_TEMPLATE( BM_MemcpyBaseline, TenFields );
+BENCHMARK_TEMPLATE( BM_MemcpyBaseline, ThreeFieldsWithNestedStruct );
+
+
+/************************************************************************************
+ * Batch binary serialization benchmarks
+ */
+
+template<typename _Type>
+static void BM_BinarySerializeLoop( benchmark::State& state )
+{
+    std::vector<_Type> original( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<BinaryBuffer<_Type>> buffers;
+
+    BinarySerializer<_Type> serializer;
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        buffers.clear();
+
+        for (const auto& obj : original)
+        {
+            BinaryBuffer<_Type> buffer;
+            serializer.Serialize( obj, buffer );
+            buffers.push_back( std::move( buffer ) );
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_BinarySerializeBatch( benchmark::State& state )
+{
+    std::vector<_Type> original( static_cast<size_t>( state.range( 0 ) ) );
+
+    BinaryBatchSerializer<_Type> serializer;
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        BinaryBatchBuffer<_Type> buffer;
+        serializer.SerializeRange( original.begin(), original.end(), buffer );
+        benchmark::DoNotOptimize( &buffer );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_BinaryDeserializeBatch( benchmark::State& state )
+{
+    std::vector<_Type> original( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<_Type> loaded;
+
+    BinaryBatchSerializer<_Type> serializer;
+    BinaryBatchBuffer<_Type> buffer;
+
+    serializer.SerializeRange( original.begin(), original.end(), buffer );
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        serializer.DeserializeRange( loaded, buffer );
+        benchmark::DoNotOptimize( loaded.data() );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_BinarySerializeLoop, PaddedTick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_BinarySerializeBatch, PaddedTick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_BinaryDeserializeBatch, PaddedTick )->Range( 1 << 10, 1 << 20 );
+
+//
+// Selection of 1% of records from batch: whole batch
+// is deserialized and filtered, or records are scanned
+// by predicate and only selected ones are loaded
+//
+
+static BinaryBatchBuffer<TenFields> MakeScannedBatch( size_t count )
+{
+    BinaryBatchBuffer<TenFields> buffer;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        //
+        // Selected records are spread over the whole batch
+        //
+        auto obj = MakeSample<TenFields>();
+        obj.field2 = static_cast<int>( i * 7919 % count );
+
+        buffer.Save( obj );
+    }
+
+    return buffer;
+}
+
+static void BM_BinaryFilterDeserialized( benchmark::State& state )
+{
+    auto count = static_cast<size_t>( state.range( 0 ) );
+    auto buffer = MakeScannedBatch( count );
+
+    std::vector<TenFields> loaded;
+    std::vector<TenFields> selected;
+
+    for (auto _ : state)
+    {
+        buffer.LoadRange( loaded );
+
+        selected.clear();
+        for (const auto& obj : loaded)
+        {
+            if (obj.field2 < static_cast<int>( count / 100 )) {
+                selected.push_back( obj );
+            }
+        }
+
+        benchmark::DoNotOptimize( selected.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_BinaryScan( benchmark::State& state )
+{
+    auto count = static_cast<size_t>( state.range( 0 ) );
+    auto buffer = MakeScannedBatch( count );
+
+    std::vector<TenFields> selected;
+
+    for (auto _ : state)
+    {
+        auto selection = Scan( buffer, FieldLess<1>( static_cast<int>( count / 100 ) ) );
+        LoadSelected( buffer, selection, selected );
+
+        benchmark::DoNotOptimize( selected.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+BENCHMARK( BM_BinaryFilterDeserialized )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_BinaryScan )->Range( 1 << 10, 1 << 20 );
+
+
+/************************************************************************************
+ * String stream serialization benchmarks
+ */
+
+//
+// _Buffer is StringStreamBuffer or WStringStreamBuffer.
+// Buffer is created each time, so its memory is allocated
+// in each iteration as well.
+//
+template<
+    template<typename> class _Buffer,
+    typename                 _Type
+> static void BM_StreamSerialize( benchmark::State& state )
+{
+    using serializer_t = serialization::BasicSerializer<_Type, _Buffer>;
+    using buffer_t     = _Buffer<_Type>;
+
+    auto original = MakeSample<_Type>();
+
+    serializer_t serializer;
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        buffer_t buffer;
+
+        benchmark::DoNotOptimize( &original );
+        serializer.Serialize( original, buffer );
+        benchmark::DoNotOptimize( &buffer );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<
+    template<typename> class _Buffer,
+    typename                 _Type
+> static void BM_StreamDeserialize( benchmark::State& state )
+{
+    using serializer_t = serialization::BasicSerializer<_Type, _Buffer>;
+    using buffer_t     = _Buffer<_Type>;
+
+    auto original = MakeSample<_Type>();
+    _Type loaded{};
+
+    serializer_t serializer;
+    buffer_t buffer;
+
+    serializer.Serialize( original, buffer );
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        serializer.Deserialize( loaded, buffer );
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_StreamSerialize, StringStreamBuffer, TwoFields );
+BENCHMARK_TEMPLATE( BM_StreamSerialize, StringStreamBuffer, TenFields );
+BENCHMARK_TEMPLATE( BM_StreamSerialize, StringStreamBuffer, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_StreamSerialize, StringStreamBuffer, NotPod );
+
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, StringStreamBuffer, TwoFields );
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, StringStreamBuffer, TenFields );
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, StringStreamBuffer, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, StringStreamBuffer, NotPod );
+
+//
+// std::string can not be written into wide stream,
+// so NotPod is not benchmarked here.
+//
+
+BENCHMARK_TEMPLATE( BM_StreamSerialize, WStringStreamBuffer, TwoFields );
+BENCHMARK_TEMPLATE( BM_StreamSerialize, WStringStreamBuffer, TenFields );
+BENCHMARK_TEMPLATE( BM_StreamSerialize, WStringStreamBuffer, ThreeFieldsWithNestedStruct );
+
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, WStringStreamBuffer, TwoFields );
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, WStringStreamBuffer, TenFields );
+BENCHMARK_TEMPLATE( BM_StreamDeserialize, WStringStreamBuffer, ThreeFieldsWithNestedStruct );
+
+
+/************************************************************************************
+ * Stream operators benchmarks
+ */
+
+template<typename _Type>
+static void BM_OperatorToStream( benchmark::State& state )
+{
+    using namespace io_operators;
+
+    auto original = MakeSample<_Type>();
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        std::ostringstream stream;
+        stream << original;
+        benchmark::DoNotOptimize( &stream );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_OperatorFromStream( benchmark::State& state )
+{
+    using namespace io_operators;
+
+    std::ostringstream text;
+    text << MakeSample<_Type>();
+
+    const auto str = text.str();
+    _Type loaded{};
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        std::istringstream stream( str );
+        stream >> loaded;
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_OperatorToStream, TwoFields );
+BENCHMARK_TEMPLATE( BM_OperatorToStream, TenFields );
+BENCHMARK_TEMPLATE( BM_OperatorToStream, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_OperatorToStream, NotPod );
+
+BENCHMARK_TEMPLATE( BM_OperatorFromStream, TwoFields );
+BENCHMARK_TEMPLATE( BM_OperatorFromStream, TenFields );
+BENCHMARK_TEMPLATE( BM_OperatorFromStream, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_OperatorFromStream, NotPod );
+
+
+/************************************************************************************
+ * Text reader benchmarks
+ */
+
+//
+// Text with separator is read by stream operators
+// (temporary stream for each field) and by text reader
+//
+
+template<typename _Type>
+static void BM_OperatorFromStreamWithSeparator( benchmark::State& state )
+{
+    using namespace io_operators;
+    using io_manipulators::io_internal::set_separator;
+
+    TextWriter writer( '\0' );
+    writer.Write( MakeSample<_Type>() );
+
+    const auto str = writer.Str();
+    _Type loaded{};
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        std::istringstream stream( str );
+        stream >> set_separator( '\0' ) >> loaded;
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_TextReader( benchmark::State& state )
+{
+    TextWriter writer( '\0' );
+    writer.Write( MakeSample<_Type>() );
+
+    _Type loaded{};
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        TextReader reader( writer.Data(), writer.Size(), '\0' );
+        reader.Read( loaded );
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_OperatorFromStreamWithSeparator, TwoFields );
+BENCHMARK_TEMPLATE( BM_OperatorFromStreamWithSeparator, TenFields );
+BENCHMARK_TEMPLATE( BM_OperatorFromStreamWithSeparator, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_OperatorFromStreamWithSeparator, NotPod );
+
+BENCHMARK_TEMPLATE( BM_TextReader, TwoFields );
+BENCHMARK_TEMPLATE( BM_TextReader, TenFields );
+BENCHMARK_TEMPLATE( BM_TextReader, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_TextReader, NotPod );
+
+//
+// Large text: string field of state.range( 0 ) chars.
+// Bytes per second are calculated for length of text.
+//
+
+static std::string MakeLongText( size_t length )
+{
+    TextWriter writer( '\0' );
+    writer.Write( NotPod{ 'a', std::string( length, 'x' ), 3.14 } );
+
+    return writer.Str();
+}
+
+static void BM_OperatorFromStreamLongText( benchmark::State& state )
+{
+    using namespace io_operators;
+    using io_manipulators::io_internal::set_separator;
+
+    const auto str = MakeLongText( static_cast<size_t>( state.range( 0 ) ) );
+    NotPod loaded{};
+
+    for (auto _ : state)
+    {
+        std::istringstream stream( str );
+        stream >> set_separator( '\0' ) >> loaded;
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( str.size() ) );
+}
+
+static void BM_TextReaderLongText( benchmark::State& state )
+{
+    const auto str = MakeLongText( static_cast<size_t>( state.range( 0 ) ) );
+    NotPod loaded{};
+
+    for (auto _ : state)
+    {
+        TextReader reader( str.data(), str.size(), '\0' );
+        reader.Read( loaded );
+        benchmark::DoNotOptimize( &loaded );
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( str.size() ) );
+}
+
+BENCHMARK( BM_OperatorFromStreamLongText )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_TextReaderLongText )->Range( 1 << 10, 1 << 20 );
+
+/************************************************************************************
+ * Reflection benchmarks
+ */
+
+template<typename _Type>
+static void BM_ToTuple( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &original );
+        auto tpl = ToTuple( original );
+        benchmark::DoNotOptimize( &tpl );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_ToTuplePrecise( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &original );
+        auto tpl = ToTuplePrecise( original );
+        benchmark::DoNotOptimize( &tpl );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_ToTuplePreciseView( benchmark::State& state )
+{
+    auto original = MakeSample<_Type>();
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &original );
+        auto view = ToTuplePreciseView( original );
+        benchmark::DoNotOptimize( &view );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_FromTuple( benchmark::State& state )
+{
+    const auto tpl = ToTuplePrecise( MakeSample<_Type>() );
+
+    auto allocations = GetAllocationsCount();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize( &tpl );
+        auto obj = FromTuple<_Type>( tpl );
+        benchmark::DoNotOptimize( &obj );
+    }
+
+    ReportAllocations( state, allocations );
+    state.SetBytesProcessed( state.iterations() * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_ToTuple, TwoFields );
+BENCHMARK_TEMPLATE( BM_ToTuple, TenFields );
+BENCHMARK_TEMPLATE( BM_ToTuple, ThreeFieldsWithNestedStruct );
+
+BENCHMARK_TEMPLATE( BM_ToTuplePrecise, TwoFields );
+BENCHMARK_TEMPLATE( BM_ToTuplePrecise, TenFields );
+BENCHMARK_TEMPLATE( BM_ToTuplePrecise, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_ToTuplePrecise, NotPod );
+
+BENCHMARK_TEMPLATE( BM_ToTuplePreciseView, TenFields );
+BENCHMARK_TEMPLATE( BM_ToTuplePreciseView, NotPod );
+
+BENCHMARK_TEMPLATE( BM_FromTuple, TwoFields );
+BENCHMARK_TEMPLATE( BM_FromTuple, TenFields );
+BENCHMARK_TEMPLATE( BM_FromTuple, ThreeFieldsWithNestedStruct );
+BENCHMARK_TEMPLATE( BM_FromTuple, NotPod );
+
+/************************************************************************************
+ * Columnar container benchmarks
+ */
+
+//
+// Sum of one field of state.range( 0 ) objects: array of
+// structures reads whole objects, SoaVector reads only
+// column of this field
+//
+
+static void BM_AosScan( benchmark::State& state )
+{
+    std::vector<TenFields> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (const auto& obj : objects) {
+            sum += obj.field4;
+        }
+
+        benchmark::DoNotOptimize( sum );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( double ) );
+}
+
+static void BM_SoaScan( benchmark::State& state )
+{
+    SoaVector<TenFields> objects;
+    for (int64_t i = 0; i < state.range( 0 ); ++i) {
+        objects.PushBack( MakeSample<TenFields>() );
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (double value : objects.Column<3>()) {
+            sum += value;
+        }
+
+        benchmark::DoNotOptimize( sum );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( double ) );
+}
+
+BENCHMARK( BM_AosScan )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_SoaScan )->Range( 1 << 10, 1 << 22 );
+
+//
+// Transposition of state.range( 0 ) objects: one by one
+// and by kernels
+//
+
+template<typename _Type>
+static void BM_SoaPushBackLoop( benchmark::State& state )
+{
+    std::vector<_Type> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<_Type>() );
+    SoaVector<_Type> soa;
+
+    for (auto _ : state)
+    {
+        soa.Clear();
+
+        for (const auto& obj : objects) {
+            soa.PushBack( obj );
+        }
+
+        benchmark::DoNotOptimize( soa.template Column<0>().Data() );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_SoaAppendRange( benchmark::State& state )
+{
+    std::vector<_Type> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<_Type>() );
+    SoaVector<_Type> soa;
+
+    for (auto _ : state)
+    {
+        soa.Clear();
+        soa.AppendRange( objects.data(), objects.size() );
+
+        benchmark::DoNotOptimize( soa.template Column<0>().Data() );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_SoaGetLoop( benchmark::State& state )
+{
+    SoaVector<_Type> soa;
+    std::vector<_Type> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<_Type>() );
+
+    soa.AppendRange( objects.data(), objects.size() );
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < objects.size(); ++i) {
+            objects[i] = soa.Get( i );
+        }
+
+        benchmark::DoNotOptimize( objects.data() );
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+template<typename _Type>
+static void BM_SoaLoadRange( benchmark::State& state )
+{
+    SoaVector<_Type> soa;
+    std::vector<_Type> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<_Type>() );
+
+    soa.AppendRange( objects.data(), objects.size() );
+
+    for (auto _ : state)
+    {
+        soa.LoadRange( objects.data(), 0, objects.size() );
+
+        benchmark::DoNotOptimize( objects.data() );
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( _Type ) );
+}
+
+BENCHMARK_TEMPLATE( BM_SoaPushBackLoop, TwoFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaPushBackLoop, Tick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaPushBackLoop, TenFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaAppendRange, TwoFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaAppendRange, Tick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaAppendRange, TenFields )->Range( 1 << 10, 1 << 20 );
+
+BENCHMARK_TEMPLATE( BM_SoaGetLoop, TwoFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaGetLoop, Tick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaGetLoop, TenFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaLoadRange, TwoFields )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaLoadRange, Tick )->Range( 1 << 10, 1 << 20 );
+BENCHMARK_TEMPLATE( BM_SoaLoadRange, TenFields )->Range( 1 << 10, 1 << 20 );
+
+//
+// Aggregation of one field of state.range( 0 ) objects
+// (compare with BM_AosScan and BM_SoaScan)
+//
+
+static void BM_AggregateAosSum( benchmark::State& state )
+{
+    std::vector<TenFields> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize( Sum<3>( objects.data(), objects.size() ) );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( double ) );
+}
+
+static void BM_AggregateSoaSum( benchmark::State& state )
+{
+    std::vector<TenFields> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+
+    SoaVector<TenFields> soa;
+    soa.AppendRange( objects.data(), objects.size() );
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize( Sum<3>( soa ) );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( double ) );
+}
+
+static void BM_SoaMinLoop( benchmark::State& state )
+{
+    std::vector<TenFields> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+
+    SoaVector<TenFields> soa;
+    soa.AppendRange( objects.data(), objects.size() );
+
+    for (auto _ : state)
+    {
+        auto column = soa.Column<1>();
+
+        int min = column[0];
+        for (int value : column) {
+            min = value < min ? value : min;
+        }
+
+        benchmark::DoNotOptimize( min );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( int ) );
+}
+
+static void BM_AggregateSoaMin( benchmark::State& state )
+{
+    std::vector<TenFields> objects( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+
+    SoaVector<TenFields> soa;
+    soa.AppendRange( objects.data(), objects.size() );
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize( Min<1>( soa ) );
+    }
+
+    state.SetBytesProcessed( state.iterations() * state.range( 0 ) * sizeof( int ) );
+}
+
+BENCHMARK( BM_AggregateAosSum )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_AggregateSoaSum )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_SoaMinLoop )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_AggregateSoaMin )->Range( 1 << 10, 1 << 22 );
+
+
+//
+// Sorting of state.range( 0 ) ticks by timestamp
+//
+
+static std::vector<Tick> MakeShuffledTicks( size_t count )
+{
+    std::vector<Tick> ticks( count, MakeSample<Tick>() );
+
+    uint64_t state = 88172645463325252ull;
+    for (auto& tick : ticks)
+    {
+        //
+        // xorshift: timestamps are random 64-bit numbers
+        //
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        tick.timestamp = static_cast<long long>( state );
+    }
+
+    return ticks;
+}
+
+static void BM_StdSortByField( benchmark::State& state )
+{
+    auto original = MakeShuffledTicks( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<Tick> ticks;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ticks = original;
+        state.ResumeTiming();
+
+        std::sort( ticks.begin(), ticks.end(), []( const Tick& left, const Tick& right ) {
+            return left.timestamp < right.timestamp;
+        } );
+
+        benchmark::DoNotOptimize( ticks.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_RadixSortByField( benchmark::State& state )
+{
+    auto original = MakeShuffledTicks( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<Tick> ticks;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ticks = original;
+        state.ResumeTiming();
+
+        SortByField<0>( ticks );
+
+        benchmark::DoNotOptimize( ticks.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_RadixSortByFieldParallel( benchmark::State& state )
+{
+    auto original = MakeShuffledTicks( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<Tick> ticks;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ticks = original;
+        state.ResumeTiming();
+
+        SortByFieldParallel<0>( ticks );
+
+        benchmark::DoNotOptimize( ticks.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+BENCHMARK( BM_StdSortByField )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_RadixSortByField )->Range( 1 << 10, 1 << 22 );
+BENCHMARK( BM_RadixSortByFieldParallel )->Range( 1 << 16, 1 << 22 );
+
+//
+// Sort by several fields: lexicographic comparator vs encoded keys
+//
+
+struct OrderKey
+{
+    char      venue;
+    char      side;
+    double    price;
+    long long timestamp;
+};
+
+static std::vector<OrderKey> MakeOrderKeys( size_t count )
+{
+    auto ticks = MakeShuffledTicks( count );
+    std::vector<OrderKey> keys( count );
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto random = static_cast<unsigned long long>( ticks[i].timestamp );
+
+        keys[i].venue = static_cast<char>( 'A' + random % 4 );
+        keys[i].side = static_cast<char>( ( random >> 8 ) % 2 ? 'B' : 'S' );
+        keys[i].price = 100.0 + static_cast<double>( ( random >> 16 ) % 64 ) * 0.25;
+        keys[i].timestamp = ticks[i].timestamp;
+    }
+
+    return keys;
+}
+
+static void BM_SortByComparator( benchmark::State& state )
+{
+    auto original = MakeOrderKeys( static_cast<size_t>( state.range( 0 ) ) );
+    std::vector<OrderKey> keys;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        keys = original;
+        state.ResumeTiming();
+
+        std::sort( keys.begin(), keys.end(), []( const OrderKey& left, const OrderKey& right ) {
+            return std::tie( left.venue, left.side, left.price, left.timestamp ) <
+                   std::tie( right.venue, right.side, right.price, right.timestamp );
+        } );
+
+        benchmark::DoNotOptimize( keys.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_SortByEncodedKey( benchmark::State& state )
+{
+    auto keys = MakeOrderKeys( static_cast<size_t>( state.range( 0 ) ) );
+
+    //
+    // All keys are of the same size here (18 bytes), so they
+    // are stored inline. 8-byte prefix is compared first.
+    //
+    struct Entry
+    {
+        uint64_t      prefix;
+        unsigned char key[24];
+    };
+
+    std::vector<unsigned char> key;
+    std::vector<Entry> original( keys.size() );
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EncodeKey( keys[i], key );
+
+        original[i].prefix = KeyPrefix( key );
+        std::copy( key.begin(), key.end(), original[i].key );
+    }
+
+    const size_t keySize = key.size();
+    std::vector<Entry> entries;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        entries = original;
+        state.ResumeTiming();
+
+        std::sort( entries.begin(), entries.end(), [keySize]( const Entry& left, const Entry& right ) {
+            if (left.prefix != right.prefix) {
+                return left.prefix < right.prefix;
+            }
+
+            return CompareKeys( left.key, keySize, right.key, keySize ) < 0;
+        } );
+
+        benchmark::DoNotOptimize( entries.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+BENCHMARK( BM_SortByComparator )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_SortByEncodedKey )->Range( 1 << 10, 1 << 20 );
+
+/************************************************************************************
+ * Mapped record file benchmarks
+ */
+
+//
+// Records are written and read one by one: with stdio
+// (fwrite/fread of each serialized record) and through
+// mapping. File stays in page cache, so costs of calls
+// and copies are compared.
+//
+
+static const char* const BenchmarkRecordsPath = "Benchmark.Records.bin";
+
+static void BM_RecordFileWriteStdio( benchmark::State& state )
+{
+    using record_t = ThreeFieldsWithNestedStruct;
+
+    const auto original = MakeSample<record_t>();
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    unsigned char record[reflection::Layout<record_t>::packedSize];
+
+    for (auto _ : state)
+    {
+        std::FILE* file = std::fopen( BenchmarkRecordsPath, "wb" );
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            serialization::details::SaveBinary( original, record );
+            std::fwrite( record, sizeof( record ), 1, file );
+        }
+
+        std::fclose( file );
+    }
+
+    std::remove( BenchmarkRecordsPath );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_RecordFileWriteMapped( benchmark::State& state )
+{
+    using record_t = ThreeFieldsWithNestedStruct;
+
+    const auto original = MakeSample<record_t>();
+    const auto count = static_cast<size_t>( state.range( 0 ) );
+
+    for (auto _ : state)
+    {
+        MappedRecordFile<record_t> file( BenchmarkRecordsPath, serialization::mapped_truncate, count );
+
+        for (size_t i = 0; i < count; ++i) {
+            file.Append( original );
+        }
+    }
+
+    std::remove( BenchmarkRecordsPath );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_RecordFileReadStdio( benchmark::State& state )
+{
+    using record_t = ThreeFieldsWithNestedStruct;
+
+    {
+        MappedRecordFile<record_t> file( BenchmarkRecordsPath, serialization::mapped_truncate );
+        std::vector<record_t> objs( static_cast<size_t>( state.range( 0 ) ), MakeSample<record_t>() );
+
+        file.AppendRange( objs.begin(), objs.end() );
+    }
+
+    unsigned char record[reflection::Layout<record_t>::packedSize];
+    record_t loaded;
+
+    for (auto _ : state)
+    {
+        std::FILE* file = std::fopen( BenchmarkRecordsPath, "rb" );
+
+        while (std::fread( record, sizeof( record ), 1, file ) == 1)
+        {
+            serialization::details::LoadBinary( loaded, record );
+            benchmark::DoNotOptimize( &loaded );
+        }
+
+        std::fclose( file );
+    }
+
+    std::remove( BenchmarkRecordsPath );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_RecordFileReadMapped( benchmark::State& state )
+{
+    using record_t = ThreeFieldsWithNestedStruct;
+
+    {
+        MappedRecordFile<record_t> file( BenchmarkRecordsPath, serialization::mapped_truncate );
+        std::vector<record_t> objs( static_cast<size_t>( state.range( 0 ) ), MakeSample<record_t>() );
+
+        file.AppendRange( objs.begin(), objs.end() );
+    }
+
+    for (auto _ : state)
+    {
+        MappedRecordFile<record_t> file( BenchmarkRecordsPath, serialization::mapped_read_only );
+
+        file.ForEach( []( const record_t& loaded ) {
+            benchmark::DoNotOptimize( &loaded );
+        } );
+    }
+
+    std::remove( BenchmarkRecordsPath );
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+BENCHMARK( BM_RecordFileWriteStdio )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_RecordFileWriteMapped )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_RecordFileReadStdio )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_RecordFileReadMapped )->Range( 1 << 10, 1 << 20 );
+
+/************************************************************************************
+ * Write-ahead log benchmarks
+ */
+
+//
+// state.range( 0 ) threads append records concurrently.
+// Single thread is the baseline: one sync per record.
+//
+
+static void BM_WriteAheadLogAppend( benchmark::State& state )
+{
+    const char* path = "Benchmark.WriteAheadLog.log";
+
+    const auto threadsCount = static_cast<size_t>( state.range( 0 ) );
+    const size_t recordsCount = 4096;
+
+    const auto original = MakeSample<TenFields>();
+    size_t commits = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::remove( path );
+        state.ResumeTiming();
+
+        serialization::WriteAheadLog<TenFields> log( path );
+        std::vector<std::thread> threads;
+
+        for (size_t thread = 0; thread < threadsCount; ++thread)
+        {
+            threads.emplace_back( [&log, &original, threadsCount, recordsCount]() {
+                for (size_t i = 0; i < recordsCount / threadsCount; ++i) {
+                    log.Append( original );
+                }
+            } );
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        commits += log.CommitsCount();
+    }
+
+    std::remove( path );
+
+    state.counters["records_per_commit"] = static_cast<double>( state.iterations() * recordsCount ) / commits;
+    state.SetItemsProcessed( state.iterations() * recordsCount );
+}
+
+BENCHMARK( BM_WriteAheadLogAppend )->RangeMultiplier( 4 )->Range( 1, 256 )->UseRealTime();
+
+/************************************************************************************
+ * Scatter-gather benchmarks
+ */
+
+#if !defined(_WIN32)
+
+//
+// Header, batch of state.range( 0 ) records and trailer are
+// written to /dev/null: concatenated into one block before
+// write and written with writev straight from buffers. So
+// only cost of copy is measured.
+//
+
+static void BM_WriteConcatenated( benchmark::State& state )
+{
+    BinarySerializer<TwoFields> serializer;
+    BinaryBuffer<TwoFields> header;
+    BinaryBuffer<TwoFields> trailer;
+
+    serializer.Serialize( MakeSample<TwoFields>(), header );
+    serializer.Serialize( MakeSample<TwoFields>(), trailer );
+
+    BinaryBatchBuffer<TenFields> batch;
+    std::vector<TenFields> objs( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+    batch.SaveRange( objs.begin(), objs.end() );
+
+    int fd = open( "/dev/null", O_WRONLY );
+    std::vector<unsigned char> message;
+
+    for (auto _ : state)
+    {
+        message.clear();
+        message.insert( message.end(), header.Data(), header.Data() + header.Size() );
+        message.insert( message.end(), batch.Data(), batch.Data() + batch.Size() );
+        message.insert( message.end(), trailer.Data(), trailer.Data() + trailer.Size() );
+
+        benchmark::DoNotOptimize( write( fd, message.data(), message.size() ) );
+    }
+
+    close( fd );
+    state.SetBytesProcessed( state.iterations() * ( header.Size() + batch.Size() + trailer.Size() ) );
+}
+
+static void BM_WriteScatterGather( benchmark::State& state )
+{
+    BinarySerializer<TwoFields> serializer;
+    BinaryBuffer<TwoFields> header;
+    BinaryBuffer<TwoFields> trailer;
+
+    serializer.Serialize( MakeSample<TwoFields>(), header );
+    serializer.Serialize( MakeSample<TwoFields>(), trailer );
+
+    BinaryBatchBuffer<TenFields> batch;
+    std::vector<TenFields> objs( static_cast<size_t>( state.range( 0 ) ), MakeSample<TenFields>() );
+    batch.SaveRange( objs.begin(), objs.end() );
+
+    int fd = open( "/dev/null", O_WRONLY );
+    ScatterGatherSink sink;
+
+    for (auto _ : state)
+    {
+        sink.Add( header );
+        sink.Add( batch );
+        sink.Add( trailer );
+
+        benchmark::DoNotOptimize( WriteSegments( fd, sink ) );
+    }
+
+    close( fd );
+    state.SetBytesProcessed( state.iterations() * ( header.Size() + batch.Size() + trailer.Size() ) );
+}
+
+BENCHMARK( BM_WriteConcatenated )->Range( 1, 1 << 14 );
+BENCHMARK( BM_WriteScatterGather )->Range( 1, 1 << 14 );
+
+#endif // !defined(_WIN32)
+
+/************************************************************************************
+ * Framed stream benchmarks
+ */
+
+//
+// Stream of state.range( 0 ) PaddedTick frames, each followed
+// by a TwoFields frame, that reader skips. Compare with
+// BM_BinaryDeserializeBatch, that reads unframed records.
+//
+
+static void BM_FrameWrite( benchmark::State& state )
+{
+    const auto tick = MakeSample<PaddedTick>();
+    const auto other = MakeSample<TwoFields>();
+
+    FrameWriter<MemorySink> writer;
+
+    for (auto _ : state)
+    {
+        writer.Sink().Clear();
+
+        for (int64_t i = 0; i < state.range( 0 ); ++i)
+        {
+            writer.Write( tick );
+            writer.Write( other );
+        }
+
+        benchmark::DoNotOptimize( writer.Sink().Data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+static void BM_FrameRead( benchmark::State& state )
+{
+    FrameWriter<MemorySink> writer;
+
+    for (int64_t i = 0; i < state.range( 0 ); ++i)
+    {
+        writer.Write( MakeSample<PaddedTick>() );
+        writer.Write( MakeSample<TwoFields>() );
+    }
+
+    std::vector<PaddedTick> loaded( static_cast<size_t>( state.range( 0 ) ) );
+
+    for (auto _ : state)
+    {
+        FrameReader<MemorySource> reader( MemorySource( writer.Sink().Data(), writer.Sink().Size() ) );
+        auto current = loaded.begin();
+
+        while (reader.Next())
+        {
+            if (reader.Is<PaddedTick>()) {
+                reader.Read( *current++ );
+            }
+        }
+
+        benchmark::DoNotOptimize( loaded.data() );
+    }
+
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+
+BENCHMARK( BM_FrameWrite )->Range( 1 << 10, 1 << 20 );
+BENCHMARK( BM_FrameRead )->Range( 1 << 10, 1 << 20 );
+
+//
+// Dispatch of messages of N types: chain of fingerprint checks
+// of FrameReader vs jump table of MessageCodec. Kinds of
+// messages alternate, so chain takes N / 2 checks on average.
+//
+
+template<int _Kind>
+struct KindMessage
+{
+    int kind; int value; double weight;
+};
+
+template<typename _Sequence>
+struct KindMessages; /* Not implemented */
+
+template<int... _Kinds>
+struct KindMessages<std::integer_sequence<int, _Kinds...>>
+{
+    using type = type_list::TypeList<KindMessage<_Kinds>...>;
+
+    template<typename _Write>
+    static void Write( int kind, int value, _Write&& write )
+    {
+        using _Expander = int[];
+        (void)_Expander{ 0, ( kind == _Kinds ? ( write( KindMessage<_Kinds>{ kind, value, 0.5 } ), 0 ) : 0 )... };
+    }
+
+    template<typename _Handler>
+    static void ReadFrame( FrameReader<MemorySource>& reader, _Handler& handler )
+    {
+        using _Expander = int[];
+
+        bool handled = false;
+        (void)_Expander{ 0, ( handled || !reader.template Is<KindMessage<_Kinds>>() ? 0 : ( _ReadFrame<_Kinds>( reader, handler ), handled = true, 0 ) )... };
+    }
+
+    template<int _Kind, typename _Handler>
+    static void _ReadFrame( FrameReader<MemorySource>& reader, _Handler& handler )
+    {
+        KindMessage<_Kind> obj;
+        reader.Read( obj );
+
+        handler( obj );
+    }
+};
+
+template<int _Count>
+using KindMessages_t = KindMessages<std::make_integer_sequence<int, _Count>>;
+
+struct KindMessageSum
+{
+    template<int _Kind>
+    void operator()( const KindMessage<_Kind>& obj ) { sum += obj.value + _Kind; }
+
+    int64_t sum = 0;
+};
+
+constexpr int64_t kDispatchMessages = 1 << 16;
+
+template<int _Count>
+static void BM_DispatchFrameChain( benchmark::State& state )
+{
+    FrameWriter<MemorySink> writer;
+
+    for (int i = 0; i < kDispatchMessages; ++i) {
+        KindMessages_t<_Count>::Write( i % _Count, i, [&writer]( const auto& obj ) { writer.Write( obj ); } );
+    }
+
+    for (auto _ : state)
+    {
+        FrameReader<MemorySource> reader( MemorySource( writer.Sink().Data(), writer.Sink().Size() ) );
+        KindMessageSum handler;
+
+        while (reader.Next()) {
+            KindMessages_t<_Count>::ReadFrame( reader, handler );
+        }
+
+        benchmark::DoNotOptimize( handler.sum );
+    }
+
+    state.SetItemsProcessed( state.iterations() * kDispatchMessages );
+}
+
+template<int _Count>
+static void BM_DispatchJumpTable( benchmark::State& state )
+{
+    using codec_t = MessageCodec<typename KindMessages_t<_Count>::type>;
+
+    std::vector<unsigned char> buffer;
+
+    for (int i = 0; i < kDispatchMessages; ++i) {
+        KindMessages_t<_Count>::Write( i % _Count, i, [&buffer]( const auto& obj ) { codec_t::Encode( obj, buffer ); } );
+    }
+
+    for (auto _ : state)
+    {
+        KindMessageSum handler;
+        codec_t::DispatchAll( buffer.data(), buffer.size(), handler );
+
+        benchmark::DoNotOptimize( handler.sum );
+    }
+
+    state.SetItemsProcessed( state.iterations() * kDispatchMessages );
+}
+
+BENCHMARK_TEMPLATE( BM_DispatchFrameChain, 2 );
+BENCHMARK_TEMPLATE( BM_DispatchFrameChain, 8 );
+BENCHMARK_TEMPLATE( BM_DispatchFrameChain, 32 );
+BENCHMARK_TEMPLATE( BM_DispatchJumpTable, 2 );
+BENCHMARK_TEMPLATE( BM_DispatchJumpTable, 8 );
+BENCHMARK_TEMPLATE( BM_DispatchJumpTable, 32 );
+
+BENCHMARK_MAIN();
\ No newline at end of file
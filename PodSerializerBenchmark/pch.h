@@ -0,0 +1,90 @@
+//
+// pch.h
+// Header for standard system include files.
+//
+
+#pragma once
+
+//
+// Google Benchmark headers
+// 
+#include "benchmark/benchmark.h"
+
+
+//
+// Standard headers
+// 
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//
+// Project headers
+// 
+#include "../PodSerializer/Reflection.h"
+#include "../PodSerializer/Serialization.h"
+#include "../PodSerializer/StreamOperators.h"
+#include "../PodSerializer/SoaVector.h"
+#include "../PodSerializer/Aggregate.h"
+#include "../PodSerializer/Sort.h"
+
+#include "AllocationCounter.h"
+
+
+//
+// Project names
+//  
+
+// ../PodSerializer/Reflection.h
+using reflection::IsPaddingFree;
+using reflection::ToTuple;
+using reflection::ToTuplePrecise;
+using reflection::ToTuplePreciseView;
+using reflection::FromTuple;
+
+// ../PodSerializer/Serialization.h
+using serialization::BinarySerializer;
+using serialization::BinaryBuffer;
+using serialization::BinaryBatchSerializer;
+using serialization::BinaryBatchBuffer;
+using serialization::Scan;
+using serialization::LoadSelected;
+using serialization::FieldLess;
+using serialization::EncodeKey;
+using serialization::CompareKeys;
+using serialization::KeyPrefix;
+using serialization::MappedRecordFile;
+using serialization::ScatterGatherSink;
+using serialization::FrameWriter;
+using serialization::FrameReader;
+using serialization::MemorySink;
+using serialization::MemorySource;
+using serialization::MessageCodec;
+#if !defined(_WIN32)
+using serialization::WriteSegments;
+#endif // !defined(_WIN32)
+using serialization::InlineBinarySerializer;
+using serialization::InlineBinaryBuffer;
+using serialization::StringStreamBuffer;
+using serialization::WStringStreamBuffer;
+using io_text::TextWriter;
+using io_text::TextReader;
+
+// ../PodSerializer/SoaVector.h
+using columnar::SoaVector;
+
+// ../PodSerializer/Aggregate.h
+using columnar::Sum;
+using columnar::Min;
+
+// ../PodSerializer/Sort.h
+using columnar::SortByField;
+using columnar::SortByFieldParallel;
+
+// AllocationCounter.h
+using allocation_counter::GetAllocationsCount;
+using allocation_counter::ReportAllocations;
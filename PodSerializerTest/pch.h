@@ -11,6 +11,19 @@
 #include "gtest/gtest.h"
 
 
+//
+// Standard headers
+// 
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <tuple>
+#include <fstream>
+#include <set>
+#include <thread>
+
+
 //
 // Project headers
 // 
@@ -20,6 +33,9 @@
 #include "../PodSerializer/TypeList.h"
 #include "../PodSerializer/Tuple.h"
 #include "../PodSerializer/GetTypeList.h"
+#include "../PodSerializer/SoaVector.h"
+#include "../PodSerializer/Aggregate.h"
+#include "../PodSerializer/Sort.h"
 
 
 //
@@ -30,18 +46,76 @@
 using reflection::GetFieldsCount;
 using reflection::GetTypeIds;
 using reflection::ToTuple;
+using reflection::ToTupleView;
 using reflection::ToStandardTuple;
 using reflection::GetTypeList;
 using reflection::ToTuplePrecise;
+using reflection::ToTuplePreciseView;
 using reflection::ToStandardTuplePrecise;
+using reflection::FromTuple;
+using reflection::IsPaddingFree;
+using reflection::GetPackedSize;
+using reflection::Layout;
 
 // ../PodSerializer/Serialization.h
 using serialization::BinarySerializer;
 using serialization::BinaryBuffer;
+using serialization::BinaryBatchSerializer;
+using serialization::BinaryBatchBuffer;
+using serialization::BinaryBufferView;
+using serialization::Selection;
+using serialization::Scan;
+using serialization::LoadSelected;
+using serialization::FieldEqual;
+using serialization::FieldLess;
+using serialization::FieldInRange;
+using serialization::FieldHasBits;
+using serialization::EncodeKey;
+using serialization::EncodeKeyPrefix;
+using serialization::CompareKeys;
+using serialization::KeyPrefix;
+using serialization::MappedRecordFile;
+using serialization::mapped_read_only;
+using serialization::mapped_read_write;
+using serialization::mapped_truncate;
+using serialization::WriteAheadLog;
+using serialization::WriteAheadLogReader;
+using serialization::ScatterGatherSink;
+using serialization::TypeFingerprint;
+using serialization::FrameWriter;
+using serialization::FrameReader;
+using serialization::MemorySink;
+using serialization::MemorySource;
+using serialization::DescriptorSink;
+using serialization::DescriptorSource;
+using serialization::Message;
+using serialization::MessageCodec;
+using serialization::SegmentData;
+using serialization::SegmentSize;
+#if !defined(_WIN32)
+using serialization::WriteSegments;
+#endif // !defined(_WIN32)
+using serialization::InlineBinarySerializer;
+using serialization::InlineBinaryBuffer;
+using serialization::ExternalBinarySerializer;
+using serialization::ExternalBinaryBuffer;
+using serialization::ExternalStorage;
+using serialization::ArenaBinarySerializer;
+using serialization::ArenaBinaryBuffer;
+using serialization::ArenaStorage;
+using serialization::ArenaAllocator;
+using serialization::Arena;
 using serialization::StringStreamSerializer;
 using serialization::StringStreamBuffer;
 using serialization::WStringStreamSerializer;
 using serialization::WStringStreamBuffer;
+using io_text::TextWriter;
+using io_text::WTextWriter;
+using io_text::TextReader;
+using io_text::WTextReader;
+using io_text::TextFileWriter;
+using io_text::TextFileReader;
+using io_text::ReadTextFileParallel;
 
 // ../PodSerializer/TypeList.h
 using type_list::TypeList;
@@ -55,4 +129,20 @@ using types::Tuple;
 using types::ToStdTuple;
 
 //../PodSerializer/GetTypeList.h
-using reflection::GetTypeList;
\ No newline at end of file
+using reflection::GetTypeList;
+
+// ../PodSerializer/SoaVector.h
+using columnar::SoaVector;
+using columnar::ColumnSpan;
+using columnar::CacheLineSize;
+
+// ../PodSerializer/Aggregate.h
+using columnar::Sum;
+using columnar::Count;
+using columnar::Min;
+using columnar::Max;
+using columnar::Mean;
+
+// ../PodSerializer/Sort.h
+using columnar::SortByField;
+using columnar::SortByFieldParallel;
\ No newline at end of file
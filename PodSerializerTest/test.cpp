@@ -86,6 +86,16 @@ struct TwoFieldsTwoLevelsOfNestedStructs
 };
 #define TwoFieldsTwoLevelsOfNestedStructsCorrectAnswer 2
 
+//
+// Nested struct surrounded by smaller fields
+// 
+struct NestedBetweenChars
+{
+    char   field1;
+    Nested field2;
+    char   field3;
+};
+
 //
 // not-POD struct
 // 
@@ -97,6 +107,41 @@ struct NotPod
 };
 #define NotPodCorrectAnswer 3
 
+//
+// Struct without padding
+// 
+struct NoPadding
+{
+    int    field1;
+    short  field2;
+    char   field3;
+    char   field4;
+    double field5;
+};
+
+//
+// Struct with bool fields
+// 
+struct WithBool
+{
+    int    field1;
+    bool   field2;
+    double field3;
+    bool   field4;
+};
+
+//
+// Struct, that is smaller than 8 bytes, but its size
+// is not a power of two
+// 
+struct SixBytes
+{
+    short field1;
+    char  field2;
+    bool  field3;
+    short field4;
+};
+
 
 /************************************************************************************
  * Reflection tests
@@ -179,7 +224,13 @@ TEST(GetTypeIds, ContainsEnum)
 
     EXPECT_EQ( ids.data[0], 11 );
     EXPECT_EQ( ids.data[1],  5 );
-    EXPECT_EQ( ids.data[2],  8 );
+
+    //
+    // Underlying type of enumeration without fixed one is
+    // implementation-defined: MSVC uses 'int', GCC and Clang
+    // use 'unsigned int' if there are no negative values
+    //
+    EXPECT_EQ( ids.data[2], std::is_signed<std::underlying_type<TestEnum2>::type>::value ? 8 : 3 );
 }
 
 TEST(GetTypeIds, NestedStruct)
@@ -206,6 +257,72 @@ TEST(GetTypeIds, TwoLevelsOfNested)
     EXPECT_EQ( ids.data[3], 11 );
 }
 
+TEST(IsPaddingFree, Correctness)
+{
+    EXPECT_FALSE( IsPaddingFree<TwoFields>() );
+    EXPECT_FALSE( IsPaddingFree<TenFields>() );
+    EXPECT_FALSE( IsPaddingFree<ThreeFieldsWithNestedStruct>() );
+
+    EXPECT_TRUE( IsPaddingFree<NoPadding>() );
+}
+
+TEST(IsPaddingFree, PackedSize)
+{
+    EXPECT_EQ( GetPackedSize<TwoFields>(), sizeof( char ) + sizeof( int ) );
+    EXPECT_EQ( GetPackedSize<ThreeFieldsWithNestedStruct>(), sizeof( double ) + sizeof( int ) + 2 * sizeof( char ) );
+    EXPECT_EQ( GetPackedSize<NoPadding>(), sizeof( NoPadding ) );
+}
+
+TEST(Layout, Correctness)
+{
+    using layout_t = Layout<TwoFields>;
+
+    EXPECT_EQ( layout_t::count, 2 );
+
+    EXPECT_EQ( layout_t::ids.data[0], 11 );
+    EXPECT_EQ( layout_t::ids.data[1], 8  );
+
+    EXPECT_EQ( layout_t::offsets.data[0], offsetof( TwoFields, field1 ) );
+    EXPECT_EQ( layout_t::offsets.data[1], offsetof( TwoFields, field2 ) );
+
+    EXPECT_EQ( layout_t::sizes.data[0], sizeof( char ) );
+    EXPECT_EQ( layout_t::sizes.data[1], sizeof( int )  );
+
+    EXPECT_EQ( layout_t::alignments.data[0], alignof( char ) );
+    EXPECT_EQ( layout_t::alignments.data[1], alignof( int )  );
+
+    EXPECT_EQ( layout_t::packedOffsets.data[0], 0 );
+    EXPECT_EQ( layout_t::packedOffsets.data[1], sizeof( char ) );
+
+    EXPECT_EQ( layout_t::packedSize, sizeof( char ) + sizeof( int ) );
+}
+
+TEST(Layout, NestedStruct)
+{
+    using layout_t = Layout<NestedBetweenChars>;
+
+    EXPECT_EQ( layout_t::count, 4 );
+
+    EXPECT_EQ( layout_t::offsets.data[0], offsetof( NestedBetweenChars, field1 ) );
+    EXPECT_EQ( layout_t::offsets.data[1], offsetof( NestedBetweenChars, field2 ) + offsetof( Nested, field1 ) );
+    EXPECT_EQ( layout_t::offsets.data[2], offsetof( NestedBetweenChars, field2 ) + offsetof( Nested, field2 ) );
+    EXPECT_EQ( layout_t::offsets.data[3], offsetof( NestedBetweenChars, field3 ) );
+
+    EXPECT_EQ( layout_t::packedOffsets.data[3], sizeof( char ) + sizeof( int ) + sizeof( char ) );
+}
+
+TEST(Layout, TwoLevelsOfNested)
+{
+    using layout_t = Layout<TwoFieldsTwoLevelsOfNestedStructs>;
+
+    EXPECT_EQ( layout_t::count, 4 );
+
+    EXPECT_EQ( layout_t::offsets.data[0], 0  );
+    EXPECT_EQ( layout_t::offsets.data[1], 8  );
+    EXPECT_EQ( layout_t::offsets.data[2], 12 );
+    EXPECT_EQ( layout_t::offsets.data[3], 16 );
+}
+
 TEST(ToTuple, Correctness)
 {
     TwoFields two_fields{ 'a', 4 };
@@ -270,6 +387,57 @@ TEST(ToTuple, TwoLevelsOfNested)
     EXPECT_EQ( types::get<3>( three_tpl ), 'b' );
 }
 
+TEST(ToTuple, NestedBetweenChars)
+{
+    NestedBetweenChars three_fields{ 'a', { 42, 'b' }, 'c' };
+
+    auto three_tpl = ToTuple( three_fields );
+
+    EXPECT_EQ( three_tpl.Size(), 4 );
+
+    EXPECT_EQ( types::get<0>( three_tpl ), 'a' );
+    EXPECT_EQ( types::get<1>( three_tpl ), 42  );
+    EXPECT_EQ( types::get<2>( three_tpl ), 'b' );
+    EXPECT_EQ( types::get<3>( three_tpl ), 'c' );
+}
+
+TEST(ToTupleView, Correctness)
+{
+    NestedBetweenChars three_fields{ 'a', { 42, 'b' }, 'c' };
+
+    auto view = ToTupleView( three_fields );
+
+    EXPECT_EQ( &types::get<0>( view ), &three_fields.field1        );
+    EXPECT_EQ( &types::get<1>( view ), &three_fields.field2.field1 );
+    EXPECT_EQ( &types::get<2>( view ), &three_fields.field2.field2 );
+    EXPECT_EQ( &types::get<3>( view ), &three_fields.field3        );
+
+    types::get<1>( view ) = 13;
+    types::get<3>( view ) = 'd';
+
+    EXPECT_EQ( three_fields.field2.field1, 13  );
+    EXPECT_EQ( three_fields.field3,        'd' );
+}
+
+TEST(ToTupleView, Const)
+{
+    const ThreeFieldsWithNestedStruct three_fields{ 3.14, { 42, 'a' }, 'b' };
+
+    auto view = ToTupleView( three_fields );
+
+    static_assert( 
+        std::is_same<decltype( types::get<0>( view ) ), const double&>::value, 
+        "View of const object must contain const references" 
+    );
+
+    size_t count = 0;
+    types::for_each( view, [&count]( const auto& /* element */ ) { ++count; } );
+
+    EXPECT_EQ( count, 4 );
+    EXPECT_EQ( types::get<0>( view ), 3.14 );
+    EXPECT_EQ( types::get<3>( view ), 'b'  );
+}
+
 TEST(ToStandardTuple, Correctness)
 {
     TwoFields two_fields{ 'a', 4 };
@@ -385,6 +553,37 @@ TEST(ToTuplePrecise, NotPod)
     EXPECT_EQ( types::get<2>( three_tpl ), 3.14            );
 }
 
+TEST(ToTuplePreciseView, NotPod)
+{
+    NotPod three_fields{ 'a', "String inside", 3.14 };
+
+    auto view = ToTuplePreciseView( three_fields );
+
+    EXPECT_EQ( &types::get<1>( view ), &three_fields.field2 );
+
+    types::get<1>( view ) += " and outside";
+
+    EXPECT_EQ( three_fields.field2, "String inside and outside" );
+}
+
+TEST(ToTuplePreciseView, NestedStruct)
+{
+    const ThreeFieldsWithNestedStruct three_fields{ 3.14, { 42, 'a' }, 'b' };
+    Nested expected_second{ 42, 'a' };
+
+    auto view = ToTuplePreciseView( three_fields );
+
+    static_assert( 
+        std::is_same<decltype( types::get<1>( view ) ), const Nested&>::value, 
+        "View of const object must contain const references" 
+    );
+
+    EXPECT_EQ( &types::get<1>( view ), &three_fields.field2 );
+    EXPECT_EQ( types::get<0>( view ), 3.14            );
+    EXPECT_EQ( types::get<1>( view ), expected_second );
+    EXPECT_EQ( types::get<2>( view ), 'b'             );
+}
+
 TEST(ToStandardTuplePrecise, TwoFields)
 {
     TwoFields two_fields{ 'a', 42 };
@@ -440,222 +639,1661 @@ TEST(ToStandardTuplePrecise, NotPod)
     EXPECT_EQ( std::get<2>( three_tpl ), 3.14            );
 }
 
- 
+TEST(ToStandardTuplePrecise, RvalueTuple)
+{
+    NotPod three_fields{ 'a', "Long string, that does not fit into small buffer", 3.14 };
+
+    auto tpl       = ToTuplePrecise( three_fields );
+    auto three_tpl = ToStdTuple( std::move( tpl ) );
+
+    EXPECT_EQ( std::get<0>( three_tpl ), 'a'                                                );
+    EXPECT_EQ( std::get<1>( three_tpl ), "Long string, that does not fit into small buffer" );
+    EXPECT_EQ( std::get<2>( three_tpl ), 3.14                                               );
+    EXPECT_TRUE( types::get<1>( tpl ).empty() );
+}
+
+
 /************************************************************************************
- * Visual stream operators tests
+ * FromTuple tests
  */
 
-TEST(Operators, ostream)
+TEST(FromTuple, NotPod)
 {
-    using namespace io_operators;
-    
-    std::cout << "It is a visual test.\n" << std::endl;
+    NotPod original{ 'a', "String inside", 3.14 };
 
-    TenFields ten_fields{ 'a', 25, 4, 3.14, 0, 'b', 54, 32, 2.71, 9 };
+    const auto tpl = ToTuplePrecise( original );
+    auto restored  = FromTuple<NotPod>( tpl );
 
-    std::cout << ten_fields << std::endl;
-    std::cout << beautiful_struct << ten_fields << no_beautiful_struct << std::endl;
+    EXPECT_EQ( restored.field1, 'a'             );
+    EXPECT_EQ( restored.field2, "String inside" );
+    EXPECT_EQ( restored.field3, 3.14            );
+    EXPECT_EQ( types::get<1>( tpl ), "String inside" );
 }
 
-TEST(Operators, wostream)
+TEST(FromTuple, RvalueTuple)
 {
-    using namespace io_operators;
-    
-    std::wcout << L"It is a visual test.\n" << std::endl;
+    NotPod original{ 'a', "Long string, that does not fit into small buffer", 3.14 };
 
-    TenFields ten_fields{ 'a', 25, 4, 3.14, 0, 'b', 54, 32, 2.71, 9 };
+    auto tpl      = ToTuplePrecise( original );
+    auto restored = FromTuple<NotPod>( std::move( tpl ) );
 
-    std::wcout << ten_fields << std::endl;
-    std::wcout << beautiful_struct << ten_fields << no_beautiful_struct << std::endl;
+    EXPECT_EQ( restored.field1, 'a'                                                );
+    EXPECT_EQ( restored.field2, "Long string, that does not fit into small buffer" );
+    EXPECT_EQ( restored.field3, 3.14                                               );
+    EXPECT_TRUE( types::get<1>( tpl ).empty() );
 }
 
-TEST(Operators, ostreamNotPod)
+ 
+/************************************************************************************
+ * Text writer tests
+ */
+
+TEST(TextWriter, Plain)
 {
-    using namespace io_operators;
-    
-    std::cout << "It is a visual test.\n" << std::endl;
+    TenFields ten_fields{ 'a', 25, -4, 3.14, 0, 'b', 54, 32, 2.5, 9 };
 
-    NotPod three_fields{ 'a', "String to print", 3.14 };
+    TextWriter writer;
+    writer.Write( ten_fields );
 
-    std::cout << three_fields << std::endl;
-    std::cout << beautiful_struct << three_fields << no_beautiful_struct << std::endl;
+    EXPECT_EQ( writer.Str(), "a 25 -4 3.14 0 b 54 32 2.5 9" );
 }
 
-TEST(Operators, ostreamNested)
+TEST(TextWriter, Separator)
 {
-    using namespace io_operators;
-    
-    std::cout << "It is a visual test.\n" << std::endl;
+    ThreeFieldsWithEnum three_fields{ 'a', second1, second2 };
 
-    ThreeFieldsWithNestedStruct three_fields{ 3.14, { 42, 'a' }, 'b' };
+    TextWriter writer( ';' );
+    writer.Write( three_fields );
 
-    std::cout << three_fields << std::endl;
-    std::cout << beautiful_struct << three_fields << no_beautiful_struct << std::endl;
+    EXPECT_EQ( writer.Str(), "a;1;1" );
 }
 
+TEST(TextWriter, BeautifulNested)
+{
+    TwoFieldsTwoLevelsOfNestedStructs two_fields{ 42, { 'a', { -5, 'b' } } };
+
+    TextWriter writer;
+    writer.SetBeautiful( true );
+    writer.Write( two_fields );
 
-/************************************************************************************
- * Serialization tests
- */
+    EXPECT_EQ( writer.Str(), "{ 42, { a, { -5, b } } }" );
+}
 
-TEST(Serialization, Binary)
+TEST(TextWriter, SameAsOperators)
 {
-    TwoFields original{ 2, 4 };
+    using namespace io_operators;
 
-    BinarySerializer<TwoFields> serializer;
-    BinaryBuffer<TwoFields> buffer;
+    NotPod three_fields{ 'a', "String to print", 3.25 };
 
-    EXPECT_TRUE( buffer.IsEmpty() );
+    std::ostringstream stream;
+    stream << beautiful_struct << three_fields;
 
-    serializer.Serialize( original, buffer );
+    TextWriter writer;
+    writer.SetBeautiful( true );
+    writer.Write( three_fields );
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+    EXPECT_EQ( writer.Str(), stream.str() );
 
-    TwoFields loaded{ 0, 0 };
+    TwoFields two_fields{ 'a', 4 };
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
+    std::wostringstream wstream;
+    wstream << two_fields;
 
-    serializer.Deserialize( loaded, buffer );
+    WTextWriter wwriter;
+    wwriter.Write( two_fields );
 
-    EXPECT_EQ( loaded.field1, original.field1 );
-    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( wwriter.Str(), wstream.str() );
 }
- 
-TEST(Serialization, BinaryContainsEnum)
-{
-    ThreeFieldsWithEnum original{ 'a', first1, second2 };
 
-    BinarySerializer<ThreeFieldsWithEnum> serializer;
-    BinaryBuffer<ThreeFieldsWithEnum> buffer;
 
-    EXPECT_TRUE( buffer.IsEmpty() );
+/************************************************************************************
+ * Text reader tests
+ */
 
-    serializer.Serialize( original, buffer );
+TEST(TextReader, Plain)
+{
+    TenFields original{ 'a', 25, -4, 3.14, 0, 'b', 54, 32, 2.5, 9 };
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+    TextWriter writer( ';' );
+    writer.Write( original );
 
-    ThreeFieldsWithEnum loaded{ 'b', second1, first2 };
+    TenFields loaded{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
-    EXPECT_NE( loaded.field3, original.field3 );
+    TextReader reader( writer.Data(), writer.Size(), ';' );
+    reader.Read( loaded );
 
-    serializer.Deserialize( loaded, buffer );
+    EXPECT_TRUE( reader.IsEnd() );
 
     EXPECT_EQ( loaded.field1, original.field1 );
     EXPECT_EQ( loaded.field2, original.field2 );
     EXPECT_EQ( loaded.field3, original.field3 );
+    EXPECT_EQ( loaded.field4, original.field4 );
+    EXPECT_EQ( loaded.field5, original.field5 );
+    EXPECT_EQ( loaded.field6, original.field6 );
+    EXPECT_EQ( loaded.field7, original.field7 );
+    EXPECT_EQ( loaded.field8, original.field8 );
+    EXPECT_EQ( loaded.field9, original.field9 );
+    EXPECT_EQ( loaded.field10, original.field10 );
 }
 
-TEST(Serialization, StringStream)
+TEST(TextReader, NotPod)
 {
-    TwoFields original{ 2, 4 };
+    NotPod original{ 'a', "String with spaces", -0.1 };
 
-    StringStreamSerializer<TwoFields> serializer;
-    StringStreamBuffer<TwoFields> buffer;
+    const char text[] = "a" "\0" "String with spaces" "\0" "-0.1";
 
-    EXPECT_TRUE( buffer.IsEmpty() );
+    NotPod loaded{ 0, "", 0 };
 
-    serializer.Serialize( original, buffer );
+    TextReader reader( text, sizeof( text ) - 1, '\0' );
+    reader.Read( loaded );
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
 
-    TwoFields loaded{ 0, 0 };
+TEST(TextReader, Wide)
+{
+    ThreeFieldsWithEnum original{ 'b', second1, second2 };
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
+    WTextWriter writer( L'\0' );
+    writer.Write( original );
 
-    serializer.Deserialize( loaded, buffer );
+    ThreeFieldsWithEnum loaded{ 0, first1, first2 };
+
+    WTextReader reader( writer.Data(), writer.Size(), L'\0' );
+    reader.Read( loaded );
 
     EXPECT_EQ( loaded.field1, original.field1 );
     EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
 }
 
-TEST(Serialization, NestedStruct)
+TEST(TextReader, SameAsOperators)
 {
-    ThreeFieldsWithNestedStruct original{ 3.14, { 42, 'a' }, 'b' };
-    
-    StringStreamSerializer<ThreeFieldsWithNestedStruct> serializer;
-    StringStreamBuffer<ThreeFieldsWithNestedStruct> buffer;
+    using namespace io_operators;
 
-    EXPECT_TRUE( buffer.IsEmpty() );
+    //
+    // Fields, that can not be parsed by fast path,
+    // must be parsed exactly as stream operators do it
+    //
+    const char* texts[] = {
+        "+1.5; 42;a;b",
+        "abc;-;;",
+        "1e400;99999999999; ;\tc",
+        "-inf;0x10;x",
+        "2.5;7",
+        ""
+    };
+
+    for (auto text : texts)
+    {
+        ThreeFieldsWithNestedStruct expected{ 1, { 1, 'z' }, 'z' };
+
+        std::istringstream stream( text );
+        stream >> io_manipulators::io_internal::set_separator( ';' ) >> expected;
+
+        ThreeFieldsWithNestedStruct loaded{ 1, { 1, 'z' }, 'z' };
+
+        TextReader reader( text, std::strlen( text ), ';' );
+        reader.Read( loaded );
+
+        EXPECT_EQ( loaded.field1, expected.field1 ) << text;
+        EXPECT_EQ( loaded.field2, expected.field2 ) << text;
+        EXPECT_EQ( loaded.field3, expected.field3 ) << text;
+    }
+}
+ 
+/************************************************************************************
+ * Text file tests
+ */
 
-    serializer.Serialize( original, buffer );
+TEST(TextFile, ReadWrite)
+{
+    const char* path = "TextFile.ReadWrite.txt";
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+    //
+    // Small block: records are split between blocks,
+    // and long strings don't fit into block at all
+    //
+    {
+        TextFileWriter<NotPod> writer( path, ';', '\n', 64 );
 
-    ThreeFieldsWithNestedStruct loaded{ 2.71, { -5, 'c' }, 'd' };
+        for (int i = 0; i < 1000; ++i) {
+            writer.Write( NotPod{ static_cast<char>( 'a' + i % 26 ), std::string( i % 100, 'x' ), i * 0.5 } );
+        }
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
+        writer.Flush();
 
-    serializer.Deserialize( loaded, buffer );
+        EXPECT_EQ( writer.Count(), 1000 );
+    }
 
-    EXPECT_EQ( loaded.field1, original.field1 );
-    EXPECT_EQ( loaded.field2, original.field2 );
+    {
+        TextFileReader<NotPod> reader( path, ';', '\n', 64 );
+
+        NotPod loaded{ 0, "", 0 };
+        int count = 0;
+
+        const uint64_t fileSize = reader.FileSize();
+
+        while (reader.Read( loaded ))
+        {
+            EXPECT_EQ( loaded.field1, static_cast<char>( 'a' + count % 26 ) );
+            EXPECT_EQ( loaded.field2, std::string( count % 100, 'x' ) );
+            EXPECT_EQ( loaded.field3, count * 0.5 );
+
+            //
+            // Size of file doesn't affect position of reader
+            //
+            if (count % 100 == 0) {
+                EXPECT_EQ( reader.FileSize(), fileSize );
+            }
+
+            ++count;
+        }
+
+        EXPECT_EQ( count, 1000 );
+    }
+
+    std::remove( path );
 }
 
-TEST(Serialization, StringStreamContainsEnum)
+TEST(TextFile, NoTrailingDelimiter)
 {
-    ThreeFieldsWithEnum original{ 'a', first1, second2 };
+    const char* path = "TextFile.NoTrailingDelimiter.txt";
 
-    StringStreamSerializer<ThreeFieldsWithEnum> serializer;
-    StringStreamBuffer<ThreeFieldsWithEnum> buffer;
-
-    EXPECT_TRUE( buffer.IsEmpty() );
+    {
+        std::ofstream file( path, std::ios::binary );
+        file << "a;1\nb;-2";
+    }
 
-    serializer.Serialize( original, buffer );
+    {
+        TextFileReader<TwoFields> reader( path, ';' );
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+        TwoFields loaded{ 0, 0 };
 
-    ThreeFieldsWithEnum loaded{ 'b', second1, first2 };
+        EXPECT_TRUE( reader.Read( loaded ) );
+        EXPECT_EQ( loaded.field1, 'a' );
+        EXPECT_EQ( loaded.field2, 1 );
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
-    EXPECT_NE( loaded.field3, original.field3 );
+        EXPECT_TRUE( reader.Read( loaded ) );
+        EXPECT_EQ( loaded.field1, 'b' );
+        EXPECT_EQ( loaded.field2, -2 );
 
-    serializer.Deserialize( loaded, buffer );
+        EXPECT_FALSE( reader.Read( loaded ) );
+    }
 
-    EXPECT_EQ( loaded.field1, original.field1 );
-    EXPECT_EQ( loaded.field2, original.field2 );
-    EXPECT_EQ( loaded.field3, original.field3 );
+    std::remove( path );
 }
 
-TEST(Serialization, StringStreamNotPod)
+TEST(TextFile, ReadParallel)
 {
-    NotPod original{ 'a', "Serialized\n string", 3.14 };
+    const char* path = "TextFile.ReadParallel.txt";
 
-    StringStreamSerializer<NotPod> serializer;
-    StringStreamBuffer<NotPod> buffer;
+    {
+        TextFileWriter<NotPod> writer( path, ';' );
 
-    EXPECT_TRUE( buffer.IsEmpty() );
+        for (int i = 0; i < 5000; ++i) {
+            writer.Write( NotPod{ static_cast<char>( 'a' + i % 26 ), std::string( i % 50, 'x' ), i * 0.5 } );
+        }
+    }
 
-    serializer.Serialize( original, buffer );
+    //
+    // Chunks of one char: most of them contain no
+    // records, others contain exactly one record
+    //
+    for (uint64_t chunkSize : { 1, 100, 4096, 1 << 20 })
+    {
+        auto chunks = ReadTextFileParallel<NotPod>( path, ';', '\n', 4, chunkSize );
 
-    EXPECT_FALSE( buffer.IsEmpty() );
+        int count = 0;
 
-    NotPod loaded{ 'b', "Another string", 2.71 };
+        for (const auto& chunk : chunks)
+        {
+            for (const auto& loaded : chunk)
+            {
+                EXPECT_EQ( loaded.field1, static_cast<char>( 'a' + count % 26 ) );
+                EXPECT_EQ( loaded.field2, std::string( count % 50, 'x' ) );
+                EXPECT_EQ( loaded.field3, count * 0.5 );
 
-    EXPECT_NE( loaded.field1, original.field1 );
-    EXPECT_NE( loaded.field2, original.field2 );
-    EXPECT_NE( loaded.field3, original.field3 );
+                ++count;
+            }
+        }
 
-    serializer.Deserialize( loaded, buffer );
+        EXPECT_EQ( count, 5000 ) << chunkSize;
+    }
 
-    EXPECT_EQ( loaded.field1, original.field1 );
-    EXPECT_EQ( loaded.field2, original.field2 );
-    EXPECT_EQ( loaded.field3, original.field3 );
+    std::remove( path );
+
+    EXPECT_THROW( ReadTextFileParallel<NotPod>( path, ';' ), std::runtime_error );
+}
+
+TEST(TextFile, InvalidDelimiter)
+{
+    EXPECT_THROW( TextFileWriter<TwoFields>( "TextFile.InvalidDelimiter.txt", '\n', '\n' ), std::invalid_argument );
+    EXPECT_THROW( TextFileReader<TwoFields>( "TextFile.DoesNotExist.txt", ';' ), std::runtime_error );
 }
 
 
 /************************************************************************************
- * Typelist tests
+ * Mapped record file tests
  */
 
-TEST(TypeList, Size)
+TEST(MappedRecordFile, AppendAndRead)
 {
-    TypeList<double, int, std::string, short> tl;
+    const char* path = "MappedRecordFile.AppendAndRead.bin";
+
+    //
+    // More records than one step of growth takes
+    //
+    std::vector<TenFields> objs( 10000 );
+    for (int i = 0; i < static_cast<int>( objs.size() ); ++i) {
+        objs[i] = TenFields{ 'a', i, -i, i * 0.5, 1, 'b', 2, 3, -i * 0.25, 4 };
+    }
+
+    {
+        MappedRecordFile<TenFields> file( path, mapped_truncate, 1000 );
+
+        file.Append( objs[0] );
+        file.AppendRange( objs.begin() + 1, objs.begin() + 5000 );
+
+        for (size_t i = 5000; i < objs.size(); ++i) {
+            file.Append( objs[i] );
+        }
+
+        EXPECT_EQ( file.Count(), objs.size() );
+
+        TenFields obj;
+        file.Load( obj, 1234 );
+
+        EXPECT_EQ( obj.field2, 1234 );
+        EXPECT_THROW( file.Load( obj, objs.size() ), std::out_of_range );
+    }
+
+    //
+    // File is truncated to exact size of records
+    //
+    std::ifstream stream( path, std::ios::binary | std::ios::ate );
+    EXPECT_EQ( static_cast<size_t>( stream.tellg() ), objs.size() * MappedRecordFile<TenFields>::RecordSize() );
+    stream.close();
+
+    {
+        MappedRecordFile<TenFields> file( path, mapped_read_write );
+        file.Append( objs[0] );
+    }
+
+    {
+        MappedRecordFile<TenFields> file( path, mapped_read_only );
+        ASSERT_EQ( file.Count(), objs.size() + 1 );
+
+        size_t index = 0;
+        file.ForEach( [&objs, &index]( const TenFields& obj ) {
+            const auto& expected = objs[index++ % objs.size()];
+
+            EXPECT_EQ( obj.field2, expected.field2 );
+            EXPECT_EQ( obj.field9, expected.field9 );
+        } );
+
+        EXPECT_EQ( index, objs.size() + 1 );
+
+        std::vector<TenFields> loaded;
+        file.LoadRange( loaded );
+
+        EXPECT_EQ( loaded.size(), objs.size() + 1 );
+        EXPECT_EQ( loaded[9999].field3, -9999 );
+
+        //
+        // Records are scanned right in mapping
+        //
+        auto selection = Scan( file.View(), FieldLess<1>( 10 ) );
+        EXPECT_EQ( selection.Count(), 11 );
+
+        EXPECT_THROW( file.Append( objs[0] ), std::logic_error );
+    }
+
+    std::remove( path );
+}
+
+TEST(MappedRecordFile, FlushWithoutClose)
+{
+    const char* path1 = "MappedRecordFile.FlushWithoutClose1.bin";
+    const char* path2 = "MappedRecordFile.FlushWithoutClose2.bin";
+
+    //
+    // File is read by another object, while writer is still
+    // open, i.e. file is in the same state as after crash.
+    // Size of TwoFields record doesn't divide size of growth,
+    // size of NoPadding record does.
+    //
+    {
+        MappedRecordFile<TwoFields> writer( path1, mapped_truncate );
+
+        writer.Append( TwoFields{ 'a', 1 } );
+        writer.Append( TwoFields{ 'b', 2 } );
+        writer.Flush();
+
+        {
+            MappedRecordFile<TwoFields> reader( path1, mapped_read_only );
+            ASSERT_EQ( reader.Count(), 2 );
+
+            TwoFields obj;
+            reader.Load( obj, 1 );
+
+            EXPECT_EQ( obj.field1, 'b' );
+            EXPECT_EQ( obj.field2, 2 );
+        }
+
+        //
+        // File grows again after flush
+        //
+        for (int i = 0; i < 20000; ++i) {
+            writer.Append( TwoFields{ 'c', i } );
+        }
+
+        writer.Flush();
+
+        MappedRecordFile<TwoFields> reader( path1, mapped_read_only );
+        ASSERT_EQ( reader.Count(), 20002 );
+
+        TwoFields obj;
+        reader.Load( obj, 20001 );
+
+        EXPECT_EQ( obj.field2, 19999 );
+    }
+
+    {
+        MappedRecordFile<NoPadding> writer( path2, mapped_truncate );
+
+        writer.Append( NoPadding{ 1, 2, 'a', 'b', 0.5 } );
+        writer.Flush();
+
+        MappedRecordFile<NoPadding> reader( path2, mapped_read_only );
+        ASSERT_EQ( reader.Count(), 1 );
+
+        NoPadding obj;
+        reader.Load( obj, 0 );
+
+        EXPECT_EQ( obj.field1, 1 );
+        EXPECT_EQ( obj.field5, 0.5 );
+    }
+
+    std::remove( path1 );
+    std::remove( path2 );
+}
+
+//
+// Iterator, that throws when the record 'bad' is read
+//
+template<typename _Category>
+struct ThrowingIterator
+{
+    using iterator_category = _Category;
+    using value_type        = TwoFields;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const TwoFields*;
+    using reference         = const TwoFields&;
+
+    const TwoFields* current;
+    const TwoFields* bad;
+
+    reference operator*() const
+    {
+        if (current == bad) {
+            throw std::runtime_error( "Record can not be read" );
+        }
+
+        return *current;
+    }
+
+    ThrowingIterator& operator++() { ++current; return *this; }
+    ThrowingIterator operator++( int ) { auto copy = *this; ++current; return copy; }
+
+    bool operator==( const ThrowingIterator& other ) const { return current == other.current; }
+    bool operator!=( const ThrowingIterator& other ) const { return current != other.current; }
+};
+
+template<typename _Category>
+void CheckThrowingAppendRange( const char* path )
+{
+    const TwoFields objs[] = { { 'a', 1 }, { 'b', 2 }, { 'c', 3 }, { 'd', 4 } };
+
+    {
+        MappedRecordFile<TwoFields> file( path, mapped_truncate );
+
+        ThrowingIterator<_Category> first{ objs, objs + 2 };
+        ThrowingIterator<_Category> last{ objs + 4, objs + 2 };
+
+        EXPECT_THROW( file.AppendRange( first, last ), std::runtime_error );
+        EXPECT_EQ( file.Count(), 2 );
+
+        file.Append( objs[3] );
+    }
+
+    MappedRecordFile<TwoFields> file( path, mapped_read_only );
+    ASSERT_EQ( file.Count(), 3 );
+
+    TwoFields obj;
+    file.Load( obj, 2 );
+
+    EXPECT_EQ( obj.field1, 'd' );
+
+    file.Close();
+    std::remove( path );
+}
+
+TEST(MappedRecordFile, AppendRangeThrows)
+{
+    //
+    // Records, that are not read, are not counted
+    //
+    CheckThrowingAppendRange<std::input_iterator_tag>( "MappedRecordFile.AppendRangeThrows1.bin" );
+    CheckThrowingAppendRange<std::forward_iterator_tag>( "MappedRecordFile.AppendRangeThrows2.bin" );
+}
+
+TEST(MappedRecordFile, InvalidFile)
+{
+    const char* path = "MappedRecordFile.InvalidFile.bin";
+
+    EXPECT_THROW( MappedRecordFile<TwoFields>( "MappedRecordFile.DoesNotExist.bin", mapped_read_only ), std::runtime_error );
+
+    {
+        MappedRecordFile<TwoFields> file( path, mapped_truncate );
+        EXPECT_TRUE( file.IsEmpty() );
+        EXPECT_TRUE( file.View().IsEmpty() );
+    }
+
+    {
+        std::ofstream stream( path, std::ios::binary );
+        stream << "abc";
+    }
+
+    //
+    // Size of file is not a multiple of size of record
+    //
+    EXPECT_THROW( MappedRecordFile<TwoFields>( path, mapped_read_only ), std::runtime_error );
+
+    std::remove( path );
+}
+
+/************************************************************************************
+ * Write-ahead log tests
+ */
+
+TEST(WriteAheadLog, GroupCommit)
+{
+    const char* path = "WriteAheadLog.GroupCommit.log";
+    std::remove( path );
+
+    const int threadsCount = 8;
+    const int recordsCount = 100;
+
+    {
+        WriteAheadLog<TwoFields> log( path );
+        std::vector<std::thread> threads;
+
+        //
+        // Writers are released together, so they append
+        // while one of them is syncing the file
+        //
+        std::atomic<int> ready{ 0 };
+
+        for (int thread = 0; thread < threadsCount; ++thread)
+        {
+            threads.emplace_back( [&log, &ready, thread, threadsCount, recordsCount]() {
+                ++ready;
+                while (ready < threadsCount) {
+                    std::this_thread::yield();
+                }
+
+                for (int i = 0; i < recordsCount; ++i) {
+                    log.Append( TwoFields{ static_cast<char>( 'a' + thread ), thread * recordsCount + i } );
+                }
+            } );
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        //
+        // Records of several writers are synced by one commit
+        //
+        EXPECT_EQ( log.Count(), threadsCount * recordsCount );
+        EXPECT_LT( log.CommitsCount(), log.Count() );
+    }
+
+    WriteAheadLogReader<TwoFields> reader( path );
+
+    std::set<int> values;
+    std::vector<int> last( threadsCount, -1 );
+
+    TwoFields obj;
+    while (reader.Read( obj ))
+    {
+        //
+        // Records of each thread are in order
+        //
+        int thread = obj.field1 - 'a';
+
+        EXPECT_LT( last[thread], obj.field2 );
+        last[thread] = obj.field2;
+
+        values.insert( obj.field2 );
+    }
+
+    EXPECT_FALSE( reader.IsTorn() );
+    EXPECT_EQ( values.size(), threadsCount * recordsCount );
+    EXPECT_EQ( *values.rbegin(), threadsCount * recordsCount - 1 );
+
+    std::remove( path );
+}
+
+TEST(WriteAheadLog, TornTail)
+{
+    const char* path = "WriteAheadLog.TornTail.log";
+    std::remove( path );
+
+    {
+        WriteAheadLog<ThreeFieldsWithNestedStruct> log( path );
+
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ( log.Append( ThreeFieldsWithNestedStruct{ i * 0.5, { i, 'a' }, 'b' } ), static_cast<size_t>( i ) );
+        }
+    }
+
+    //
+    // Incomplete frame after the last one
+    //
+    {
+        std::ofstream stream( path, std::ios::binary | std::ios::app );
+        stream.write( "\x0E\0\0\0\x01", 5 );
+    }
+
+    {
+        WriteAheadLogReader<ThreeFieldsWithNestedStruct> reader( path );
+
+        ThreeFieldsWithNestedStruct obj;
+        while (reader.Read( obj )) { }
+
+        EXPECT_EQ( reader.Count(), 10 );
+        EXPECT_TRUE( reader.IsTorn() );
+    }
+
+    //
+    // Damaged byte in the last record
+    //
+    {
+        std::fstream stream( path, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate );
+        stream.seekp( -10, std::ios::end );
+        stream.put( 'x' );
+    }
+
+    {
+        WriteAheadLog<ThreeFieldsWithNestedStruct> log( path );
+
+        EXPECT_EQ( log.Count(), 9 );
+        EXPECT_EQ( log.Append( ThreeFieldsWithNestedStruct{ 42.0, { 42, 'c' }, 'd' } ), 9 );
+    }
+
+    WriteAheadLogReader<ThreeFieldsWithNestedStruct> reader( path );
+
+    ThreeFieldsWithNestedStruct obj{};
+    ThreeFieldsWithNestedStruct lastObj{};
+
+    while (reader.Read( obj )) {
+        lastObj = obj;
+    }
+
+    EXPECT_EQ( reader.Count(), 10 );
+    EXPECT_FALSE( reader.IsTorn() );
+    EXPECT_EQ( lastObj.field2.field1, 42 );
+
+    std::remove( path );
+}
+
+
+/************************************************************************************
+ * Visual stream operators tests
+ */
+
+TEST(Operators, ostream)
+{
+    using namespace io_operators;
+    
+    std::cout << "It is a visual test.\n" << std::endl;
+
+    TenFields ten_fields{ 'a', 25, 4, 3.14, 0, 'b', 54, 32, 2.71, 9 };
+
+    std::cout << ten_fields << std::endl;
+    std::cout << beautiful_struct << ten_fields << no_beautiful_struct << std::endl;
+}
+
+TEST(Operators, wostream)
+{
+    using namespace io_operators;
+    
+    std::wcout << L"It is a visual test.\n" << std::endl;
+
+    TenFields ten_fields{ 'a', 25, 4, 3.14, 0, 'b', 54, 32, 2.71, 9 };
+
+    std::wcout << ten_fields << std::endl;
+    std::wcout << beautiful_struct << ten_fields << no_beautiful_struct << std::endl;
+}
+
+TEST(Operators, ostreamNotPod)
+{
+    using namespace io_operators;
+    
+    std::cout << "It is a visual test.\n" << std::endl;
+
+    NotPod three_fields{ 'a', "String to print", 3.14 };
+
+    std::cout << three_fields << std::endl;
+    std::cout << beautiful_struct << three_fields << no_beautiful_struct << std::endl;
+}
+
+TEST(Operators, ostreamNested)
+{
+    using namespace io_operators;
+    
+    std::cout << "It is a visual test.\n" << std::endl;
+
+    ThreeFieldsWithNestedStruct three_fields{ 3.14, { 42, 'a' }, 'b' };
+
+    std::cout << three_fields << std::endl;
+    std::cout << beautiful_struct << three_fields << no_beautiful_struct << std::endl;
+}
+
+
+/************************************************************************************
+ * Serialization tests
+ */
+
+TEST(Serialization, Binary)
+{
+    TwoFields original{ 2, 4 };
+
+    BinarySerializer<TwoFields> serializer;
+    BinaryBuffer<TwoFields> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    TwoFields loaded{ 0, 0 };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+}
+ 
+TEST(Serialization, BinaryContainsEnum)
+{
+    ThreeFieldsWithEnum original{ 'a', first1, second2 };
+
+    BinarySerializer<ThreeFieldsWithEnum> serializer;
+    BinaryBuffer<ThreeFieldsWithEnum> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    ThreeFieldsWithEnum loaded{ 'b', second1, first2 };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+    EXPECT_NE( loaded.field3, original.field3 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, BinaryPaddingFree)
+{
+    NoPadding original{ 42, -5, 'a', 'b', 3.14 };
+
+    BinarySerializer<NoPadding> serializer;
+    BinaryBuffer<NoPadding> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    NoPadding loaded{ 0, 0, 0, 0, 0.0 };
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+    EXPECT_EQ( loaded.field4, original.field4 );
+    EXPECT_EQ( loaded.field5, original.field5 );
+}
+
+TEST(Serialization, BinaryNestedStruct)
+{
+    NestedBetweenChars original{ 'a', { 42, 'b' }, 'c' };
+
+    BinarySerializer<NestedBetweenChars> serializer;
+    BinaryBuffer<NestedBetweenChars> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    NestedBetweenChars loaded{ 'd', { -5, 'e' }, 'f' };
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, BinaryBatch)
+{
+    std::vector<NestedBetweenChars> original{
+        { 'a', { 42, 'b' }, 'c' },
+        { 'd', { -5, 'e' }, 'f' },
+        { 'g', { 17, 'h' }, 'i' }
+    };
+
+    BinaryBatchSerializer<NestedBetweenChars> serializer;
+    BinaryBatchBuffer<NestedBetweenChars> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.SerializeRange( original.begin(), original.end(), buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+    EXPECT_EQ( buffer.Count(), original.size() );
+
+    std::vector<NestedBetweenChars> loaded;
+    serializer.DeserializeRange( loaded, buffer );
+
+    ASSERT_EQ( loaded.size(), original.size() );
+
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+        EXPECT_EQ( loaded[i].field1, original[i].field1 );
+        EXPECT_EQ( loaded[i].field2, original[i].field2 );
+        EXPECT_EQ( loaded[i].field3, original[i].field3 );
+    }
+
+    NestedBetweenChars single{};
+    serializer.Deserialize( single, buffer, 1 );
+
+    EXPECT_EQ( single.field1, original[1].field1 );
+    EXPECT_EQ( single.field2, original[1].field2 );
+    EXPECT_EQ( single.field3, original[1].field3 );
+}
+
+TEST(Serialization, BinaryBatchOutputIterator)
+{
+    std::vector<TwoFields> original{ { 'a', 1 }, { 'b', 2 } };
+
+    BinaryBatchSerializer<TwoFields> serializer;
+    BinaryBatchBuffer<TwoFields> buffer;
+
+    for (const auto& obj : original) {
+        serializer.Serialize( obj, buffer );
+    }
+
+    EXPECT_EQ( buffer.Count(), original.size() );
+
+    std::vector<TwoFields> loaded;
+    serializer.DeserializeRange( std::back_inserter( loaded ), buffer );
+
+    ASSERT_EQ( loaded.size(), original.size() );
+
+    EXPECT_EQ( loaded[0].field1, 'a' );
+    EXPECT_EQ( loaded[0].field2, 1   );
+    EXPECT_EQ( loaded[1].field1, 'b' );
+    EXPECT_EQ( loaded[1].field2, 2   );
+}
+
+TEST(Serialization, BinaryRawBytes)
+{
+    NestedBetweenChars original{ 'a', { 42, 'b' }, 'c' };
+
+    BinarySerializer<NestedBetweenChars> serializer;
+    BinaryBuffer<NestedBetweenChars> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_EQ( buffer.Size(), GetPackedSize<NestedBetweenChars>() );
+
+    //
+    // Copy bytes somewhere else (like a file or a socket would do)
+    // 
+    std::vector<unsigned char> bytes( buffer.Data(), buffer.Data() + buffer.Size() );
+
+    BinaryBuffer<NestedBetweenChars> copied( bytes.data(), bytes.size() );
+
+    EXPECT_FALSE( copied.IsEmpty() );
+
+    NestedBetweenChars loaded{};
+    serializer.Deserialize( loaded, copied );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+
+    EXPECT_THROW( BinaryBuffer<NestedBetweenChars>( bytes.data(), bytes.size() - 1 ), std::invalid_argument );
+}
+
+TEST(Serialization, BinaryBufferView)
+{
+    std::vector<TwoFields> original{ { 'a', 1 }, { 'b', 2 } };
+
+    BinaryBatchBuffer<TwoFields> batch;
+    batch.SaveRange( original.begin(), original.end() );
+
+    std::vector<unsigned char> bytes( batch.Data(), batch.Data() + batch.Size() );
+
+    BinaryBufferView<TwoFields> view( bytes.data(), bytes.size() );
+
+    EXPECT_FALSE( view.IsEmpty() );
+    EXPECT_EQ( view.Count(), original.size() );
+
+    TwoFields loaded{ 0, 0 };
+
+    view.Load( loaded, 1 );
+
+    EXPECT_EQ( loaded.field1, 'b' );
+    EXPECT_EQ( loaded.field2, 2   );
+
+    EXPECT_THROW( view.Load( loaded, 2 ), std::out_of_range );
+    EXPECT_THROW( BinaryBufferView<TwoFields>( bytes.data(), bytes.size() - 1 ), std::invalid_argument );
+}
+
+TEST(Serialization, BinaryScan)
+{
+    //
+    // Number of records is not multiple of 64,
+    // so the last word of bitmap is partial
+    //
+    std::vector<TenFields> original;
+    for (int i = 0; i < 1000; ++i) {
+        original.push_back( TenFields{ static_cast<char>( 'a' + i % 3 ), i, -i, i * 0.5, static_cast<short>( i % 16 ), 'b', 0, 0, 0, 0 } );
+    }
+
+    BinaryBatchBuffer<TenFields> batch;
+    batch.SaveRange( original.begin(), original.end() );
+
+    auto equal = Scan( batch, FieldEqual<1>( 998 ) );
+    EXPECT_EQ( equal.Size(), 1000 );
+    EXPECT_EQ( equal.Count(), 1 );
+    EXPECT_TRUE( equal.IsSelected( 998 ) );
+    EXPECT_FALSE( equal.IsSelected( 999 ) );
+    EXPECT_THROW( equal.IsSelected( 1000 ), std::out_of_range );
+
+    auto less = Scan( batch, FieldLess<3>( 10.0 ) );
+    EXPECT_EQ( less.Indices().size(), 20 );
+    EXPECT_EQ( less.Indices().back(), 19 );
+
+    //
+    // Conjunction of predicates
+    //
+    auto selection = Scan( batch, FieldInRange<2>( -500, -100 ), FieldHasBits<4>( 5 ), FieldEqual<0>( 'a' ) );
+
+    std::vector<size_t> expected;
+    for (size_t i = 100; i <= 500; ++i)
+    {
+        if (( i % 16 & 5 ) == 5 && i % 3 == 0) {
+            expected.push_back( i );
+        }
+    }
+
+    EXPECT_EQ( selection.Indices(), expected );
+
+    std::vector<TenFields> loaded;
+    LoadSelected( batch, selection, loaded );
+
+    ASSERT_EQ( loaded.size(), expected.size() );
+
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        EXPECT_EQ( loaded[i].field2, original[expected[i]].field2 );
+        EXPECT_EQ( loaded[i].field4, original[expected[i]].field4 );
+        EXPECT_EQ( loaded[i].field5, original[expected[i]].field5 );
+    }
+
+    EXPECT_THROW( LoadSelected( batch, Selection( 10 ), loaded ), std::invalid_argument );
+}
+
+TEST(Serialization, BinaryScanOperandTypes)
+{
+    std::vector<TwoFields> original{ { 'a', 1 }, { 'b', 2 }, { 'c', 3 } };
+
+    BinaryBatchBuffer<TwoFields> batch;
+    batch.SaveRange( original.begin(), original.end() );
+
+    //
+    // Operands are not truncated to type of field
+    //
+    EXPECT_EQ( Scan( batch, FieldLess<1>( 2.5 ) ).Count(), 2 );
+    EXPECT_EQ( Scan( batch, FieldEqual<1>( 2.7 ) ).Count(), 0 );
+    EXPECT_EQ( Scan( batch, FieldEqual<1>( 2.0 ) ).Indices(), std::vector<size_t>{ 1 } );
+    EXPECT_EQ( Scan( batch, FieldInRange<1>( 1.5, 3.5 ) ).Count(), 2 );
+    EXPECT_EQ( Scan( batch, FieldLess<1>( 3ull ) ).Count(), 2 );
+    EXPECT_EQ( Scan( batch, FieldLess<1>( 0x100000001ll ) ).Count(), 3 );
+
+    //
+    // Negative operand of unsigned field and vice versa
+    //
+    std::vector<ThreeFieldsWithEnum> with_enum{ { 'a', first1, first2 }, { 'b', second1, second2 } };
+
+    BinaryBatchBuffer<ThreeFieldsWithEnum> enum_batch;
+    enum_batch.SaveRange( with_enum.begin(), with_enum.end() );
+
+    EXPECT_EQ( Scan( enum_batch, FieldLess<1>( -1 ) ).Count(), 0 );
+    EXPECT_EQ( Scan( enum_batch, FieldEqual<1>( -1 ) ).Count(), 0 );
+    EXPECT_EQ( Scan( enum_batch, FieldInRange<1>( -5, 0 ) ).Indices(), std::vector<size_t>{ 0 } );
+    EXPECT_EQ( Scan( enum_batch, FieldEqual<1>( second1 ) ).Indices(), std::vector<size_t>{ 1 } );
+    EXPECT_EQ( Scan( enum_batch, FieldLess<1>( second1 ) ).Indices(), std::vector<size_t>{ 0 } );
+
+    std::vector<TwoFields> negative{ { 'a', -1 }, { 'b', 1 } };
+
+    BinaryBatchBuffer<TwoFields> negative_batch;
+    negative_batch.SaveRange( negative.begin(), negative.end() );
+
+    EXPECT_EQ( Scan( negative_batch, FieldLess<1>( 1u ) ).Indices(), std::vector<size_t>{ 0 } );
+    EXPECT_EQ( Scan( negative_batch, FieldEqual<1>( 0xffffffffu ) ).Count(), 0 );
+}
+
+TEST(Serialization, BinaryScanNestedStruct)
+{
+    std::vector<ThreeFieldsWithNestedStruct> original{
+        { 3.14, { 42, 'a' }, 'b' }, { 2.71, { -1, 'c' }, 'd' }, { 0.5, { 42, 'e' }, 'f' }
+    };
+
+    BinaryBatchBuffer<ThreeFieldsWithNestedStruct> batch;
+    batch.SaveRange( original.begin(), original.end() );
+
+    std::vector<unsigned char> bytes( batch.Data(), batch.Data() + batch.Size() );
+    BinaryBufferView<ThreeFieldsWithNestedStruct> view( bytes.data(), bytes.size() );
+
+    //
+    // Fields of nested structure are indexed as in Layout
+    //
+    auto selection = Scan( view, FieldEqual<1>( 42 ), FieldLess<3>( 'e' ) );
+
+    EXPECT_EQ( selection.Indices(), std::vector<size_t>{ 0 } );
+    EXPECT_EQ( Scan( view, FieldEqual<2>( 'x' ) ).Count(), 0 );
+    EXPECT_EQ( Scan( BinaryBufferView<ThreeFieldsWithNestedStruct>(), FieldEqual<1>( 42 ) ).Size(), 0 );
+}
+
+TEST(Serialization, ScatterGather)
+{
+    BinarySerializer<TwoFields> headerSerializer;
+    BinarySerializer<TenFields> payloadSerializer;
+
+    BinaryBuffer<TwoFields> header;
+    BinaryBuffer<TenFields> payload;
+    BinaryBuffer<TwoFields> trailer;
+
+    headerSerializer.Serialize( TwoFields{ 'h', 1 }, header );
+    payloadSerializer.Serialize( TenFields{ 'a', 2, 3, 4.5, 6, 'b', 7, 8, 9.5, 10 }, payload );
+    headerSerializer.Serialize( TwoFields{ 't', 2 }, trailer );
+
+    ScatterGatherSink sink;
+    sink.Add( header );
+    sink.Add( payload );
+    sink.Add( trailer );
+
+    //
+    // Segments refer to buffers, nothing is copied
+    //
+    ASSERT_EQ( sink.SegmentsCount(), 3 );
+    EXPECT_EQ( sink.Size(), header.Size() + payload.Size() + trailer.Size() );
+    EXPECT_EQ( SegmentData( sink.Segments()[1] ), payload.Data() );
+
+    //
+    // Saved objects go into one segment
+    //
+    sink.Save( TwoFields{ 'x', 3 } );
+    sink.Save( TwoFields{ 'y', 4 } );
+
+    EXPECT_EQ( sink.SegmentsCount(), 4 );
+    EXPECT_EQ( SegmentSize( sink.Segments()[3] ), 2 * BinaryBuffer<TwoFields>().Size() );
+
+    std::vector<unsigned char> expected;
+    expected.insert( expected.end(), header.Data(), header.Data() + header.Size() );
+    expected.insert( expected.end(), payload.Data(), payload.Data() + payload.Size() );
+    expected.insert( expected.end(), trailer.Data(), trailer.Data() + trailer.Size() );
+
+    //
+    // Partial write: the rest starts in the middle of payload
+    //
+    sink.Consume( header.Size() + 3 );
+
+    EXPECT_EQ( sink.SegmentsCount(), 3 );
+    EXPECT_EQ( SegmentData( sink.Segments()[0] ), payload.Data() + 3 );
+
+    std::vector<unsigned char> gathered;
+    for (size_t i = 0; i < sink.SegmentsCount(); ++i)
+    {
+        auto data = SegmentData( sink.Segments()[i] );
+        gathered.insert( gathered.end(), data, data + SegmentSize( sink.Segments()[i] ) );
+    }
+
+    ASSERT_EQ( gathered.size(), expected.size() - header.Size() - 3 + 2 * BinaryBuffer<TwoFields>().Size() );
+    EXPECT_TRUE( std::equal( expected.begin() + header.Size() + 3, expected.end(), gathered.begin() ) );
+
+    EXPECT_THROW( sink.Consume( sink.Size() + 1 ), std::out_of_range );
+
+    sink.Consume( sink.Size() );
+    EXPECT_TRUE( sink.IsEmpty() );
+    EXPECT_EQ( sink.SegmentsCount(), 0 );
+}
+
+#if !defined(_WIN32)
+
+TEST(Serialization, ScatterGatherWrite)
+{
+    int fds[2];
+    ASSERT_EQ( pipe( fds ), 0 );
+
+    BinaryBatchBuffer<TenFields> batch;
+    for (int i = 0; i < 100; ++i) {
+        batch.Save( TenFields{ 'a', i, i, 0.5, 1, 'b', 2, 3, 4.5, 5 } );
+    }
+
+    ScatterGatherSink sink;
+    sink.Save( TwoFields{ 'h', static_cast<int>( batch.Count() ) } );
+    sink.Add( batch );
+
+    const size_t size = sink.Size();
+    EXPECT_EQ( WriteSegments( fds[1], sink ), size );
+    EXPECT_TRUE( sink.IsEmpty() );
+
+    std::vector<unsigned char> received( size );
+    EXPECT_EQ( read( fds[0], received.data(), size ), static_cast<ssize_t>( size ) );
+
+    close( fds[0] );
+    close( fds[1] );
+
+    TwoFields header;
+    BinaryBufferView<TwoFields>( received.data(), BinaryBuffer<TwoFields>().Size() ).Load( header );
+
+    EXPECT_EQ( header.field2, 100 );
+    EXPECT_TRUE( std::equal( batch.Data(), batch.Data() + batch.Size(), received.begin() + BinaryBuffer<TwoFields>().Size() ) );
+}
+
+#endif // !defined(_WIN32)
+
+TEST(Serialization, FrameStream)
+{
+    static_assert( TypeFingerprint<TwoFields>() != TypeFingerprint<TenFields>(), "Fingerprints must differ" );
+    static_assert( TypeFingerprint<TwoFields>() != TypeFingerprint<ThreeFieldsWithNestedStruct>(), "Fingerprints must differ" );
+
+    FrameWriter<MemorySink> writer;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        writer.Write( TwoFields{ 'a', i } );
+        writer.Write( TenFields{ 'a', i, i, 0.5, 1, 'b', 2, 3, 4.5, 5 } );
+        writer.Write( ThreeFieldsWithNestedStruct{ i * 0.5, { i, 'a' }, 'b' } );
+    }
+
+    //
+    // 1-byte size and 4-byte fingerprint per frame
+    //
+    const size_t recordsSize = BinaryBuffer<TwoFields>().Size() + BinaryBuffer<TenFields>().Size() +
+                               BinaryBuffer<ThreeFieldsWithNestedStruct>().Size();
+
+    EXPECT_EQ( writer.Sink().Size(), 10 * ( recordsSize + 3 * 5 ) );
+
+    FrameReader<MemorySource> reader( MemorySource( writer.Sink().Data(), writer.Sink().Size() ) );
+
+    int twoFieldsCount = 0;
+    int nestedCount = 0;
+
+    while (reader.Next())
+    {
+        if (reader.Is<TwoFields>())
+        {
+            TwoFields obj;
+            reader.Read( obj );
+
+            EXPECT_EQ( obj.field2, twoFieldsCount++ );
+        }
+        else if (reader.Is<ThreeFieldsWithNestedStruct>())
+        {
+            ThreeFieldsWithNestedStruct obj;
+            reader.Read( obj );
+
+            EXPECT_EQ( obj.field2.field1, nestedCount++ );
+        }
+        else
+        {
+            //
+            // TenFields are skipped (explicitly or by Next)
+            //
+            EXPECT_EQ( reader.Fingerprint(), TypeFingerprint<TenFields>() );
+
+            if (twoFieldsCount % 2) {
+                reader.Skip();
+            }
+        }
+    }
+
+    EXPECT_EQ( twoFieldsCount, 10 );
+    EXPECT_EQ( nestedCount, 10 );
+}
+
+TEST(Serialization, FrameStreamInvalid)
+{
+    FrameWriter<MemorySink> writer;
+    writer.Write( TwoFields{ 'a', 42 } );
+
+    {
+        FrameReader<MemorySource> reader( MemorySource( writer.Sink().Data(), writer.Sink().Size() ) );
+
+        TenFields obj;
+        EXPECT_THROW( reader.Read( obj ), std::logic_error );
+
+        ASSERT_TRUE( reader.Next() );
+        EXPECT_THROW( reader.Read( obj ), std::logic_error );
+    }
+
+    //
+    // The last byte of record is lost
+    //
+    FrameReader<MemorySource> reader( MemorySource( writer.Sink().Data(), writer.Sink().Size() - 1 ) );
+
+    TwoFields obj;
+
+    ASSERT_TRUE( reader.Next() );
+    EXPECT_THROW( reader.Read( obj ), std::runtime_error );
+}
+
+#if !defined(_WIN32)
+
+TEST(Serialization, FrameStreamDescriptor)
+{
+    int fds[2];
+    ASSERT_EQ( pipe( fds ), 0 );
+
+    {
+        FrameWriter<DescriptorSink> writer( DescriptorSink( fds[1], 16 ) );
+
+        for (int i = 0; i < 100; ++i)
+        {
+            writer.Write( TenFields{ 'a', i, i, 0.5, 1, 'b', 2, 3, 4.5, 5 } );
+            writer.Write( TwoFields{ 'a', i } );
+        }
+    }
+
+    close( fds[1] );
+
+    //
+    // Block is smaller than frame, so it grows
+    //
+    FrameReader<DescriptorSource> reader( DescriptorSource( fds[0], 8 ) );
+
+    int count = 0;
+    while (reader.Next())
+    {
+        if (reader.Is<TwoFields>())
+        {
+            TwoFields obj;
+            reader.Read( obj );
+
+            EXPECT_EQ( obj.field2, count++ );
+        }
+    }
+
+    close( fds[0] );
+
+    EXPECT_EQ( count, 100 );
+}
+
+#endif // !defined(_WIN32)
+
+using TestMessageTypes = TypeList<TwoFields, TenFields, ThreeFieldsWithNestedStruct>;
+
+struct TestMessageHandler
+{
+    void operator()( const TwoFields& obj ) { twoFields += obj.field2; }
+    void operator()( const TenFields& obj ) { tenFields += obj.field3; }
+    void operator()( const ThreeFieldsWithNestedStruct& obj ) { nested += obj.field2.field1; }
+
+    int twoFields = 0;
+    int tenFields = 0;
+    int nested = 0;
+};
+
+TEST(Serialization, MessageDispatch)
+{
+    using codec_t = MessageCodec<TestMessageTypes>;
+
+    static_assert( Message<TestMessageTypes>::IndexOf<TenFields>() == 1, "Tag is index of type" );
+    static_assert( codec_t::EncodedSize<TwoFields>() == 1 + sizeof( char ) + sizeof( int ), "Tag takes 1 byte" );
+
+    std::vector<unsigned char> buffer;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        codec_t::Encode( TwoFields{ 'a', i }, buffer );
+        codec_t::Encode( TenFields{ 'a', i, 2 * i, 0.5, 1, 'b', 2, 3, 4.5, 5 }, buffer );
+        codec_t::Encode( Message<TestMessageTypes>( ThreeFieldsWithNestedStruct{ 0.5, { 3 * i, 'a' }, 'b' } ), buffer );
+    }
+
+    TestMessageHandler handler;
+
+    EXPECT_EQ( codec_t::DispatchAll( buffer.data(), buffer.size(), handler ), 30 );
+    EXPECT_EQ( handler.twoFields, 45 );
+    EXPECT_EQ( handler.tenFields, 90 );
+    EXPECT_EQ( handler.nested, 135 );
+
+    //
+    // Decoding into message
+    //
+    Message<TestMessageTypes> message;
+    EXPECT_TRUE( message.Is<TwoFields>() );
+
+    size_t offset = codec_t::Decode( buffer.data(), buffer.size(), message );
+    offset += codec_t::Decode( buffer.data() + offset, buffer.size() - offset, message );
+
+    ASSERT_TRUE( message.Is<TenFields>() );
+    EXPECT_EQ( message.Index(), 1 );
+    EXPECT_EQ( message.Get<TenFields>().field9, 4.5 );
+    EXPECT_THROW( message.Get<TwoFields>(), std::logic_error );
+
+    TestMessageHandler visitor;
+    message.Visit( visitor );
+
+    EXPECT_EQ( visitor.tenFields, 0 );
+    EXPECT_EQ( visitor.twoFields, 0 );
+
+    message.Set( TwoFields{ 'a', 7 } );
+    message.Visit( visitor );
+
+    EXPECT_EQ( visitor.twoFields, 7 );
+}
+
+TEST(Serialization, MessageDispatchInvalid)
+{
+    using codec_t = MessageCodec<TestMessageTypes>;
+
+    std::vector<unsigned char> buffer;
+    codec_t::Encode( TwoFields{ 'a', 42 }, buffer );
+
+    TestMessageHandler handler;
+
+    //
+    // Record is truncated
+    //
+    EXPECT_THROW( codec_t::Dispatch( buffer.data(), buffer.size() - 1, handler ), std::runtime_error );
+    EXPECT_THROW( codec_t::Dispatch( buffer.data(), 0, handler ), std::runtime_error );
+
+    //
+    // Unknown tag
+    //
+    buffer[0] = 3;
+    EXPECT_THROW( codec_t::Dispatch( buffer.data(), buffer.size(), handler ), std::runtime_error );
+
+    EXPECT_EQ( handler.twoFields, 0 );
+}
+
+TEST(Serialization, BinaryInlineStorage)
+{
+    NestedBetweenChars original{ 'a', { 42, 'b' }, 'c' };
+
+    InlineBinarySerializer<NestedBetweenChars> serializer;
+    InlineBinaryBuffer<NestedBetweenChars> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    //
+    // Bytes are stored inside of buffer object itself
+    // 
+    auto pBuffer = reinterpret_cast<const unsigned char*>( &buffer );
+    EXPECT_GE( buffer.Data(), pBuffer );
+    EXPECT_LE( buffer.Data() + buffer.Size(), pBuffer + sizeof( buffer ) );
+
+    NestedBetweenChars loaded{};
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, BinaryExternalStorage)
+{
+    TwoFields original{ 'a', 42 };
+
+    unsigned char frame[64] = { 0 };
+
+    ExternalBinarySerializer<TwoFields> serializer;
+    ExternalBinaryBuffer<TwoFields> buffer( ExternalStorage( frame, sizeof( frame ) ) );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_EQ( buffer.Data(), frame );
+    EXPECT_EQ( frame[0], 'a' );
+
+    TwoFields loaded{ 0, 0 };
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+
+    unsigned char small[2];
+    EXPECT_THROW( ExternalBinaryBuffer<TwoFields>( ExternalStorage( small, sizeof( small ) ) ), std::length_error );
+}
+
+TEST(Serialization, BinaryArenaStorage)
+{
+    TwoFields original{ 'a', 42 };
+
+    alignas( 16 ) unsigned char memory[256];
+    Arena arena( memory, sizeof( memory ) );
+
+    ArenaBinarySerializer<TwoFields> serializer;
+    ArenaBinaryBuffer<TwoFields> buffer{ ArenaStorage{ ArenaAllocator<unsigned char>{ arena } } };
+
+    EXPECT_EQ( arena.Used(), GetPackedSize<TwoFields>() );
+
+    serializer.Serialize( original, buffer );
+
+    TwoFields loaded{ 0, 0 };
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+
+    arena.Reset();
+
+    EXPECT_EQ( arena.Used(), 0 );
+}
+
+TEST(Serialization, StringStream)
+{
+    TwoFields original{ 2, 4 };
+
+    StringStreamSerializer<TwoFields> serializer;
+    StringStreamBuffer<TwoFields> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    TwoFields loaded{ 0, 0 };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+}
+
+TEST(Serialization, NestedStruct)
+{
+    ThreeFieldsWithNestedStruct original{ 3.14, { 42, 'a' }, 'b' };
+    
+    StringStreamSerializer<ThreeFieldsWithNestedStruct> serializer;
+    StringStreamBuffer<ThreeFieldsWithNestedStruct> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    ThreeFieldsWithNestedStruct loaded{ 2.71, { -5, 'c' }, 'd' };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+}
+
+TEST(Serialization, StringStreamContainsEnum)
+{
+    ThreeFieldsWithEnum original{ 'a', first1, second2 };
+
+    StringStreamSerializer<ThreeFieldsWithEnum> serializer;
+    StringStreamBuffer<ThreeFieldsWithEnum> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    ThreeFieldsWithEnum loaded{ 'b', second1, first2 };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+    EXPECT_NE( loaded.field3, original.field3 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, StringStreamNotPod)
+{
+    NotPod original{ 'a', "Serialized\n string", 3.14 };
+
+    StringStreamSerializer<NotPod> serializer;
+    StringStreamBuffer<NotPod> buffer;
+
+    EXPECT_TRUE( buffer.IsEmpty() );
+
+    serializer.Serialize( original, buffer );
+
+    EXPECT_FALSE( buffer.IsEmpty() );
+
+    NotPod loaded{ 'b', "Another string", 2.71 };
+
+    EXPECT_NE( loaded.field1, original.field1 );
+    EXPECT_NE( loaded.field2, original.field2 );
+    EXPECT_NE( loaded.field3, original.field3 );
+
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, StringStreamSaveTwice)
+{
+    TwoFields first{ 'a', 4 };
+    TwoFields second{ 'b', 8 };
+
+    StringStreamSerializer<TwoFields> serializer;
+    StringStreamBuffer<TwoFields> buffer;
+
+    serializer.Serialize( first, buffer );
+    serializer.Serialize( second, buffer );
+
+    EXPECT_EQ( std::string( buffer.Data(), buffer.Size() ), std::string( "b\0" "8", 3 ) );
+
+    TwoFields loaded{ 0, 0 };
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, second.field1 );
+    EXPECT_EQ( loaded.field2, second.field2 );
+}
+
+TEST(Serialization, StringStreamPrecision)
+{
+    ThreeFieldsWithNestedStruct original{ 0.1 + 0.2, { -42, 'a' }, 'b' };
+
+    StringStreamSerializer<ThreeFieldsWithNestedStruct> serializer;
+    StringStreamBuffer<ThreeFieldsWithNestedStruct> buffer;
+
+    serializer.Serialize( original, buffer );
+
+    ThreeFieldsWithNestedStruct loaded{ 0, { 0, 0 }, 0 };
+    serializer.Deserialize( loaded, buffer );
+
+    EXPECT_EQ( loaded.field1, original.field1 );
+    EXPECT_EQ( loaded.field2, original.field2 );
+    EXPECT_EQ( loaded.field3, original.field3 );
+}
+
+TEST(Serialization, DeserializeByValue)
+{
+    NestedBetweenChars binary_original{ 'a', { 42, 'b' }, 'c' };
+
+    BinarySerializer<NestedBetweenChars> binary_serializer;
+    BinaryBuffer<NestedBetweenChars> binary_buffer;
+
+    binary_serializer.Serialize( binary_original, binary_buffer );
+
+    auto binary_loaded = binary_serializer.Deserialize( binary_buffer );
+
+    EXPECT_EQ( binary_loaded.field1, binary_original.field1 );
+    EXPECT_EQ( binary_loaded.field2, binary_original.field2 );
+    EXPECT_EQ( binary_loaded.field3, binary_original.field3 );
+
+    NotPod stream_original{ 'a', "Serialized string", 3.14 };
+
+    StringStreamSerializer<NotPod> stream_serializer;
+    StringStreamBuffer<NotPod> stream_buffer;
+
+    stream_serializer.Serialize( stream_original, stream_buffer );
+
+    auto stream_loaded = stream_serializer.Deserialize( stream_buffer );
+
+    EXPECT_EQ( stream_loaded.field1, stream_original.field1 );
+    EXPECT_EQ( stream_loaded.field2, stream_original.field2 );
+    EXPECT_EQ( stream_loaded.field3, stream_original.field3 );
+}
+
+
+/************************************************************************************
+ * Typelist tests
+ */
+
+TEST(TypeList, Size)
+{
+    TypeList<double, int, std::string, short> tl;
 
     EXPECT_EQ( Size( tl ), 4 );
 
@@ -771,3 +2409,488 @@ TEST(GetTypeList, NotPod)
     EXPECT_EQ( type_list::get<1>( tl ), Identity<std::string>{} );
     EXPECT_EQ( type_list::get<2>( tl ), Identity<double>{} );
 }
+
+
+
+/************************************************************************************
+ * SoaVector tests
+ */
+
+TEST(SoaVector, PushBackAndGet)
+{
+    SoaVector<ThreeFieldsWithNestedStruct> soa;
+
+    EXPECT_TRUE( soa.IsEmpty() );
+
+    for (int i = 0; i < 100; ++i) {
+        soa.PushBack( ThreeFieldsWithNestedStruct{ i * 0.5, { i, 'a' }, static_cast<char>( 'a' + i % 26 ) } );
+    }
+
+    EXPECT_EQ( soa.Size(), 100 );
+
+    auto loaded = soa.Get( 42 );
+
+    EXPECT_EQ( loaded.field1, 21.0 );
+    EXPECT_EQ( loaded.field2, ( Nested{ 42, 'a' } ) );
+    EXPECT_EQ( loaded.field3, static_cast<char>( 'a' + 42 % 26 ) );
+
+    EXPECT_THROW( soa.Get( 100 ), std::out_of_range );
+}
+
+TEST(SoaVector, Row)
+{
+    SoaVector<NotPod> soa;
+
+    NotPod original{ 'a', "Long string, that doesn't fit into small buffer", 3.14 };
+    soa.PushBack( original );
+    soa.PushBack( std::move( original ) );
+
+    auto row = soa[1];
+
+    EXPECT_EQ( types::get<0>( row ), 'a' );
+    EXPECT_EQ( types::get<1>( row ), "Long string, that doesn't fit into small buffer" );
+    EXPECT_EQ( types::get<2>( row ), 3.14 );
+
+    //
+    // Row refers to values in container
+    //
+    types::get<1>( row ) = "Other string";
+
+    EXPECT_EQ( soa.Get( 1 ).field2, "Other string" );
+    EXPECT_EQ( soa.Get( 0 ).field2, "Long string, that doesn't fit into small buffer" );
+}
+
+TEST(SoaVector, Columns)
+{
+    SoaVector<TenFields> soa;
+
+    for (int i = 0; i < 1000; ++i) {
+        soa.PushBack( TenFields{ 'a', i, -i, i * 0.5, 0, 'b', 0, 0, 0, 0 } );
+    }
+
+    auto column2 = soa.Column<1>();
+    auto column4 = soa.Column<3>();
+
+    EXPECT_EQ( column2.Size(), 1000 );
+    EXPECT_EQ( reinterpret_cast<uintptr_t>( column2.Data() ) % CacheLineSize, 0 );
+    EXPECT_EQ( reinterpret_cast<uintptr_t>( column4.Data() ) % CacheLineSize, 0 );
+
+    int sum = 0;
+    for (int value : column2) {
+        sum += value;
+    }
+
+    EXPECT_EQ( sum, 999 * 1000 / 2 );
+    EXPECT_EQ( column4[10], 5.0 );
+
+    static_assert( std::is_same<decltype( soa.Column<3>() ), ColumnSpan<double>>::value, "Wrong type of column" );
+}
+
+TEST(SoaVector, Transpose)
+{
+    //
+    // Number of objects is not multiple of number of
+    // lanes, so tails are transposed by scalar kernels
+    //
+    std::vector<TenFields> original;
+    for (int i = 0; i < 1001; ++i) {
+        original.push_back( TenFields{ 'a', i, -i, i * 0.5, static_cast<short>( i ), 'b', i * 2, i * 3, -i * 0.25, 7 } );
+    }
+
+    SoaVector<TenFields> soa;
+    soa.PushBack( original.back() );
+    soa.AppendRange( original.data(), original.size() );
+
+    EXPECT_EQ( soa.Size(), 1002 );
+
+    std::vector<TenFields> loaded( original.size() );
+    soa.LoadRange( loaded.data(), 1, loaded.size() );
+
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+        EXPECT_EQ( loaded[i].field1, original[i].field1 );
+        EXPECT_EQ( loaded[i].field2, original[i].field2 );
+        EXPECT_EQ( loaded[i].field3, original[i].field3 );
+        EXPECT_EQ( loaded[i].field4, original[i].field4 );
+        EXPECT_EQ( loaded[i].field5, original[i].field5 );
+        EXPECT_EQ( loaded[i].field6, original[i].field6 );
+        EXPECT_EQ( loaded[i].field7, original[i].field7 );
+        EXPECT_EQ( loaded[i].field8, original[i].field8 );
+        EXPECT_EQ( loaded[i].field9, original[i].field9 );
+        EXPECT_EQ( loaded[i].field10, original[i].field10 );
+    }
+
+    EXPECT_EQ( soa.Column<3>()[11], 5.0 );
+    EXPECT_THROW( soa.LoadRange( loaded.data(), 2, loaded.size() ), std::out_of_range );
+}
+
+TEST(SoaVector, TransposeNested)
+{
+    ThreeFieldsWithNestedStruct original[] = {
+        { 3.14, { 42, 'a' }, 'b' }, { 2.71, { -1, 'c' }, 'd' }, { 0.5, { 7, 'e' }, 'f' },
+        { 1.5, { 8, 'g' }, 'h' }, { -2.5, { 9, 'i' }, 'j' }
+    };
+
+    SoaVector<ThreeFieldsWithNestedStruct> soa;
+    soa.AppendRange( original, 5 );
+
+    ThreeFieldsWithNestedStruct loaded[5];
+    soa.LoadRange( loaded, 0, 5 );
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ( soa.Column<1>()[i], original[i].field2 );
+
+        EXPECT_EQ( loaded[i].field1, original[i].field1 );
+        EXPECT_EQ( loaded[i].field2, original[i].field2 );
+        EXPECT_EQ( loaded[i].field3, original[i].field3 );
+    }
+
+    NotPod not_pod[] = { { 'a', "First string", 1.0 }, { 'b', "Second string", 2.0 } };
+
+    SoaVector<NotPod> not_pod_soa;
+    not_pod_soa.AppendRange( not_pod, 2 );
+
+    NotPod not_pod_loaded[2];
+    not_pod_soa.LoadRange( not_pod_loaded, 0, 2 );
+
+    EXPECT_EQ( not_pod_loaded[1].field2, "Second string" );
+}
+
+TEST(SoaVector, TransposeSmall)
+{
+    //
+    // Several small structures are transposed by one
+    // vector, the rest of them are transposed by scalar
+    // kernels
+    //
+    std::vector<TwoFields> pairs;
+    std::vector<SixBytes> sixes;
+
+    for (int i = 0; i < 103; ++i)
+    {
+        pairs.push_back( TwoFields{ static_cast<char>( 'a' + i % 26 ), i * 1000 - 7 } );
+        sixes.push_back( SixBytes{ static_cast<short>( -i ), static_cast<char>( i ), i % 2 == 0, static_cast<short>( i * 300 ) } );
+    }
+
+    SoaVector<TwoFields> pairsSoa;
+    SoaVector<SixBytes> sixesSoa;
+
+    pairsSoa.AppendRange( pairs.data(), pairs.size() );
+    sixesSoa.AppendRange( sixes.data(), sixes.size() );
+
+    std::vector<TwoFields> loadedPairs( pairs.size() );
+    std::vector<SixBytes> loadedSixes( sixes.size() );
+
+    pairsSoa.LoadRange( loadedPairs.data(), 0, loadedPairs.size() );
+    sixesSoa.LoadRange( loadedSixes.data(), 0, loadedSixes.size() );
+
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        EXPECT_EQ( pairsSoa.Column<0>()[i], pairs[i].field1 );
+        EXPECT_EQ( pairsSoa.Column<1>()[i], pairs[i].field2 );
+        EXPECT_EQ( sixesSoa.Column<1>()[i], sixes[i].field2 );
+        EXPECT_EQ( sixesSoa.Column<3>()[i], sixes[i].field4 );
+
+        EXPECT_EQ( loadedPairs[i].field1, pairs[i].field1 );
+        EXPECT_EQ( loadedPairs[i].field2, pairs[i].field2 );
+
+        EXPECT_EQ( loadedSixes[i].field1, sixes[i].field1 );
+        EXPECT_EQ( loadedSixes[i].field2, sixes[i].field2 );
+        EXPECT_EQ( loadedSixes[i].field3, sixes[i].field3 );
+        EXPECT_EQ( loadedSixes[i].field4, sixes[i].field4 );
+    }
+}
+
+TEST(SoaVector, BoolFields)
+{
+    std::vector<WithBool> original;
+    for (int i = 0; i < 101; ++i) {
+        original.push_back( WithBool{ i, i % 3 == 0, i * 0.5, i % 2 == 0 } );
+    }
+
+    SoaVector<WithBool> soa;
+    soa.PushBack( WithBool{ -1, true, 0.0, false } );
+    soa.AppendRange( original.data(), original.size() );
+
+    EXPECT_EQ( soa.Size(), 102 );
+
+    std::vector<WithBool> loaded( original.size() );
+    soa.LoadRange( loaded.data(), 1, loaded.size() );
+
+    for (size_t i = 0; i < original.size(); ++i)
+    {
+        EXPECT_EQ( loaded[i].field1, original[i].field1 );
+        EXPECT_EQ( loaded[i].field2, original[i].field2 );
+        EXPECT_EQ( loaded[i].field4, original[i].field4 );
+    }
+
+    EXPECT_TRUE( soa.Get( 0 ).field2 );
+    EXPECT_FALSE( soa.Get( 0 ).field4 );
+
+    //
+    // Columns and rows of bool fields are viewed as bool
+    //
+    static_assert( std::is_same<decltype( soa.Column<1>() ), ColumnSpan<bool>>::value, "Wrong type of column" );
+
+    auto row = soa[2];
+    types::get<3>( row ) = true;
+
+    EXPECT_TRUE( soa.Get( 2 ).field4 );
+    EXPECT_EQ( soa.Column<3>()[2], true );
+    EXPECT_EQ( reinterpret_cast<std::uintptr_t>( soa.Column<1>().Data() ) % CacheLineSize, 0 );
+
+    EXPECT_EQ( Count<1>( soa, true ), 35 );
+    EXPECT_EQ( Count<3>( soa, true ), 52 );
+}
+
+/************************************************************************************
+ * Aggregate tests
+ */
+
+TEST(Aggregate, Fields)
+{
+    //
+    // Number of objects is not multiple of number of
+    // lanes, so tails are aggregated as well
+    //
+    std::vector<TenFields> objects;
+    for (int i = 0; i < 1003; ++i) {
+        objects.push_back( TenFields{ static_cast<char>( 'a' + i % 3 ), i, -i, i * 0.5, static_cast<short>( i % 100 ), 'b', i % 7, 0, 0.0, 0 } );
+    }
+
+    SoaVector<TenFields> soa;
+    soa.AppendRange( objects.data(), objects.size() );
+
+    EXPECT_EQ( Sum<1>( soa ), 1002 * 1003 / 2 );
+    EXPECT_EQ( Sum<1>( objects.data(), objects.size() ), 1002 * 1003 / 2 );
+    EXPECT_EQ( Sum<2>( soa ), -1002 * 1003 / 2 );
+    EXPECT_EQ( Sum<3>( objects.data(), objects.size() ), 1002 * 1003 / 4.0 );
+
+    static_assert( std::is_same<decltype( Sum<1>( soa ) ), int64_t>::value, "Wrong type of sum" );
+    static_assert( std::is_same<decltype( Sum<3>( soa ) ), double>::value, "Wrong type of sum" );
+
+    EXPECT_EQ( Min<2>( soa ), -1002 );
+    EXPECT_EQ( Min<2>( objects.data(), objects.size() ), -1002 );
+    EXPECT_EQ( Max<4>( soa ), 99 );
+    EXPECT_EQ( Max<4>( objects.data(), objects.size() ), 99 );
+    EXPECT_EQ( Max<0>( soa ), 'c' );
+
+    EXPECT_EQ( Mean<1>( soa ), 501.0 );
+    EXPECT_EQ( Mean<3>( objects.data(), objects.size() ), 250.5 );
+
+    EXPECT_EQ( Count<6>( soa, 0 ), 144 );
+    EXPECT_EQ( Count<6>( objects.data(), objects.size(), 0 ), 144 );
+    EXPECT_EQ( Count<0>( soa, 'a' ), 335 );
+
+    EXPECT_EQ( Sum<1>( objects.data(), 0 ), 0 );
+    EXPECT_THROW( Min<1>( objects.data(), 0 ), std::invalid_argument );
+    EXPECT_THROW( Mean<1>( SoaVector<TenFields>{} ), std::invalid_argument );
+}
+
+TEST(Aggregate, EnumAndNotPod)
+{
+    ThreeFieldsWithEnum with_enum[] = {
+        { 'a', second1, first2 }, { 'b', first1, second2 }, { 'c', second1, second2 }
+    };
+
+    EXPECT_EQ( Sum<1>( with_enum, 3 ), 2 );
+    EXPECT_EQ( Max<1>( with_enum, 3 ), second1 );
+    EXPECT_EQ( Count<2>( with_enum, 3, second2 ), 2 );
+
+    static_assert( std::is_same<decltype( Sum<1>( with_enum, 3 ) ), uint64_t>::value, "Wrong type of sum" );
+    static_assert( std::is_same<decltype( Max<1>( with_enum, 3 ) ), TestEnum1>::value, "Wrong type of maximum" );
+
+    NotPod not_pod[] = { { 'a', "First string", 1.0 }, { 'b', "Second string", 2.5 } };
+
+    SoaVector<NotPod> not_pod_soa;
+    not_pod_soa.AppendRange( not_pod, 2 );
+
+    EXPECT_EQ( Sum<2>( not_pod, 2 ), 3.5 );
+    EXPECT_EQ( Mean<2>( not_pod_soa ), 1.75 );
+    EXPECT_EQ( Min<0>( not_pod, 2 ), 'a' );
+}
+
+/************************************************************************************
+ * Sort tests
+ */
+
+TEST(Sort, Integers)
+{
+    //
+    // Keys are negative and positive, equal keys
+    // are kept in the original order
+    //
+    std::vector<TenFields> objects;
+    for (int i = 0; i < 1000; ++i) {
+        objects.push_back( TenFields{ 'a', ( i * 7919 ) % 201 - 100, i, 0.0, static_cast<short>( -i ), 'b', 0, 0, 0.0, 0 } );
+    }
+
+    auto expected = objects;
+    std::stable_sort( expected.begin(), expected.end(), []( const auto& left, const auto& right ) { return left.field2 < right.field2; } );
+
+    SortByField<1>( objects );
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        EXPECT_EQ( objects[i].field2, expected[i].field2 );
+        EXPECT_EQ( objects[i].field3, expected[i].field3 );
+    }
+
+    SortByField<4>( objects.data(), objects.size() );
+
+    EXPECT_EQ( objects.front().field5, -999 );
+    EXPECT_EQ( objects.back().field5, 0 );
+}
+
+TEST(Sort, FloatingPoint)
+{
+    const double values[] = { 3.5, -0.0, -1e300, 0.0, 1e-300, -2.25, 1e300, -1e-300, 42.0 };
+
+    std::vector<ThreeFieldsWithNestedStruct> objects;
+    for (int i = 0; i < 300; ++i) {
+        objects.push_back( ThreeFieldsWithNestedStruct{ values[i % 9] * ( i % 5 + 1 ), { i, 'a' }, 'b' } );
+    }
+
+    SortByField<0>( objects );
+
+    for (size_t i = 1; i < objects.size(); ++i) {
+        EXPECT_LE( objects[i - 1].field1, objects[i].field1 );
+    }
+
+    //
+    // -0.0 goes before +0.0
+    //
+    auto IsZero = []( const auto& obj ) { return obj.field1 == 0.0; };
+
+    auto first = std::find_if( objects.begin(), objects.end(), IsZero );
+    auto last = std::find_if( objects.rbegin(), objects.rend(), IsZero );
+
+    EXPECT_TRUE( std::signbit( first->field1 ) );
+    EXPECT_FALSE( std::signbit( last->field1 ) );
+}
+
+TEST(Sort, NotPod)
+{
+    std::vector<NotPod> objects{ { 'a', "Cherry", 2.0 }, { 'b', "Apple", -1.0 }, { 'c', "Banana", 3.0 } };
+
+    SortByField<1>( objects );
+
+    EXPECT_EQ( objects[0].field2, "Apple" );
+    EXPECT_EQ( objects[1].field2, "Banana" );
+    EXPECT_EQ( objects[2].field2, "Cherry" );
+
+    SortByField<2>( objects );
+
+    EXPECT_EQ( objects[0].field1, 'b' );
+    EXPECT_EQ( objects[2].field1, 'c' );
+}
+
+TEST(Sort, Parallel)
+{
+    std::vector<TwoFields> objects;
+    for (int i = 0; i < 100000; ++i) {
+        objects.push_back( TwoFields{ static_cast<char>( i % 100 ), static_cast<int>( ( i * 2654435761u ) % 100003 ) - 50000 } );
+    }
+
+    auto expected = objects;
+    std::stable_sort( expected.begin(), expected.end(), []( const auto& left, const auto& right ) { return left.field2 < right.field2; } );
+
+    SortByFieldParallel<1>( objects, 4 );
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        EXPECT_EQ( objects[i].field1, expected[i].field1 );
+        EXPECT_EQ( objects[i].field2, expected[i].field2 );
+    }
+}
+
+/************************************************************************************
+ * Key encoding tests
+ */
+
+template<typename _Type, typename _Less>
+void CheckKeysOrder( const std::vector<_Type>& objects, _Less less )
+{
+    for (const auto& left : objects)
+    {
+        for (const auto& right : objects)
+        {
+            auto leftKey = EncodeKey( left );
+            auto rightKey = EncodeKey( right );
+
+            int expected = less( left, right ) ? -1 : ( less( right, left ) ? 1 : 0 );
+            int actual = CompareKeys( leftKey, rightKey );
+
+            EXPECT_EQ( expected, ( actual > 0 ) - ( actual < 0 ) );
+
+            if (KeyPrefix( leftKey ) < KeyPrefix( rightKey )) {
+                EXPECT_LT( actual, 0 );
+            }
+        }
+    }
+}
+
+TEST(KeyEncoding, Numbers)
+{
+    std::vector<ThreeFieldsWithNestedStruct> objects;
+
+    const double doubles[] = { -1e300, -2.5, -0.0, 1e-300, 3.5 };
+    const int ints[] = { (std::numeric_limits<int>::min)(), -1, 0, 1, (std::numeric_limits<int>::max)() };
+
+    for (double d : doubles)
+    {
+        for (int i : ints) {
+            objects.push_back( ThreeFieldsWithNestedStruct{ d, { i, static_cast<char>( i ) }, 'a' } );
+        }
+    }
+
+    CheckKeysOrder( objects, []( const auto& left, const auto& right )
+    {
+        return std::make_tuple( left.field1, left.field2.field1, left.field2.field2, left.field3 ) <
+               std::make_tuple( right.field1, right.field2.field1, right.field2.field2, right.field3 );
+    } );
+
+    EXPECT_EQ( EncodeKey( objects[0] ).size(), sizeof( double ) + sizeof( int ) + 2 );
+
+    //
+    // Zeros of both signs are equal, so are NaNs
+    //
+    const ThreeFieldsWithNestedStruct negativeZero{ -0.0, { 1, 'b' }, 'a' };
+    const ThreeFieldsWithNestedStruct positiveZero{ 0.0, { 1, 'b' }, 'a' };
+
+    EXPECT_EQ( CompareKeys( EncodeKey( negativeZero ), EncodeKey( positiveZero ) ), 0 );
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const ThreeFieldsWithNestedStruct nan1{ nan, { 1, 'b' }, 'a' };
+    const ThreeFieldsWithNestedStruct nan2{ -nan, { 1, 'b' }, 'a' };
+    const ThreeFieldsWithNestedStruct infinity{ std::numeric_limits<double>::infinity(), { 2, 'b' }, 'a' };
+
+    EXPECT_EQ( CompareKeys( EncodeKey( nan1 ), EncodeKey( nan2 ) ), 0 );
+    EXPECT_LT( CompareKeys( EncodeKey( infinity ), EncodeKey( nan2 ) ), 0 );
+}
+
+TEST(KeyEncoding, Strings)
+{
+    std::vector<NotPod> objects{
+        { 'a', "", 1.0 }, { 'a', "abc", 1.0 }, { 'a', "ab", 2.0 }, { 'a', "abd", -1.0 },
+        { 'a', std::string( "ab\0c", 4 ), 1.0 }, { 'a', std::string( "ab\0", 3 ), 1.0 },
+        { 'a', "ab\xFF", 1.0 }, { 'b', "", 0.0 }
+    };
+
+    CheckKeysOrder( objects, []( const NotPod& left, const NotPod& right )
+    {
+        return std::tie( left.field1, left.field2, left.field3 ) < std::tie( right.field1, right.field2, right.field3 );
+    } );
+
+    //
+    // Only the first field is encoded
+    //
+    std::vector<unsigned char> left, right;
+
+    EncodeKeyPrefix<1>( objects[1], left );
+    EncodeKeyPrefix<1>( objects[3], right );
+
+    EXPECT_EQ( CompareKeys( left, right ), 0 );
+    EXPECT_EQ( left.size(), 1 );
+}
\ No newline at end of file